@@ -0,0 +1,54 @@
+/*
+** SDL++, 2020
+** ArchiveStartup.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/Archive.hpp"
+
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Compares loading loose image files through IMG_Load with fetching the same
+// entries from an archive built by `sdlpp_pack`. The archive must have been
+// packed from the same file list, in the same form it is given here.
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		std::cerr << "usage: " << argv[0] << " <archive> <files...>" << std::endl;
+		return 1;
+	}
+
+	const std::string archivePath = argv[1];
+	const std::vector<std::string> files(argv + 2, argv + argc);
+
+	// Each sample loads every surface and frees them again, so both paths pay
+	// for the same teardown; the warmup runs fill the page cache.
+	Bench::Suite suite{"archive", 10, 2};
+
+	try {
+		std::vector<SDL::Surface> surfaces;
+		surfaces.reserve(files.size());
+
+		suite.run("loose files + IMG_Load", files.size(), [&] {
+			for (const auto &f : files)
+				surfaces.emplace_back(f);
+			surfaces.clear();
+		});
+
+		suite.run("archive open + surfaces", files.size(), [&] {
+			SDL::Archive archive{archivePath};
+			for (const auto &f : files)
+				surfaces.emplace_back(archive.surface(f));
+			surfaces.clear();
+		});
+	}
+	catch (const SDL::Exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
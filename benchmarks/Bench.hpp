@@ -0,0 +1,212 @@
+/*
+** SDL++, 2020
+** Bench.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "SDL++/Timer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace Bench
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+class Stopwatch
+{
+public:
+	Stopwatch()
+	: m_start{SDL::Timer::perfCounter()}
+	{}
+
+	double elapsedMs() const
+	{
+		return double(SDL::Timer::perfCounter() - m_start) * 1000.0 / double(SDL::Timer::perfFrequency());
+	}
+
+private:
+	Uint64 m_start;
+};
+
+template<typename F>
+double measureMs(F &&fn)
+{
+	Stopwatch sw;
+	fn();
+	return sw.elapsedMs();
+}
+
+inline void report(const std::string &name, double ms, size_t items = 0)
+{
+	std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3) << std::setw(12) << ms << " ms";
+	if (items > 0)
+		std::cout << std::setw(12) << (ms * 1000.0 / double(items)) << " us/item";
+	std::cout << std::endl;
+}
+
+/// Keeps the compiler from optimizing away a result nobody reads.
+template<typename T>
+inline void keep(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static const volatile void *sink;
+	sink = &value;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Statistics over repeated timings of the same operation, in milliseconds
+/// per sample. Each sample processes items units of work.
+struct Summary
+{
+	std::string name;
+	size_t items = 1;
+	size_t samples = 0;
+	double min = 0.0;
+	double max = 0.0;
+	double mean = 0.0;
+	double median = 0.0;
+	double p95 = 0.0;
+	double stddev = 0.0;
+
+	double nsPerItem() const { return median * 1000000.0 / double(std::max<size_t>(items, 1)); }
+};
+
+inline Summary summarize(std::string name, std::vector<double> ms, size_t items)
+{
+	Summary s;
+	s.name = std::move(name);
+	s.items = items;
+	s.samples = ms.size();
+	if (ms.empty())
+		return s;
+
+	std::sort(ms.begin(), ms.end());
+	s.min = ms.front();
+	s.max = ms.back();
+	s.median = ms.size() % 2 ? ms[ms.size() / 2] : (ms[ms.size() / 2 - 1] + ms[ms.size() / 2]) / 2.0;
+	s.p95 = ms[std::min(ms.size() - 1, static_cast<size_t>(std::ceil(0.95 * double(ms.size()))) - 1)];
+
+	double sum = 0.0;
+	for (double v : ms)
+		sum += v;
+	s.mean = sum / double(ms.size());
+
+	double sq = 0.0;
+	for (double v : ms)
+		sq += (v - s.mean) * (v - s.mean);
+	s.stddev = ms.size() > 1 ? std::sqrt(sq / double(ms.size() - 1)) : 0.0;
+	return s;
+}
+
+template<typename F>
+Summary sample(std::string name, size_t items, int samples, int warmup, F &&fn)
+{
+	for (int i = 0; i < warmup; ++i)
+		fn();
+
+	std::vector<double> ms;
+	ms.reserve(static_cast<size_t>(std::max(samples, 1)));
+	for (int i = 0; i < std::max(samples, 1); ++i)
+		ms.push_back(measureMs(fn));
+	return summarize(std::move(name), std::move(ms), items);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Named set of sampled benchmarks, printed as they run and written as JSON
+/// for regression tracking. Benchmarks whose name does not contain the
+/// filter are skipped.
+class Suite
+{
+public:
+	explicit Suite(std::string name, int samples = 30, int warmup = 3)
+	: m_name{std::move(name)}
+	, m_samples{samples}
+	, m_warmup{warmup}
+	{}
+
+	void setFilter(std::string filter) { m_filter = std::move(filter); }
+	void setSamples(int samples) { m_samples = samples; }
+
+	/// Where results are printed as they run, std::cout by default; move
+	/// it away when the JSON goes to standard output.
+	void setOutput(std::ostream &out) { m_out = &out; }
+
+	template<typename F>
+	void run(const std::string &name, size_t items, F &&fn)
+	{
+		if (!m_filter.empty() && name.find(m_filter) == std::string::npos)
+			return;
+
+		m_results.push_back(sample(name, items, m_samples, m_warmup, fn));
+		const auto &s = m_results.back();
+		*m_out << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(10) << s.median << " ms" << std::setw(10) << s.p95 << " p95" << std::setw(12) << s.nsPerItem() << " ns/item" << std::endl;
+	}
+
+	const std::vector<Summary> &results() const { return m_results; }
+
+	/// extra is a list of "key": value members added to the top-level object.
+	void writeJson(std::ostream &out, const std::vector<std::pair<std::string, std::string>> &extra = {}) const
+	{
+		out << "{\n\t\"suite\": " << quoted(m_name) << ",\n";
+		for (const auto &[key, value] : extra)
+			out << "\t" << quoted(key) << ": " << quoted(value) << ",\n";
+		out << "\t\"samples\": " << m_samples << ",\n\t\"results\": [";
+		for (size_t i = 0; i < m_results.size(); ++i) {
+			const auto &s = m_results[i];
+			out << (i ? ",\n" : "\n") << std::setprecision(6)
+				<< "\t\t{\"name\": " << quoted(s.name)
+				<< ", \"items\": " << s.items
+				<< ", \"samples\": " << s.samples
+				<< ", \"min_ms\": " << s.min
+				<< ", \"median_ms\": " << s.median
+				<< ", \"mean_ms\": " << s.mean
+				<< ", \"p95_ms\": " << s.p95
+				<< ", \"max_ms\": " << s.max
+				<< ", \"stddev_ms\": " << s.stddev
+				<< ", \"ns_per_item\": " << s.nsPerItem() << "}";
+		}
+		out << "\n\t]\n}" << std::endl;
+	}
+
+private:
+	static std::string quoted(const std::string &text)
+	{
+		std::string q = "\"";
+		for (char c : text) {
+			if (c == '"' || c == '\\')
+				q += '\\';
+			if (static_cast<unsigned char>(c) >= 0x20)
+				q += c;
+		}
+		return q + "\"";
+	}
+
+	std::string m_name;
+	std::string m_filter;
+	int m_samples;
+	int m_warmup;
+	std::ostream *m_out = &std::cout;
+	std::vector<Summary> m_results;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
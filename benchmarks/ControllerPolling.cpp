@@ -0,0 +1,141 @@
+/*
+** SDL++, 2020
+** ControllerPolling.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/SDL.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr int frames = 1000;
+	constexpr int maxDevices = 8;
+
+	struct Devices
+	{
+		std::vector<SDL::GameController> controllers;
+		std::vector<SDL::Joystick> joysticks;
+
+		size_t size() const { return controllers.size() + joysticks.size(); }
+	};
+
+	// What a game does without snapshots: one SDL call, taking the joystick
+	// lock, per input read.
+	int readDirect(const Devices &d)
+	{
+		int sum = 0;
+		for (const auto &c : d.controllers) {
+			for (int a = 0; a < SDL_CONTROLLER_AXIS_MAX; ++a)
+				sum += c.getAxis(SDL_GameControllerAxis(a));
+			for (int b = 0; b < SDL_CONTROLLER_BUTTON_MAX; ++b)
+				sum += c.getButton(SDL_GameControllerButton(b));
+		}
+		for (const auto &j : d.joysticks) {
+			for (int a = 0, n = j.axesCount(); a < n; ++a)
+				sum += j.axis(a);
+			for (int b = 0, n = j.buttonsCount(); b < n; ++b)
+				sum += j.button(b);
+			for (int h = 0, n = j.hatsCount(); h < n; ++h)
+				sum += j.hat(h);
+		}
+		return sum;
+	}
+
+	// The same reads from the snapshots of one poll().
+	int readStates(const std::vector<SDL::ControllerState> &states)
+	{
+		int sum = 0;
+		for (const auto &s : states) {
+			for (int a = 0; a < s.axisCount; ++a)
+				sum += s.axis(a);
+			for (int b = 0; b < s.buttonCount; ++b)
+				sum += s.button(b);
+			for (int h = 0; h < s.hatCount; ++h)
+				sum += s.hat(h);
+		}
+		return sum;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Per-frame cost of reading every input of up to 8 controllers: one SDL
+// call per axis, button and hat against ControllerPoller::poll() and reads
+// from its snapshots, then the cost of handing them to another thread.
+// Runs on virtual joysticks where SDL has them (2.0.14), plus the devices
+// connected.
+//
+// usage: sdlpp_bench_controllers [<virtual joysticks>]
+int main(int argc, char **argv)
+{
+	Bench::Suite suite{"controllers", 20};
+
+	try {
+		if (!SDL::init(SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER))
+			throw SDL::Exception{"SDL_Init"};
+
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+		const int virtuals = argc > 1 ? std::stoi(argv[1]) : maxDevices;
+		for (int i = 0; i < virtuals; ++i)
+			if (SDL_JoystickAttachVirtual(SDL_JOYSTICK_TYPE_GAMECONTROLLER, SDL_CONTROLLER_AXIS_MAX, SDL_CONTROLLER_BUTTON_MAX, 1) < 0)
+				throw SDL::Exception{"SDL_JoystickAttachVirtual"};
+#else
+		(void)argc;
+		(void)argv;
+#endif
+
+		Devices devices;
+		SDL::ControllerPoller poller;
+		for (int i = 0, n = SDL_NumJoysticks(); i < n && int(devices.size()) < maxDevices; ++i) {
+			if (SDL_IsGameController(i))
+				poller.add(devices.controllers.emplace_back(i));
+			else
+				poller.add(devices.joysticks.emplace_back(i));
+		}
+		if (devices.size() == 0) {
+			std::cout << "no joystick, skipped" << std::endl;
+			return 0;
+		}
+		std::cout << devices.controllers.size() << " game controllers, " << devices.joysticks.size() << " joysticks" << std::endl;
+
+		suite.run("frame/direct reads", frames, [&] {
+			int sum = 0;
+			for (int f = 0; f < frames; ++f) {
+				SDL_JoystickUpdate();
+				sum += readDirect(devices);
+			}
+			Bench::keep(sum);
+		});
+
+		suite.run("frame/poll+snapshot reads", frames, [&] {
+			int sum = 0;
+			for (int f = 0; f < frames; ++f) {
+				SDL_JoystickUpdate();
+				poller.poll();
+				sum += readStates(poller.states());
+			}
+			Bench::keep(sum);
+		});
+
+		suite.run("frame/poll+latest() reads", frames, [&] {
+			int sum = 0;
+			for (int f = 0; f < frames; ++f) {
+				poller.poll();
+				sum += readStates(poller.latest());
+			}
+			Bench::keep(sum);
+		});
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
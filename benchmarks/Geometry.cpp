@@ -0,0 +1,115 @@
+/*
+** SDL++, 2020
+** Geometry.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/PixelKernels.hpp"
+#include "SDL++/Rect.hpp"
+#include "SDL++/RectArray.hpp"
+#include "SDL++/Vec2.hpp"
+#include "SDL++/Vec2Array.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	const SDL::Kernels::Isa isas[] = {
+		SDL::Kernels::Isa::Scalar,
+		SDL::Kernels::Isa::SSE2,
+		SDL::Kernels::Isa::SSE41,
+		SDL::Kernels::Isa::AVX2,
+	};
+
+	void points(Bench::Suite &suite, size_t count)
+	{
+		std::mt19937 rng{5};
+		std::uniform_real_distribution<float> coord{-1000.0f, 1000.0f};
+		std::vector<SDL::Vec2f> aos(count);
+		for (auto &v : aos)
+			v = SDL::Vec2f{coord(rng), coord(rng)};
+		auto soa = SDL::Vec2fArray::from(aos);
+		const SDL::Rect box{-500, -500, 1000, 1000};
+		std::vector<float> lengths;
+
+		suite.run("aos/translate", count, [&] {
+			for (auto &v : aos)
+				v += SDL::Vec2f{0.5f, -0.5f};
+		});
+		suite.run("aos/length", count, [&] {
+			lengths.resize(aos.size());
+			for (size_t i = 0; i < aos.size(); ++i)
+				lengths[i] = aos[i].length();
+			Bench::keep(lengths);
+		});
+		suite.run("aos/normalize", count, [&] {
+			for (auto &v : aos)
+				v.normalize();
+		});
+
+		for (auto isa : isas) {
+			SDL::Kernels::setIsa(isa);
+			if (SDL::Kernels::isa() != isa)
+				continue;
+
+			const std::string path = std::string{"/"} + SDL::Kernels::isaName(isa);
+			suite.run("soa/translate" + path, count, [&] { soa.translate(SDL::Vec2f{0.5f, -0.5f}); });
+			suite.run("soa/length" + path, count, [&] { soa.lengths(lengths); });
+			suite.run("soa/normalize" + path, count, [&] { soa.normalize(); });
+			suite.run("soa/clamp" + path, count, [&] { soa.clamp(box); });
+			suite.run("soa/bounds" + path, count, [&] { Bench::keep(soa.bounds()); });
+		}
+		SDL::Kernels::setIsa(SDL::Kernels::bestIsa());
+	}
+
+	void rects(Bench::Suite &suite, size_t count)
+	{
+		std::mt19937 rng{6};
+		std::vector<SDL::Rect> aos(count);
+		for (auto &r : aos)
+			r = SDL::Rect{int(rng() % 20000), int(rng() % 20000), int(rng() % 256) + 1, int(rng() % 256) + 1};
+		const auto soa = SDL::RectArray::from(aos);
+		const SDL::Rect view{8000, 8000, 1920, 1080};
+		SDL::RectArray::Mask mask;
+
+		suite.run("aos/intersects", count, [&] {
+			size_t n = 0;
+			for (const auto &r : aos)
+				n += view.intersects(r);
+			Bench::keep(n);
+		});
+
+		for (auto isa : isas) {
+			SDL::Kernels::setIsa(isa);
+			if (SDL::Kernels::isa() != isa)
+				continue;
+
+			const std::string path = std::string{"/"} + SDL::Kernels::isaName(isa);
+			suite.run("soa/intersects" + path, count, [&] { Bench::keep(soa.intersects(view, mask)); });
+			suite.run("soa/contains" + path, count, [&] { Bench::keep(soa.contains(view.center(), mask)); });
+			suite.run("soa/boundingBox" + path, count, [&] { Bench::keep(soa.boundingBox()); });
+		}
+		SDL::Kernels::setIsa(SDL::Kernels::bestIsa());
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Bulk Vec2 and Rect operations on Vec2Array and RectArray against the same
+// loop over Vec2 and Rect objects, for every instruction set available.
+//
+// usage: sdlpp_bench_geometry [count]
+int main(int argc, char **argv)
+{
+	const size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+	Bench::Suite suite{"geometry", 20};
+	points(suite, count);
+	rects(suite, count);
+	return 0;
+}
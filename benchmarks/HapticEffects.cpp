@@ -0,0 +1,136 @@
+/*
+** SDL++, 2020
+** HapticEffects.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/SDL.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr int effects = 5000;
+	constexpr int live = 16;
+
+	// Effect handle bookkeeping as Haptic did it before the slot map: ids
+	// appended forever, destroyed ones overwritten with -1 by a full scan.
+	struct VectorEffects
+	{
+		std::vector<int> ids;
+
+		size_t install(int id)
+		{
+			ids.push_back(id);
+			return ids.size() - 1;
+		}
+
+		int find(size_t index) const { return ids.at(index); }
+
+		void remove(int id)
+		{
+			for (size_t i = 0, n = ids.size(); i < n; ++i)
+				if (ids[i] == id)
+					ids[i] = -1;
+		}
+	};
+
+	// A session's worth of short effects, a few alive at any time: install,
+	// run once, destroy the oldest.
+	void bookkeeping(Bench::Suite &suite)
+	{
+		suite.run("bookkeeping/vector scan", effects, [] {
+			VectorEffects v;
+			size_t ring[live] = {};
+			int sum = 0;
+			for (int i = 0; i < effects; ++i) {
+				if (i >= live)
+					v.remove(v.find(ring[i % live]));
+				ring[i % live] = v.install(i);
+				sum += v.find(ring[i % live]);
+			}
+			Bench::keep(sum);
+		});
+
+		suite.run("bookkeeping/slot map", effects, [] {
+			SDL::SlotMap<int> m;
+			SDL::SlotMap<int>::Key ring[live] = {};
+			int sum = 0;
+			for (int i = 0; i < effects; ++i) {
+				if (i >= live)
+					m.erase(ring[i % live]);
+				ring[i % live] = m.insert(i);
+				sum += *m.find(ring[i % live]);
+			}
+			Bench::keep(sum);
+		});
+	}
+
+	// The same churn on a real device, creating every effect from scratch
+	// against reusing idle ones through SDL_HapticUpdateEffect().
+	void device(Bench::Suite &suite, SDL::Haptic &haptic)
+	{
+		SDL::Haptic::Effect e;
+		e.type = haptic.isCapableOf(SDL_HAPTIC_LEFTRIGHT) ? SDL_HAPTIC_LEFTRIGHT : SDL_HAPTIC_SINE;
+		if (!haptic.isEffectCompatible(e)) {
+			std::cout << "device supports neither left/right nor sine effects, skipped" << std::endl;
+			return;
+		}
+
+		const int count = effects / 10;
+		const auto churn = [&] {
+			std::vector<SDL::Haptic::InstalledEffect> ring(4);
+			for (int i = 0; i < count; ++i) {
+				if (e.type == SDL_HAPTIC_LEFTRIGHT) {
+					e.leftright.length = 20;
+					e.leftright.large_magnitude = Uint16(1000 + i % 64 * 500);
+				} else {
+					e.periodic.length = 20;
+					e.periodic.magnitude = Sint16(1000 + i % 64 * 400);
+				}
+				ring[i % ring.size()] = haptic.newEffect(e);
+			}
+		};
+
+		haptic.setIdleEffectLimit(0);
+		suite.run("device/destroy+create", count, churn);
+		haptic.setIdleEffectLimit(8);
+		suite.run("device/update idle", count, churn);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Cost of thousands of short-lived haptic effects: handle bookkeeping alone,
+// then, if a haptic device is present, the driver calls per effect.
+//
+// usage: sdlpp_bench_haptic [<device index>]
+int main(int argc, char **argv)
+{
+	Bench::Suite suite{"haptic", 20};
+	bookkeeping(suite);
+
+	try {
+		if (!SDL::init(SDL_INIT_HAPTIC))
+			throw SDL::Exception{"SDL_Init"};
+
+		const int index = argc > 1 ? std::stoi(argv[1]) : 0;
+		if (index >= SDL_NumHaptics()) {
+			std::cout << "no haptic device " << index << ", device benchmarks skipped" << std::endl;
+			return 0;
+		}
+
+		SDL::Haptic haptic{index};
+		device(suite, haptic);
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
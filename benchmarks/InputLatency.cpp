@@ -0,0 +1,182 @@
+/*
+** SDL++, 2020
+** InputLatency.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/SDL.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+	using Ms = std::chrono::milliseconds;
+
+	constexpr int buttons = 16;
+	constexpr int taps = 150;
+	constexpr int chunks = 8;
+	constexpr Ms frameTime{33};
+
+	struct Event
+	{
+		Ms at;
+		int button;
+		bool down;
+	};
+
+	struct Result
+	{
+		SDL::LatencyHistogram detected; ///< input to the timestamp the game gets
+		SDL::LatencyHistogram handled;  ///< input to the frame that handles it
+		int presses = 0;
+	};
+
+	// Taps 10 to 60 ms apart, held 5 to 80 ms: some are shorter than a frame.
+	std::vector<Event> schedule()
+	{
+		std::mt19937 rng{45};
+		std::uniform_int_distribution<int> gap{10, 60};
+		std::uniform_int_distribution<int> hold{5, 80};
+
+		std::vector<Event> events;
+		Ms at{100};
+		for (int i = 0; i < taps; ++i) {
+			at += Ms{gap(rng)};
+			events.push_back({at, i % buttons, true});
+			events.push_back({at + Ms{hold(rng)}, i % buttons, false});
+		}
+		std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b) { return a.at < b.at; });
+		return events;
+	}
+
+	// Runs a 30 fps game loop whose frames are made of sleeping chunks while
+	// another thread plays the taps on the virtual joystick. frame(press) is
+	// called at the start of each frame and reports the new presses it sees
+	// as press(button, timestamp); between() runs after every chunk.
+	template<typename Frame, typename Between>
+	Result run(SDL_Joystick *joystick, const std::vector<Event> &events, Frame &&frame, Between &&between)
+	{
+		std::atomic<Uint64> pressedAt[buttons] = {};
+		const auto start = Clock::now();
+
+		std::thread player{[&] {
+			for (const auto &e : events) {
+				std::this_thread::sleep_until(start + e.at);
+				if (e.down)
+					pressedAt[e.button].store(SDL::Timer::perfCounter());
+				SDL_JoystickSetVirtualButton(joystick, e.button, e.down);
+			}
+		}};
+
+		Result r;
+		const Uint64 frequency = SDL::Timer::perfFrequency();
+		const auto press = [&](int button, Uint64 timestamp) {
+			const Uint64 at = pressedAt[button].load();
+			const Uint64 now = SDL::Timer::perfCounter();
+			r.detected.add(timestamp > at ? timestamp - at : 0, frequency);
+			r.handled.add(now - at, frequency);
+			++r.presses;
+		};
+
+		const auto end = start + events.back().at + 2 * frameTime;
+		while (Clock::now() < end) {
+			const auto frameStart = Clock::now();
+			frame(press);
+			for (int c = 1; c <= chunks; ++c) {
+				std::this_thread::sleep_until(frameStart + frameTime * c / chunks);
+				between();
+			}
+		}
+
+		player.join();
+		return r;
+	}
+
+	template<typename Press>
+	void pressEdges(Uint64 &previous, const SDL::ControllerState &state, Uint64 timestamp, Press &&press)
+	{
+		for (int b = 0; b < buttons; ++b)
+			if ((state.buttons >> b & 1) && !(previous >> b & 1))
+				press(b, timestamp);
+		previous = state.buttons;
+	}
+
+	void print(const std::string &name, const Result &r)
+	{
+		const auto ms = [](double us) { return us / 1000.0; };
+		std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(2)
+			<< "detected " << std::setw(7) << ms(r.detected.meanUs()) << " ms mean, " << std::setw(7) << ms(double(r.detected.maxUs())) << " ms max"
+			<< " | handled " << std::setw(7) << ms(r.handled.meanUs()) << " ms mean, " << std::setw(7) << ms(double(r.handled.maxUs())) << " ms max"
+			<< " | " << (taps - r.presses) << "/" << taps << " taps missed" << std::endl;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Input latency of a 30 fps game: polling controllers once per frame against
+// InputSampler in SubFrame and Thread mode, sampling every millisecond. For
+// each press, "detected" is the delay until the time the game attributes it
+// to, "handled" the delay until the frame that reacts to it. Taps released
+// before the next poll are missed. Needs virtual joysticks (SDL 2.0.14).
+//
+// usage: sdlpp_bench_input
+int main()
+{
+#if SDL_VERSION_ATLEAST(2, 0, 14)
+	try {
+		if (!SDL::init(SDL_INIT_JOYSTICK))
+			throw SDL::Exception{"SDL_Init"};
+
+		const int index = SDL_JoystickAttachVirtual(SDL_JOYSTICK_TYPE_GAMECONTROLLER, 0, buttons, 0);
+		if (index < 0)
+			throw SDL::Exception{"SDL_JoystickAttachVirtual"};
+		SDL::Joystick joystick{index};
+		const auto events = schedule();
+
+		{
+			SDL::ControllerPoller poller;
+			poller.add(joystick);
+			Uint64 previous = 0;
+			print("per-frame poll", run(joystick.ptr(), events, [&](auto &&press) {
+				SDL_JoystickUpdate();
+				poller.poll();
+				pressEdges(previous, poller[0], SDL::Timer::perfCounter(), press);
+			}, [] {}));
+		}
+
+		for (const auto mode : {SDL::InputSampler::Mode::SubFrame, SDL::InputSampler::Mode::Thread}) {
+			SDL::ControllerPoller poller;
+			poller.add(joystick);
+			SDL::InputSampler sampler{std::move(poller), mode};
+			Uint64 previous = 0;
+			const Result r = run(joystick.ptr(), events, [&](auto &&press) {
+				sampler.consume([&](const SDL::InputSampler::Sample &s) {
+					pressEdges(previous, s.state, s.timestamp, press);
+				});
+			}, [&] {
+				sampler.sample();
+			});
+			print(sampler.mode() == SDL::InputSampler::Mode::Thread ? "InputSampler/Thread" : "InputSampler/SubFrame", r);
+		}
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+#else
+	std::cout << "needs SDL 2.0.14 virtual joysticks, skipped" << std::endl;
+#endif
+	return 0;
+}
@@ -0,0 +1,409 @@
+/*
+** SDL++, 2020
+** Library.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/SDL.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr int drawCalls = 1000;
+	constexpr int mathItems = 100000;
+	constexpr int eventCount = 10000;
+	constexpr int actionCount = 500;
+
+	struct Options
+	{
+		std::string json;
+		std::string filter;
+		int samples = 30;
+	};
+
+	Options parse(int argc, char **argv)
+	{
+		Options o;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+			if (arg == "--json" && i + 1 < argc)
+				o.json = argv[++i];
+			else if (arg == "--filter" && i + 1 < argc)
+				o.filter = argv[++i];
+			else if (arg == "--samples" && i + 1 < argc)
+				o.samples = std::stoi(argv[++i]);
+			else
+				throw std::invalid_argument{"unknown argument " + arg};
+		}
+		return o;
+	}
+
+	SDL::Surface noise(int w, int h, Uint32 format, bool translucent)
+	{
+		std::mt19937 rng{42};
+		SDL::Surface s{w, h, static_cast<int>(SDL_BITSPERPIXEL(format)), format};
+		auto lock = s.lock();
+		auto bytes = static_cast<Uint8*>(lock.rawArray());
+		for (int i = 0, n = s.ptr()->pitch * h; i < n; ++i)
+			bytes[i] = static_cast<Uint8>(rng());
+		if (translucent)
+			s.setBlendMode(SDL_BLENDMODE_BLEND);
+		return s;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void rendererBenchmarks(Bench::Suite &suite, SDL::Renderer &renderer)
+	{
+		std::mt19937 rng{1};
+		std::vector<SDL::Rect> rects;
+		std::vector<SDL::Vec2i> points;
+		for (int i = 0; i < drawCalls; ++i) {
+			rects.emplace_back(int(rng() % 600), int(rng() % 440), int(rng() % 64) + 1, int(rng() % 64) + 1);
+			points.emplace_back(int(rng() % 640), int(rng() % 480));
+		}
+
+		auto sprite = renderer.makeTexture(noise(64, 64, SDL_PIXELFORMAT_ARGB8888, true));
+		sprite.setBlendMode(SDL_BLENDMODE_BLEND);
+		const SDL::Rect spriteRect{0, 0, 64, 64};
+
+		suite.run("renderer/clear", 1, [&] { renderer.clear(SDL::Color::Black); });
+		suite.run("renderer/fillRect", drawCalls, [&] {
+			for (const auto &r : rects)
+				renderer.fillRect(r, SDL::Color::Red);
+		});
+		suite.run("renderer/fillRects batched", drawCalls, [&] { renderer.fillRects(rects, SDL::Color::Blue); });
+		suite.run("renderer/drawLine", drawCalls, [&] {
+			for (size_t i = 1; i < points.size(); ++i)
+				renderer.drawLine(points[i - 1], points[i], SDL::Color::Green);
+		});
+		suite.run("renderer/drawPoints batched", drawCalls, [&] { renderer.drawPoints(points, SDL::Color::White); });
+		suite.run("renderer/copy 64x64 blended", drawCalls, [&] {
+			for (const auto &r : rects)
+				renderer.copy(sprite, spriteRect, SDL::Rect{r.x, r.y, 64, 64});
+		});
+		suite.run("renderer/present", 1, [&] { renderer.present(); });
+
+		// Scrolling map: a quarter of the rectangles on screen.
+		std::vector<SDL::Rect> map;
+		for (const auto &r : rects)
+			map.emplace_back(r.x * 2 - 320, r.y * 2 - 240, r.w, r.h);
+		renderer.setCulling(true);
+		suite.run("renderer/fillRect culled", drawCalls, [&] {
+			for (const auto &r : map)
+				renderer.fillRect(r, SDL::Color::Red);
+		});
+		suite.run("renderer/fillRects batched culled", drawCalls, [&] { renderer.fillRects(map, SDL::Color::Blue); });
+		renderer.setCulling(false);
+
+		// A HUD panel of a few hundred primitives that rarely changes.
+		std::vector<SDL::Rect> panel;
+		for (int i = 0; i < 200; ++i)
+			panel.emplace_back(int(rng() % 240), int(rng() % 112), 16, 16);
+		const auto paintPanel = [&](SDL::Renderer &r) {
+			r.fillRect(SDL::Rect{0, 0, 256, 128}, SDL::Color{0, 0, 0, 160});
+			for (const auto &p : panel)
+				r.drawRect(p, SDL::Color::Green);
+		};
+		SDL::CachedLayer layer{SDL::Vec2i{256, 128}};
+		suite.run("renderer/panel primitives", 1, [&] { paintPanel(renderer); });
+		suite.run("renderer/panel cached layer", 1, [&] { layer.draw(renderer, SDL::Vec2i{0, 0}, paintPanel); });
+	}
+
+	void textureBenchmarks(Bench::Suite &suite, SDL::Renderer &renderer)
+	{
+		constexpr int size = 512;
+		auto texture = renderer.makeTexture(size, size, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING);
+		const auto source = noise(size, size, SDL_PIXELFORMAT_ARGB8888, false);
+		const size_t pixels = size_t(size) * size;
+
+		suite.run("texture/update 512x512", pixels, [&] {
+			auto lock = source.lock();
+			texture.update(lock.rawArray(), source.ptr()->pitch);
+		});
+		suite.run("texture/lock+write 512x512", pixels, [&] {
+			auto lock = texture.lock();
+			for (int y = 0; y < lock.height(); ++y)
+				std::memset(lock.pixels() + y * lock.pitch(), y, size_t(lock.width()) * 4);
+		});
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	// A screen full of 8x16 glyphs, as a debug overlay or a dense HUD.
+	void textBenchmarks(Bench::Suite &suite, SDL::Renderer &renderer)
+	{
+		const auto sheet = noise(128, 96, SDL_PIXELFORMAT_ARGB8888, true);
+		auto font = SDL::BitmapFont::fromGrid(renderer, sheet, SDL::Vec2i{8, 16});
+
+		std::mt19937 rng{3};
+		std::vector<std::string> lines(480 / 16);
+		for (auto &line : lines)
+			for (int i = 0; i < 640 / 8; ++i)
+				line += char(' ' + 1 + rng() % 94);
+		const size_t glyphs = lines.size() * lines[0].size();
+
+		SDL::BitmapFont::Layout layout;
+		suite.run("text/layout", glyphs, [&] {
+			for (const auto &line : lines)
+				font.layout(line, layout);
+			Bench::keep(layout.quads.size());
+		});
+
+		auto &page = font.page(0);
+		suite.run("text/copy per glyph", glyphs, [&] {
+			for (size_t l = 0; l < lines.size(); ++l) {
+				font.layout(lines[l], layout);
+				for (const auto &q : layout.quads)
+					renderer.copy(page, q.source, SDL::Rect{q.dest.x, q.dest.y + int(l) * 16, q.dest.w, q.dest.h});
+			}
+		});
+
+		SDL::TextRenderer text;
+		suite.run("text/draw+flush cached", glyphs, [&] {
+			for (size_t l = 0; l < lines.size(); ++l)
+				text.draw(font, lines[l], SDL::Vec2f{0.0f, float(l) * 16.0f}, SDL::Color::White);
+			text.flush(renderer);
+		});
+	}
+#endif
+
+	void surfaceBenchmarks(Bench::Suite &suite)
+	{
+		constexpr int size = 1024;
+		const size_t pixels = size_t(size) * size;
+		const auto argb = noise(size, size, SDL_PIXELFORMAT_ARGB8888, true);
+		const auto opaque = noise(size, size, SDL_PIXELFORMAT_XRGB8888, false);
+		SDL::Surface target{size, size, 32, SDL_PIXELFORMAT_ARGB8888};
+		const SDL::Rect all{0, 0, size, size};
+
+		suite.run("surface/convert ARGB->ABGR", pixels, [&] { Bench::keep(argb.withFormat(SDL_PIXELFORMAT_ABGR8888)); });
+		suite.run("surface/convert ARGB->RGB24", pixels, [&] { Bench::keep(argb.withFormat(SDL_PIXELFORMAT_RGB24)); });
+		suite.run("surface/convert ARGB->RGB565", pixels, [&] { Bench::keep(argb.withFormat(SDL_PIXELFORMAT_RGB565)); });
+		suite.run("surface/blit blended", pixels, [&] { argb.blitOn(target, all); });
+		suite.run("surface/blit opaque", pixels, [&] { opaque.blitOn(target, all); });
+		suite.run("surface/fill", pixels, [&] { target.fill(0xff336699u); });
+		suite.run("surface/scaled bilinear 1/2", pixels, [&] {
+			Bench::keep(argb.scaled(SDL::Vec2i{size / 2, size / 2}, SDL::Surface::Filter::Bilinear));
+		});
+	}
+
+	void pixelBenchmarks(Bench::Suite &suite)
+	{
+		constexpr int size = 256;
+		SDL::Surface surface{size, size, 32, SDL_PIXELFORMAT_ARGB8888};
+		const size_t pixels = size_t(size) * size;
+
+		suite.run("pixel/write Color", pixels, [&] {
+			auto lock = surface.lock();
+			for (int y = 0; y < size; ++y)
+				for (int x = 0; x < size; ++x)
+					lock.at(x, y) = SDL::Color{Uint8(x), Uint8(y), 0};
+		});
+		suite.run("pixel/read Color", pixels, [&] {
+			auto lock = surface.lock();
+			unsigned sum = 0;
+			for (int y = 0; y < size; ++y)
+				for (int x = 0; x < size; ++x)
+					sum += lock.at(x, y).color().r;
+			Bench::keep(sum);
+		});
+	}
+
+	void eventBenchmarks(Bench::Suite &suite)
+	{
+		const Uint32 type = SDL_RegisterEvents(1);
+		SDL::Event event;
+		event.type = type;
+
+		suite.run("events/push+poll", eventCount, [&] {
+			for (int i = 0; i < eventCount; ++i) {
+				event.user.code = i;
+				event.push();
+			}
+			SDL::Event e;
+			int polled = 0;
+			while (e.poll())
+				polled += e.type == type;
+			Bench::keep(polled);
+		});
+	}
+
+	void inputBenchmarks(Bench::Suite &suite)
+	{
+		// Actions bound to letters, digits and keypad keys, a few per key,
+		// against checking each action's key by name every frame.
+		SDL::ActionMap actions;
+		std::vector<std::pair<std::string, SDL_Scancode>> named;
+		for (int i = 0; i < actionCount; ++i) {
+			const auto scancode = SDL_Scancode(SDL_SCANCODE_A + i % 96);
+			const std::string name = "action" + std::to_string(i);
+			actions.bind(name, std::string{"key:"} + SDL_GetScancodeName(scancode));
+			named.emplace_back(name, scancode);
+		}
+
+		std::vector<Uint8> keys(SDL_NUM_SCANCODES);
+		for (int i = SDL_SCANCODE_A; i < SDL_SCANCODE_A + 96; i += 7)
+			keys[i] = 1;
+
+		suite.run("input/actions update", actionCount, [&] {
+			actions.update(keys.data(), 0, nullptr, 0);
+			int down = 0;
+			for (SDL::ActionMap::Action a = 0; a < actionCount; ++a)
+				down += actions.down(a);
+			Bench::keep(down);
+		});
+
+		suite.run("input/actions by name", actionCount, [&] {
+			int down = 0;
+			for (const auto &[name, scancode] : named)
+				down += actions.action(name) != SDL::ActionMap::invalid && keys[scancode];
+			Bench::keep(down);
+		});
+	}
+
+	void mathBenchmarks(Bench::Suite &suite)
+	{
+		std::mt19937 rng{3};
+		std::vector<SDL::Rect> rects;
+		std::vector<SDL::Vec2f> vecs;
+		for (int i = 0; i < mathItems; ++i) {
+			rects.emplace_back(int(rng() % 2000), int(rng() % 2000), int(rng() % 200) + 1, int(rng() % 200) + 1);
+			vecs.emplace_back(float(rng() % 1000) - 500.0f, float(rng() % 1000) + 1.0f);
+		}
+		const SDL::Rect view{500, 500, 800, 600};
+
+		suite.run("rect/intersects", mathItems, [&] {
+			int n = 0;
+			for (const auto &r : rects)
+				n += view.intersects(r);
+			Bench::keep(n);
+		});
+		suite.run("rect/contains", mathItems, [&] {
+			int n = 0;
+			for (const auto &r : rects)
+				n += view.contains(r.center());
+			Bench::keep(n);
+		});
+		suite.run("rect/inter", mathItems, [&] {
+			int area = 0;
+			for (const auto &r : rects) {
+				const auto i = view.inter(r);
+				area += i.w * i.h;
+			}
+			Bench::keep(area);
+		});
+		suite.run("vec2/normalized", mathItems, [&] {
+			SDL::Vec2f sum;
+			for (const auto &v : vecs)
+				sum += v.normalized();
+			Bench::keep(sum);
+		});
+		suite.run("vec2/length", mathItems, [&] {
+			float sum = 0.0f;
+			for (const auto &v : vecs)
+				sum += v.length();
+			Bench::keep(sum);
+		});
+	}
+
+	void colorBenchmarks(Bench::Suite &suite)
+	{
+		auto format = SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
+		if (!format)
+			throw SDL::Exception{"SDL_AllocFormat"};
+
+		suite.run("color/asUint", mathItems, [&] {
+			Uint32 sum = 0;
+			for (int i = 0; i < mathItems; ++i)
+				sum += SDL::Color{Uint8(i), Uint8(i >> 8), Uint8(i >> 16)}.asUint(*format);
+			Bench::keep(sum);
+		});
+		suite.run("color/from raw", mathItems, [&] {
+			unsigned sum = 0;
+			for (int i = 0; i < mathItems; ++i)
+				sum += SDL::Color{Uint32(i) * 2654435761u, *format}.g;
+			Bench::keep(sum);
+		});
+		suite.run("color/asUint by format enum", mathItems / 100, [&] {
+			Uint32 sum = 0;
+			for (int i = 0; i < mathItems / 100; ++i)
+				sum += SDL::Color{Uint8(i), 0, 0}.asUint(SDL_PIXELFORMAT_ABGR8888);
+			Bench::keep(sum);
+		});
+
+		SDL_FreeFormat(format);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Headless regression suite over the paths applications hit every frame:
+// dummy video and audio drivers and the software renderer, so results do not
+// depend on a GPU or a display.
+//
+// With --json -, the JSON goes alone to standard output and the results
+// table to standard error.
+//
+// usage: sdlpp_bench [--json <file>|-] [--filter <substring>] [--samples <n>]
+int main(int argc, char **argv)
+{
+	try {
+		const auto options = parse(argc, argv);
+
+		SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+		SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+		if (!SDL::init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_EVENTS))
+			throw SDL::Exception{"SDL_Init"};
+
+		SDL::Window window{"sdlpp_bench", SDL::Vec2i{640, 480}, SDL_WINDOW_HIDDEN};
+		auto renderer = window.makeRenderer(SDL_RENDERER_SOFTWARE);
+
+		Bench::Suite suite{"sdlpp", options.samples};
+		suite.setFilter(options.filter);
+		if (options.json == "-")
+			suite.setOutput(std::cerr);
+
+		rendererBenchmarks(suite, renderer);
+		textureBenchmarks(suite, renderer);
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+		textBenchmarks(suite, renderer);
+#endif
+		surfaceBenchmarks(suite);
+		pixelBenchmarks(suite);
+		eventBenchmarks(suite);
+		inputBenchmarks(suite);
+		mathBenchmarks(suite);
+		colorBenchmarks(suite);
+
+		const std::vector<std::pair<std::string, std::string>> extra = {
+			{"sdl", SDL::version()},
+			{"platform", SDL::platform()},
+			{"cpus", std::to_string(SDL::System::CPUCount())},
+			{"isa", SDL::Kernels::isaName(SDL::Kernels::isa())},
+		};
+		if (options.json == "-") {
+			suite.writeJson(std::cout, extra);
+		} else if (!options.json.empty()) {
+			std::ofstream out{options.json};
+			suite.writeJson(out, extra);
+			if (!out)
+				throw std::runtime_error{"could not write " + options.json};
+		}
+	}
+	catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
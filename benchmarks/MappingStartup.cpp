@@ -0,0 +1,57 @@
+/*
+** SDL++, 2020
+** MappingStartup.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/GameController.hpp"
+#include "SDL++/MappingDatabase.hpp"
+
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Compares handing a whole mapping database to SDL with opening an index
+// built from it by `sdlpp_mapindex` and adding the connected joysticks'
+// mappings only.
+int main(int argc, char **argv)
+{
+	if (argc < 3) {
+		std::cerr << "usage: " << argv[0] << " <index> <gamecontrollerdb.txt>" << std::endl;
+		return 1;
+	}
+
+	const std::string indexPath = argv[1];
+	const std::string databasePath = argv[2];
+
+	try {
+		if (SDL_Init(SDL_INIT_GAMECONTROLLER) != 0)
+			throw SDL::Exception{"SDL_Init"};
+
+		// Warm the page cache so both runs start equal.
+		SDL::MappingDatabase{indexPath};
+		SDL_free(SDL_LoadFile(databasePath.c_str(), nullptr));
+
+		int loaded = 0;
+		const double textMs = Bench::measureMs([&] {
+			loaded = SDL::GameController::loadMappingDatabase(databasePath);
+		});
+		Bench::report("SDL_GameControllerAddMappingsFromFile", textMs, size_t(loaded));
+
+		size_t entries = 0;
+		const double indexMs = Bench::measureMs([&] {
+			SDL::MappingDatabase index{indexPath};
+			index.addConnected();
+			entries = index.entryCount();
+		});
+		Bench::report("index open + connected mappings", indexMs, entries);
+	}
+	catch (const SDL::Exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	SDL_Quit();
+	return 0;
+}
@@ -0,0 +1,77 @@
+/*
+** SDL++, 2020
+** ParallelScaling.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/Parallel.hpp"
+#include "SDL++/Surface.hpp"
+#include "SDL++/Utils.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr int iterations = 5;
+
+	struct Operation
+	{
+		const char *name;
+		std::function<void()> run;
+	};
+
+	double bestOf(const std::function<void()> &fn)
+	{
+		double best = 0.0;
+		for (int i = 0; i < iterations; ++i) {
+			const double ms = Bench::measureMs(fn);
+			best = i == 0 ? ms : std::min(best, ms);
+		}
+		return best;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Runs the banded surface operations on an 8K image with 1, 2, 4 and 8
+// threads and prints the speedup over the single-threaded run.
+int main(int argc, char **argv)
+{
+	const int w = argc > 2 ? std::stoi(argv[1]) : 7680;
+	const int h = argc > 2 ? std::stoi(argv[2]) : 4320;
+
+	SDL::Surface image{w, h, 32, SDL_PIXELFORMAT_ARGB8888};
+	SDL::Surface target{w, h, 32, SDL_PIXELFORMAT_ARGB8888};
+	image.fill(SDL::Color{200, 100, 50, 128});
+	image.setBlendMode(SDL_BLENDMODE_BLEND);
+
+	const std::vector<Operation> operations = {
+		{"convert ARGB->ABGR", [&] { image.withFormat(SDL_PIXELFORMAT_ABGR8888); }},
+		{"convert ARGB->RGB24", [&] { image.withFormat(SDL_PIXELFORMAT_RGB24); }},
+		{"fill", [&] { target.fill(0xff204060u); }},
+		{"blit blend", [&] { image.blitOn(target, SDL::Rect{0, 0, w, h}); }},
+		{"scale nearest 1/2", [&] { image.scaled(SDL::Vec2i{w / 2, h / 2}); }},
+	};
+
+	const size_t pixels = static_cast<size_t>(w) * h;
+	std::cout << w << "x" << h << ", " << SDL::System::CPUCount() << " logical CPUs" << std::endl;
+
+	for (const auto &op : operations) {
+		double single = 0.0;
+		for (int threads : {1, 2, 4, 8}) {
+			SDL::ThreadPool::shared().resize(threads);
+			const double ms = bestOf(op.run);
+			if (threads == 1)
+				single = ms;
+			Bench::report(std::string{op.name} + " x" + std::to_string(threads), ms, pixels / 1000000);
+			std::cout << "    speedup " << std::fixed << std::setprecision(2) << single / ms << std::endl;
+		}
+	}
+	return 0;
+}
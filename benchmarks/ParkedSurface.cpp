@@ -0,0 +1,72 @@
+/*
+** SDL++, 2020
+** ParkedSurface.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/ParkedSurface.hpp"
+#include "SDL++/Surface.hpp"
+
+#include <random>
+#include <string>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// Panels, buttons and text-like speckles on a flat background.
+	SDL::Surface interface(int w, int h)
+	{
+		std::mt19937 rng{7};
+		SDL::Surface s{w, h, 32, SDL_PIXELFORMAT_ARGB8888};
+		s.fill(SDL::Color{32, 34, 40});
+		for (int i = 0; i < 60; ++i) {
+			const SDL::Rect r{int(rng() % w), int(rng() % h), int(rng() % 400) + 20, int(rng() % 200) + 10};
+			s.fillRect(r, SDL::Color{Uint8(rng()), Uint8(rng()), Uint8(rng())});
+		}
+		for (int i = 0; i < 20000; ++i)
+			s.fillRect(SDL::Rect{int(rng() % w), int(rng() % h), 2, 3}, SDL::Color{230, 230, 230});
+		return s;
+	}
+
+	SDL::Surface noise(int w, int h)
+	{
+		std::mt19937 rng{7};
+		SDL::Surface s{w, h, 32, SDL_PIXELFORMAT_ARGB8888};
+		auto lock = s.lock();
+		auto bytes = static_cast<Uint8*>(lock.rawArray());
+		for (int i = 0, n = s.ptr()->pitch * h; i < n; ++i)
+			bytes[i] = static_cast<Uint8>(rng());
+		return s;
+	}
+
+	void run(const std::string &name, SDL::Surface image)
+	{
+		const size_t megapixels = static_cast<size_t>(image.width()) * image.height() / 1000000;
+		SDL::ParkedSurface parked{std::move(image), false};
+
+		Bench::report(name + " park", Bench::measureMs([&] { parked.park(); }), megapixels);
+		const auto totals = SDL::ParkedSurface::totals();
+		Bench::report(name + " copy", Bench::measureMs([&] { parked.copy(); }), megapixels);
+		Bench::report(name + " unpark", Bench::measureMs([&] { parked.unpark(); }), megapixels);
+
+		std::cout << "    " << totals.parkedPixelBytes / 1024 << " KiB -> " << totals.parkedBytes / 1024 << " KiB, ratio "
+			<< std::setprecision(2) << totals.ratio() << std::endl;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Park and restore time, and compression ratio, for a UI-like image and for
+// incompressible noise (the worst case).
+int main(int argc, char **argv)
+{
+	const int w = argc > 2 ? std::stoi(argv[1]) : 2560;
+	const int h = argc > 2 ? std::stoi(argv[2]) : 1440;
+
+	run("ui", interface(w, h));
+	run("noise", noise(w, h));
+	return 0;
+}
@@ -0,0 +1,191 @@
+/*
+** SDL++, 2020
+** PixelKernels.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/PixelKernels.hpp"
+#include "SDL++/Surface.hpp"
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr int iterations = 10;
+
+	const Uint32 formats[] = {
+		SDL_PIXELFORMAT_ARGB8888,
+		SDL_PIXELFORMAT_ABGR8888,
+		SDL_PIXELFORMAT_XRGB8888,
+		SDL_PIXELFORMAT_RGB24,
+		SDL_PIXELFORMAT_BGR24,
+	};
+
+	const SDL::Kernels::Isa isas[] = {
+		SDL::Kernels::Isa::Scalar,
+		SDL::Kernels::Isa::SSE2,
+		SDL::Kernels::Isa::SSE41,
+		SDL::Kernels::Isa::AVX2,
+		SDL::Kernels::Isa::NEON,
+	};
+
+	SDL::Surface noise(int size, Uint32 format)
+	{
+		std::mt19937 rng{42};
+		SDL::Surface s{size, size, static_cast<int>(SDL_BITSPERPIXEL(format)), format};
+		auto lock = s.lock();
+		auto bytes = static_cast<Uint8*>(lock.rawArray());
+		for (int i = 0, n = s.ptr()->pitch * size; i < n; ++i)
+			bytes[i] = static_cast<Uint8>(rng());
+		return s;
+	}
+
+	std::string label(const char *what, int size, const char *path)
+	{
+		return std::string{what} + " " + std::to_string(size) + "px " + path;
+	}
+
+	void convertMatrix(int size)
+	{
+		for (Uint32 from : formats) {
+			for (Uint32 to : formats) {
+				if (!SDL::Kernels::converter(from, to))
+					continue;
+
+				const auto src = noise(size, from);
+				const std::string pair = std::string{SDL_GetPixelFormatName(from)} + "->" + SDL_GetPixelFormatName(to);
+
+				const double sdlMs = Bench::measureMs([&] {
+					for (int i = 0; i < iterations; ++i)
+						SDL_FreeSurface(SDL_ConvertSurfaceFormat(src.ptr(), to, 0));
+				});
+				Bench::report(label(pair.c_str(), size, "sdl"), sdlMs / iterations);
+
+				for (auto isa : isas) {
+					SDL::Kernels::setIsa(isa);
+					if (SDL::Kernels::isa() != isa)
+						continue;
+					const double ms = Bench::measureMs([&] {
+						for (int i = 0; i < iterations; ++i)
+							SDL_FreeSurface(SDL::Kernels::convertSurface(src.ptr(), to));
+					});
+					Bench::report(label(pair.c_str(), size, SDL::Kernels::isaName(isa)), ms / iterations);
+				}
+				SDL::Kernels::setIsa(SDL::Kernels::bestIsa());
+			}
+		}
+	}
+
+	void blendMatrix(int size)
+	{
+		for (Uint32 format : {SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_ABGR8888}) {
+			const auto src = noise(size, format);
+			auto dst = noise(size, format);
+			src.setBlendMode(SDL_BLENDMODE_BLEND);
+			const std::string name = std::string{"blend "} + SDL_GetPixelFormatName(format);
+
+			const double sdlMs = Bench::measureMs([&] {
+				for (int i = 0; i < iterations; ++i)
+					SDL_BlitSurface(src.ptr(), nullptr, dst.ptr(), nullptr);
+			});
+			Bench::report(label(name.c_str(), size, "sdl"), sdlMs / iterations);
+
+			for (auto isa : isas) {
+				SDL::Kernels::setIsa(isa);
+				if (SDL::Kernels::isa() != isa)
+					continue;
+				const double ms = Bench::measureMs([&] {
+					for (int i = 0; i < iterations; ++i)
+						SDL::Kernels::blitSurface(src.ptr(), nullptr, dst.ptr(), nullptr);
+				});
+				Bench::report(label(name.c_str(), size, SDL::Kernels::isaName(isa)), ms / iterations);
+			}
+			SDL::Kernels::setIsa(SDL::Kernels::bestIsa());
+		}
+	}
+
+	void premultipliedMatrix(int size)
+	{
+		const auto src = noise(size, SDL_PIXELFORMAT_ARGB8888);
+		auto work = noise(size, SDL_PIXELFORMAT_ARGB8888);
+		auto dst = noise(size, SDL_PIXELFORMAT_ARGB8888);
+
+		for (auto isa : isas) {
+			SDL::Kernels::setIsa(isa);
+			if (SDL::Kernels::isa() != isa)
+				continue;
+			const char *path = SDL::Kernels::isaName(isa);
+
+			Bench::report(label("premultiply", size, path), Bench::measureMs([&] {
+				for (int i = 0; i < iterations; ++i)
+					SDL::Kernels::premultiplySurface(work.ptr());
+			}) / iterations);
+			Bench::report(label("unpremultiply", size, path), Bench::measureMs([&] {
+				for (int i = 0; i < iterations; ++i)
+					SDL::Kernels::unpremultiplySurface(work.ptr());
+			}) / iterations);
+			Bench::report(label("blend premultiplied", size, path), Bench::measureMs([&] {
+				for (int i = 0; i < iterations; ++i)
+					SDL::Kernels::blitPremultiplied(src.ptr(), nullptr, dst.ptr(), nullptr);
+			}) / iterations);
+		}
+		SDL::Kernels::setIsa(SDL::Kernels::bestIsa());
+	}
+
+	void resampleMatrix(int size)
+	{
+		const std::pair<const char*, SDL::Kernels::Filter> filters[] = {
+			{"box", SDL::Kernels::Filter::Box},
+			{"bilinear", SDL::Kernels::Filter::Bilinear},
+			{"lanczos", SDL::Kernels::Filter::Lanczos},
+		};
+
+		const auto src = noise(size, SDL_PIXELFORMAT_ARGB8888);
+		for (int target : {size / 4, size * 2}) {
+			SDL::Surface dst{target, target, 32, SDL_PIXELFORMAT_ARGB8888};
+			const std::string resize = std::to_string(size) + "->" + std::to_string(target);
+
+			const double sdlMs = Bench::measureMs([&] {
+				for (int i = 0; i < iterations; ++i)
+					SDL_SoftStretch(src.ptr(), nullptr, dst.ptr(), nullptr);
+			});
+			Bench::report(label(("nearest " + resize).c_str(), size, "sdl"), sdlMs / iterations);
+
+			for (const auto &[name, filter] : filters) {
+				for (auto isa : isas) {
+					SDL::Kernels::setIsa(isa);
+					if (SDL::Kernels::isa() != isa)
+						continue;
+					const double ms = Bench::measureMs([&] {
+						for (int i = 0; i < iterations; ++i)
+							SDL::Kernels::resample(src.ptr(), dst.ptr(), filter);
+					});
+					Bench::report(label((std::string{name} + " " + resize).c_str(), size, SDL::Kernels::isaName(isa)), ms / iterations);
+				}
+			}
+			SDL::Kernels::setIsa(SDL::Kernels::bestIsa());
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	std::cout << "best instruction set: " << SDL::Kernels::isaName(SDL::Kernels::bestIsa()) << std::endl;
+
+	for (int size : {256, 1024, 4096}) {
+		convertMatrix(size);
+		blendMatrix(size);
+		premultipliedMatrix(size);
+	}
+	for (int size : {256, 1024})
+		resampleMatrix(size);
+	return 0;
+}
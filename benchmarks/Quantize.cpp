@@ -0,0 +1,101 @@
+/*
+** SDL++, 2020
+** Quantize.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/Quantize.hpp"
+#include "SDL++/Surface.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr int iterations = 5;
+
+	struct Operation
+	{
+		const char *name;
+		std::function<void()> run;
+	};
+
+	// Smooth gradients with some noise, closer to photographic content than
+	// pure noise, which would make every palette look equally bad.
+	SDL::Surface gradient(int w, int h)
+	{
+		std::mt19937 rng{42};
+		std::uniform_int_distribution<int> noise{-6, 6};
+		SDL::Surface s{w, h, 32, SDL_PIXELFORMAT_ARGB8888};
+		auto lock = s.lock();
+		for (int y = 0; y < h; ++y) {
+			auto row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(lock.rawArray()) + y * s.ptr()->pitch);
+			for (int x = 0; x < w; ++x) {
+				const int r = std::clamp(x * 255 / w + noise(rng), 0, 255);
+				const int g = std::clamp(y * 255 / h + noise(rng), 0, 255);
+				const int b = std::clamp(int(127.5 + 127.5 * std::sin(x * 0.01 + y * 0.02)) + noise(rng), 0, 255);
+				row[x] = 0xff000000u | Uint32(r) << 16 | Uint32(g) << 8 | Uint32(b);
+			}
+		}
+		return s;
+	}
+
+	double bestOf(const std::function<void()> &fn)
+	{
+		double best = 0.0;
+		for (int i = 0; i < iterations; ++i) {
+			const double ms = Bench::measureMs(fn);
+			best = i == 0 ? ms : std::min(best, ms);
+		}
+		return best;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Reports time and throughput of every quantization mode on a 1080p frame,
+// next to the plain SDL conversion to RGB565.
+int main(int argc, char **argv)
+{
+	const int w = argc > 2 ? std::stoi(argv[1]) : 1920;
+	const int h = argc > 2 ? std::stoi(argv[2]) : 1080;
+
+	const SDL::Surface frame = gradient(w, h);
+	const auto palette = SDL::Quantize::medianCut(frame);
+
+	SDL::Surface target565{w, h, 16, SDL_PIXELFORMAT_RGB565};
+	SDL::Surface targetIndexed{w, h, 8, SDL_PIXELFORMAT_INDEX8};
+	SDL::Quantizer ordered{palette, SDL::Dither::Ordered};
+	SDL::Quantizer none{palette, SDL::Dither::None};
+	SDL::Quantizer diffused{palette, SDL::Dither::FloydSteinberg};
+
+	const std::vector<Operation> operations = {
+		{"SDL withFormat RGB565", [&] { frame.withFormat(SDL_PIXELFORMAT_RGB565); }},
+		{"RGB565 none", [&] { SDL::Quantize::toRGB565(frame, target565, SDL::Dither::None); }},
+		{"RGB565 ordered", [&] { SDL::Quantize::toRGB565(frame, target565, SDL::Dither::Ordered); }},
+		{"RGB565 floyd-steinberg", [&] { SDL::Quantize::toRGB565(frame, target565, SDL::Dither::FloydSteinberg); }},
+		{"median cut 256", [&] { SDL::Quantize::medianCut(frame); }},
+		{"palette table 256", [&] { SDL::Quantizer{palette}; }},
+		{"INDEX8 stream none", [&] { none.convert(frame, targetIndexed); }},
+		{"INDEX8 stream ordered", [&] { ordered.convert(frame, targetIndexed); }},
+		{"INDEX8 stream floyd-steinberg", [&] { diffused.convert(frame, targetIndexed); }},
+		{"INDEX8 one-shot floyd-steinberg", [&] { SDL::Quantize::toIndexed(frame); }},
+	};
+
+	const double megapixels = double(w) * double(h) / 1000000.0;
+	std::cout << w << "x" << h << " (" << std::fixed << std::setprecision(2) << megapixels << " MP)" << std::endl;
+
+	for (const auto &op : operations) {
+		const double ms = bestOf(op.run);
+		Bench::report(op.name, ms);
+		std::cout << "    " << std::setprecision(3) << ms / megapixels << " ms/MP, " << std::setprecision(1) << megapixels * 1000.0 / ms << " MP/s" << std::endl;
+	}
+	return 0;
+}
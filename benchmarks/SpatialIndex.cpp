@@ -0,0 +1,127 @@
+/*
+** SDL++, 2020
+** SpatialIndex.cpp
+*/
+
+#include "Bench.hpp"
+
+#include "SDL++/LooseQuadtree.hpp"
+#include "SDL++/Rect.hpp"
+#include "SDL++/RectArray.hpp"
+#include "SDL++/SpatialHash.hpp"
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr int queries = 1000;
+	constexpr int moves = 10000;
+
+	using Objects = std::vector<std::pair<Uint32, SDL::Rect>>;
+
+	// Constant density: the world grows with the object count, and the
+	// views stay screen sized.
+	struct Scene
+	{
+		int side;
+		Objects objects;
+		std::vector<SDL::Rect> views;
+		std::vector<SDL::Vec2i> points;
+		std::vector<SDL::Rect> moved;
+	};
+
+	Scene scene(size_t count)
+	{
+		std::mt19937 rng{9};
+		Scene s;
+		s.side = static_cast<int>(std::sqrt(double(count)) * 64.0);
+		for (size_t i = 0; i < count; ++i) {
+			const int size = i % 100 == 0 ? 512 : 8 + int(rng() % 56);
+			s.objects.emplace_back(Uint32(i), SDL::Rect{int(rng() % s.side), int(rng() % s.side), size, size});
+		}
+		for (int i = 0; i < queries; ++i) {
+			s.views.emplace_back(int(rng() % s.side), int(rng() % s.side), 1920, 1080);
+			s.points.emplace_back(int(rng() % s.side), int(rng() % s.side));
+		}
+		for (int i = 0; i < moves; ++i) {
+			auto r = s.objects[rng() % count].second;
+			r.x += int(rng() % 33) - 16;
+			r.y += int(rng() % 33) - 16;
+			s.moved.push_back(r);
+		}
+		return s;
+	}
+
+	template<class Index>
+	void run(Bench::Suite &suite, const std::string &name, Index index, const Scene &s)
+	{
+		const size_t count = s.objects.size();
+		std::vector<Uint32> found;
+
+		suite.run(name + "/rebuild", count, [&] { index.rebuild(s.objects); });
+		suite.run(name + "/query view", queries, [&] {
+			size_t total = 0;
+			for (const auto &v : s.views) {
+				index.query(v, found);
+				total += found.size();
+			}
+			Bench::keep(total);
+		});
+		suite.run(name + "/query point", queries, [&] {
+			size_t total = 0;
+			for (const auto &p : s.points) {
+				index.query(p, found);
+				total += found.size();
+			}
+			Bench::keep(total);
+		});
+		suite.run(name + "/move", moves, [&] {
+			for (int i = 0; i < moves; ++i)
+				index.move(Uint32(i * 7919 % count), s.moved[i]);
+		});
+	}
+
+	void bruteForce(Bench::Suite &suite, const std::string &name, const Scene &s)
+	{
+		SDL::RectArray rects;
+		for (const auto &o : s.objects)
+			rects.push_back(o.second);
+		SDL::RectArray::Mask mask;
+
+		suite.run(name + "/query view", queries, [&] {
+			size_t total = 0;
+			for (const auto &v : s.views)
+				total += rects.intersects(v, mask);
+			Bench::keep(total);
+		});
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Rebuild, query and move throughput of SpatialHash and LooseQuadtree, with
+// a SIMD brute-force scan over RectArray as reference.
+//
+// usage: sdlpp_bench_spatial [--no-brute-force]
+int main(int argc, char **argv)
+{
+	const bool brute = !(argc > 1 && std::string{argv[1]} == "--no-brute-force");
+
+	Bench::Suite suite{"spatial", 5, 1};
+	for (size_t count : {size_t(10000), size_t(100000), size_t(1000000)}) {
+		const auto s = scene(count);
+		const std::string n = std::to_string(count / 1000) + "k";
+
+		run(suite, n + "/hash", SDL::SpatialHash{64}, s);
+		run(suite, n + "/quadtree", SDL::LooseQuadtree{SDL::Rect{0, 0, s.side, s.side}, 10}, s);
+		if (brute)
+			bruteForce(suite, n + "/brute", s);
+	}
+	return 0;
+}
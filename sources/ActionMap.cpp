@@ -0,0 +1,312 @@
+/*
+** SDL++, 2020
+** ActionMap.cpp
+*/
+
+#include "SDL++/ActionMap.hpp"
+#include "SDL++/Error.hpp"
+#include "SDL++/Exception.hpp"
+
+#include <SDL2/SDL_keyboard.h>
+#include <SDL2/SDL_mouse.h>
+#include <SDL2/SDL_rwops.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <system_error>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr size_t mouseButtons = 5;
+
+	std::string_view trim(std::string_view s)
+	{
+		while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\r'))
+			s.remove_prefix(1);
+		while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r'))
+			s.remove_suffix(1);
+		return s;
+	}
+
+	[[noreturn]] void fail(const std::string &message)
+	{
+		Error::set(message.c_str());
+		SDLPP_THROW(Exception{"ActionMap::parse"});
+	}
+
+	bool modified(const std::string &filename, Sint64 &mtime)
+	{
+		std::error_code ec;
+		const auto t = std::filesystem::last_write_time(filename, ec);
+		if (ec)
+			return false;
+		const auto stamp = static_cast<Sint64>(t.time_since_epoch().count());
+		if (stamp == mtime)
+			return false;
+		mtime = stamp;
+		return true;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ActionMap::parse(std::string_view config)
+{
+	Bindings bindings;
+	std::vector<std::string> added;
+
+	const auto id = [&](std::string_view name) -> Action {
+		if (const Action a = action(name); a != invalid)
+			return a;
+		for (size_t i = 0; i < added.size(); ++i)
+			if (added[i] == name)
+				return Action(m_names.size() + i);
+		if (m_names.size() + added.size() >= invalid)
+			fail("Too many actions");
+		added.emplace_back(name);
+		return Action(m_names.size() + added.size() - 1);
+	};
+
+	size_t lineNumber = 0;
+	size_t start = 0;
+	while (start < config.size()) {
+		size_t end = config.find('\n', start);
+		if (end == std::string_view::npos)
+			end = config.size();
+		std::string_view line = config.substr(start, end - start);
+		start = end + 1;
+		++lineNumber;
+
+		if (const size_t hash = line.find('#'); hash != std::string_view::npos)
+			line = line.substr(0, hash);
+		line = trim(line);
+		if (line.empty())
+			continue;
+
+		const size_t equal = line.find('=');
+		const auto name = trim(line.substr(0, equal));
+		if (equal == std::string_view::npos || name.empty())
+			fail("line " + std::to_string(lineNumber) + ": expected <action> = <bindings>");
+
+		const Action a = id(name);
+		std::string_view rest = line.substr(equal + 1);
+		while (!rest.empty()) {
+			const size_t comma = rest.find(',');
+			const auto binding = trim(rest.substr(0, comma));
+			rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+			if (binding.empty())
+				continue;
+
+			if (const auto error = addBinding(bindings, a, binding); !error.empty())
+				fail("line " + std::to_string(lineNumber) + ": " + error);
+		}
+	}
+
+	for (auto &name : added) {
+		m_ids.emplace(name, Action(m_names.size()));
+		m_names.push_back(std::move(name));
+	}
+	m_bindings = std::move(bindings);
+	compile();
+}
+
+void ActionMap::load(const std::string &filename)
+{
+	size_t size = 0;
+	void *data = SDL_LoadFile(filename.c_str(), &size);
+	if (!data)
+		SDLPP_THROW(Exception{"SDL_LoadFile"});
+	const std::string config{static_cast<const char*>(data), size};
+	SDL_free(data);
+
+	parse(config);
+	m_file = filename;
+	m_mtime = 0;
+	modified(m_file, m_mtime);
+}
+
+bool ActionMap::reloadIfChanged()
+{
+	if (m_file.empty() || !modified(m_file, m_mtime))
+		return false;
+
+	// m_mtime is already the new stamp: a faulty file throws once, not on
+	// every call until it is edited again.
+	load(m_file);
+	return true;
+}
+
+ActionMap::Action ActionMap::bind(std::string_view action, std::string_view binding)
+{
+	Action a = this->action(action);
+	const bool added = a == invalid;
+	if (added)
+		a = Action(m_names.size());
+
+	std::string error = a == invalid ? "Too many actions" : addBinding(m_bindings, a, binding);
+	if (!error.empty()) {
+		Error::set(error.c_str());
+		SDLPP_THROW(Exception{"ActionMap::bind"});
+	}
+
+	if (added) {
+		m_ids.emplace(std::string{action}, a);
+		m_names.emplace_back(action);
+	}
+
+	compile();
+	return a;
+}
+
+ActionMap::Action ActionMap::action(std::string_view name) const
+{
+	const auto it = m_ids.find(std::string{name});
+	return it != m_ids.end() ? it->second : invalid;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ActionMap::update(const Uint8 *keys, Uint32 mouse, const ControllerState *controllers, size_t controllerCount)
+{
+	std::swap(m_down, m_previous);
+	std::fill(m_down.begin(), m_down.end(), 0);
+	std::fill(m_values.begin(), m_values.end(), 0.0f);
+
+	const auto set = [this](Action a, float value) {
+		m_down[a >> 6] |= Uint64(1) << (a & 63);
+		m_values[a] = std::max(m_values[a], value);
+	};
+	const auto setAll = [&](const Table &t, Uint16 input) {
+		for (Uint32 i = t.offsets[input], e = t.offsets[input + 1]; i < e; ++i)
+			set(t.actions[i], 1.0f);
+	};
+
+	if (keys)
+		for (Uint16 sc : m_keys.bound)
+			if (keys[sc])
+				setAll(m_keys, sc);
+
+	for (Uint16 b : m_mouse.bound)
+		if (mouse & SDL_BUTTON(b + 1))
+			setAll(m_mouse, b);
+
+	for (size_t c = 0; c < controllerCount; ++c) {
+		const ControllerState &s = controllers[c];
+		if (!s.attached || !s.gameController)
+			continue;
+
+		if (s.buttons)
+			for (Uint16 b : m_pad.bound)
+				if (s.buttons >> b & 1)
+					setAll(m_pad, b);
+
+		for (const auto &binding : m_axes) {
+			const int v = binding.negative ? -int(s.axes[binding.axis]) : int(s.axes[binding.axis]);
+			if (v >= binding.threshold)
+				set(binding.action, std::min(float(v) / 32767.0f, 1.0f));
+		}
+	}
+}
+
+void ActionMap::update(const std::vector<ControllerState> &controllers)
+{
+	const Uint32 mouse = SDL_GetMouseState(nullptr, nullptr);
+	update(SDL_GetKeyboardState(nullptr), mouse, controllers.data(), controllers.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string ActionMap::addBinding(Bindings &bindings, Action action, std::string_view binding)
+{
+	const size_t colon = binding.find(':');
+	const auto kind = trim(binding.substr(0, colon));
+	const std::string input{trim(colon == std::string_view::npos ? std::string_view{} : binding.substr(colon + 1))};
+
+	const auto unknown = [&](const char *what) {
+		return "unknown " + std::string{what} + " '" + input + "'";
+	};
+
+	if (kind == "key") {
+		const SDL_Scancode sc = SDL_GetScancodeFromName(input.c_str());
+		if (sc == SDL_SCANCODE_UNKNOWN)
+			return unknown("key");
+		bindings.keys.emplace_back(Uint16(sc), action);
+	} else if (kind == "mouse") {
+		static const char *const names[mouseButtons] = {"left", "middle", "right", "x1", "x2"};
+		const auto it = std::find(std::begin(names), std::end(names), input);
+		if (it == std::end(names))
+			return unknown("mouse button");
+		bindings.mouse.emplace_back(Uint16(it - std::begin(names)), action);
+	} else if (kind == "pad") {
+		const SDL_GameControllerButton b = SDL_GameControllerGetButtonFromString(input.c_str());
+		if (b == SDL_CONTROLLER_BUTTON_INVALID || int(b) >= ControllerState::maxButtons)
+			return unknown("controller button");
+		bindings.pad.emplace_back(Uint16(b), action);
+	} else if (kind == "axis") {
+		std::string name = input;
+		float threshold = 0.5f;
+		if (const size_t at = name.find('@'); at != std::string::npos) {
+			char *end = nullptr;
+			threshold = std::strtof(name.c_str() + at + 1, &end);
+			if (*end || !(threshold > 0.0f && threshold <= 1.0f))
+				return unknown("axis threshold of");
+			name.resize(at);
+		}
+		if (name.empty() || (name[0] != '+' && name[0] != '-'))
+			return unknown("axis direction of");
+
+		const SDL_GameControllerAxis axis = SDL_GameControllerGetAxisFromString(name.c_str() + 1);
+		if (axis == SDL_CONTROLLER_AXIS_INVALID || int(axis) >= ControllerState::maxAxes)
+			return unknown("controller axis");
+		bindings.axes.push_back(AxisBinding{Uint8(axis), name[0] == '-', Sint16(std::lround(threshold * 32767.0f)), action});
+	} else {
+		return "unknown binding '" + std::string{binding} + "', expected key:, mouse:, pad: or axis:";
+	}
+	return {};
+}
+
+void ActionMap::compile()
+{
+	m_keys = table(m_bindings.keys, SDL_NUM_SCANCODES);
+	m_mouse = table(m_bindings.mouse, mouseButtons);
+	m_pad = table(m_bindings.pad, ControllerState::maxButtons);
+	m_axes = m_bindings.axes;
+
+	const size_t words = (m_names.size() + 63) / 64;
+	m_down.resize(words);
+	m_previous.resize(words);
+	m_values.resize(m_names.size());
+}
+
+ActionMap::Table ActionMap::table(std::vector<std::pair<Uint16, Action>> pairs, size_t inputs)
+{
+	std::sort(pairs.begin(), pairs.end());
+	pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+	Table t;
+	t.offsets.assign(inputs + 1, 0);
+	t.actions.reserve(pairs.size());
+	for (const auto &[input, action] : pairs) {
+		++t.offsets[input + 1];
+		t.actions.push_back(action);
+		if (t.bound.empty() || t.bound.back() != input)
+			t.bound.push_back(input);
+	}
+	for (size_t i = 0; i < inputs; ++i)
+		t.offsets[i + 1] += t.offsets[i];
+	return t;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,286 @@
+/*
+** SDL++, 2020
+** Archive.cpp
+*/
+
+#include "SDL++/Archive.hpp"
+#include "SDL++/Hash.hpp"
+
+#include <SDL2/SDL_rwops.h>
+
+#include <algorithm>
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// Whether [offset, offset + size) lies within total bytes, without
+	// overflowing on corrupted values.
+	bool fits(Uint64 offset, Uint64 size, Uint64 total)
+	{
+		return offset <= total && size <= total - offset;
+	}
+
+	Uint64 alignUp(Uint64 value, Uint64 alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	Uint32 bucketCountFor(size_t entries)
+	{
+		// Keep the load factor under 50% so probe sequences stay short.
+		Uint32 n = 16;
+		while (n < entries * 2)
+			n <<= 1;
+		return n;
+	}
+
+	void writeAll(SDL_RWops *rw, const void *data, size_t size)
+	{
+		if (size > 0 && SDL_RWwrite(rw, data, 1, size) != size) {
+			SDL_RWclose(rw);
+			SDLPP_THROW(Exception{"SDL_RWwrite"});
+		}
+	}
+
+	void writePadding(SDL_RWops *rw, Uint64 from, Uint64 to)
+	{
+		static const Uint8 zeros[Archive::blobAlignment] = {};
+		while (from < to) {
+			const auto n = std::min<Uint64>(to - from, sizeof(zeros));
+			writeAll(rw, zeros, n);
+			from += n;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Archive::Archive(const std::string &filename)
+: m_file{filename}
+{
+	if (m_file.size() < sizeof(Header) || std::memcmp(m_file.data(), magic, sizeof(magic)) != 0) {
+		Error::set("Not an SDL++ archive");
+		SDLPP_THROW(Exception{"Archive"});
+	}
+
+	m_header = reinterpret_cast<const Header*>(m_file.data());
+	if (m_header->version != version) {
+		Error::set("Unsupported archive version");
+		SDLPP_THROW(Exception{"Archive"});
+	}
+
+	const Uint64 size = m_file.size();
+	const Header &h = *m_header;
+	bool valid = fits(h.bucketsOffset, Uint64{h.bucketCount} * sizeof(Uint32), size)
+	          && fits(h.entriesOffset, Uint64{h.entryCount} * sizeof(Entry), size)
+	          && h.namesOffset <= size
+	          && h.bucketsOffset % alignof(Uint32) == 0
+	          && h.entriesOffset % alignof(Entry) == 0
+	          && (h.bucketCount & (h.bucketCount - 1)) == 0;
+
+	if (valid) {
+		m_entries = reinterpret_cast<const Entry*>(m_file.data() + h.entriesOffset);
+		m_names = reinterpret_cast<const char*>(m_file.data() + h.namesOffset);
+		m_buckets = reinterpret_cast<const Uint32*>(m_file.data() + h.bucketsOffset);
+
+		// Checked once here so lookups and accessors need no bounds checks.
+		for (Uint32 i = 0; valid && i < h.bucketCount; ++i)
+			valid = m_buckets[i] <= h.entryCount;
+
+		for (Uint32 i = 0; valid && i < h.entryCount; ++i) {
+			const Entry &e = m_entries[i];
+			valid = fits(e.offset, e.size, size)
+			     && fits(h.namesOffset + e.nameOffset, e.nameLength, size);
+			if (valid && e.isPixels()) {
+				valid = e.width >= 0 && e.height >= 0
+				     && e.pitch >= 0 && Uint64(e.width) * SDL_BYTESPERPIXEL(e.format) <= Uint64(e.pitch)
+				     && Uint64(e.pitch) * Uint64(e.height) <= e.size;
+			}
+		}
+	}
+
+	if (!valid) {
+		Error::set("Truncated or corrupted archive");
+		SDLPP_THROW(Exception{"Archive"});
+	}
+}
+
+const Archive::Entry *Archive::find(std::string_view name) const
+{
+	if (!m_header || m_header->bucketCount == 0)
+		return nullptr;
+
+	const Uint64 hash = Hash::fnv1a(name);
+	const Uint32 mask = m_header->bucketCount - 1;
+
+	// Bounded in case every bucket is full.
+	Uint32 i = static_cast<Uint32>(hash) & mask;
+	for (Uint32 probes = 0; probes < m_header->bucketCount; ++probes, i = (i + 1) & mask) {
+		const Uint32 slot = m_buckets[i];
+		if (slot == 0)
+			return nullptr;
+
+		const Entry &e = m_entries[slot - 1];
+		if (e.hash == hash && this->name(e) == name)
+			return &e;
+	}
+	return nullptr;
+}
+
+const Archive::Entry &Archive::at(std::string_view name) const
+{
+	const Entry *e = find(name);
+	if (!e) {
+		Error::set(("No such archive entry: " + std::string{name}).c_str());
+		SDLPP_THROW(Exception{"Archive::at"});
+	}
+	return *e;
+}
+
+Surface Archive::surface(std::string_view name) const
+{
+	return surface(at(name));
+}
+
+Surface Archive::surface(const Entry &e) const
+{
+	if (e.isPixels())
+		return Surface{data(e), e.width, e.height, static_cast<int>(SDL_BITSPERPIXEL(e.format)), e.pitch, e.format};
+
+	SDL_RWops *rw = SDL_RWFromConstMem(data(e), static_cast<int>(e.size));
+	if (!rw)
+		SDLPP_THROW(Exception{"SDL_RWFromConstMem"});
+
+#ifdef SDLPP_USE_SDL_IMAGE
+	SDL_Surface *s = IMG_Load_RW(rw, 1);
+	if (!s)
+		SDLPP_THROW(Exception{"IMG_Load_RW"});
+#else
+	SDL_Surface *s = SDL_LoadBMP_RW(rw, 1);
+	if (!s)
+		SDLPP_THROW(Exception{"SDL_LoadBMP_RW"});
+#endif
+	return Surface{s};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ArchiveWriter::Pending &ArchiveWriter::add(const std::string &name)
+{
+	if (!m_names.insert(name).second) {
+		Error::set(("Duplicate archive entry: " + name).c_str());
+		SDLPP_THROW(Exception{"ArchiveWriter::add"});
+	}
+	m_pending.emplace_back();
+	m_pending.back().name = name;
+	return m_pending.back();
+}
+
+void ArchiveWriter::addData(const std::string &name, const void *data, size_t size)
+{
+	auto bytes = static_cast<const Uint8*>(data);
+	add(name).bytes.assign(bytes, bytes + size);
+}
+
+void ArchiveWriter::addFile(const std::string &name, const std::string &filename)
+{
+	size_t size = 0;
+	void *data = SDL_LoadFile(filename.c_str(), &size);
+	if (!data)
+		SDLPP_THROW(Exception{"SDL_LoadFile"});
+	addData(name, data, size);
+	SDL_free(data);
+}
+
+void ArchiveWriter::addSurface(const std::string &name, const Surface &surface)
+{
+	if (SDL_ISPIXELFORMAT_INDEXED(surface.format())) {
+		Error::set("Indexed surfaces cannot be stored pre-decoded");
+		SDLPP_THROW(Exception{"ArchiveWriter::addSurface"});
+	}
+
+	const auto lock = surface.lock();
+	const SDL_Surface *s = surface.ptr();
+	const auto pixels = static_cast<const Uint8*>(lock.rawArray());
+
+	Pending &p = add(name);
+	p.format = surface.format();
+	p.width = s->w;
+	p.height = s->h;
+	p.pitch = s->pitch;
+	p.bytes.assign(pixels, pixels + static_cast<size_t>(s->pitch) * s->h);
+}
+
+void ArchiveWriter::write(const std::string &filename) const
+{
+	Archive::Header header{};
+	std::memcpy(header.magic, Archive::magic, sizeof(header.magic));
+	header.version = Archive::version;
+	header.entryCount = static_cast<Uint32>(m_pending.size());
+	header.bucketCount = bucketCountFor(m_pending.size());
+
+	std::vector<Archive::Entry> entries(m_pending.size());
+	std::string names;
+	Uint64 offset = alignUp(sizeof(Archive::Header), Archive::blobAlignment);
+
+	for (size_t i = 0; i < m_pending.size(); ++i) {
+		const Pending &p = m_pending[i];
+		Archive::Entry &e = entries[i];
+		e.hash = Hash::fnv1a(p.name);
+		e.offset = offset;
+		e.size = p.bytes.size();
+		e.nameOffset = static_cast<Uint32>(names.size());
+		e.nameLength = static_cast<Uint32>(p.name.size());
+		e.format = p.format;
+		e.width = p.width;
+		e.height = p.height;
+		e.pitch = p.pitch;
+
+		names += p.name;
+		offset = alignUp(offset + e.size, Archive::blobAlignment);
+	}
+
+	header.entriesOffset = offset;
+	header.namesOffset = header.entriesOffset + entries.size() * sizeof(Archive::Entry);
+	header.bucketsOffset = alignUp(header.namesOffset + names.size(), alignof(Uint32));
+
+	std::vector<Uint32> buckets(header.bucketCount, 0);
+	const Uint32 mask = header.bucketCount - 1;
+	for (size_t i = 0; i < entries.size(); ++i) {
+		Uint32 b = static_cast<Uint32>(entries[i].hash) & mask;
+		while (buckets[b] != 0)
+			b = (b + 1) & mask;
+		buckets[b] = static_cast<Uint32>(i + 1);
+	}
+
+	SDL_RWops *rw = SDL_RWFromFile(filename.c_str(), "wb");
+	if (!rw)
+		SDLPP_THROW(Exception{"SDL_RWFromFile"});
+
+	writeAll(rw, &header, sizeof(header));
+	Uint64 written = sizeof(header);
+	for (size_t i = 0; i < entries.size(); ++i) {
+		writePadding(rw, written, entries[i].offset);
+		writeAll(rw, m_pending[i].bytes.data(), m_pending[i].bytes.size());
+		written = entries[i].offset + entries[i].size;
+	}
+	writePadding(rw, written, header.entriesOffset);
+	writeAll(rw, entries.data(), entries.size() * sizeof(Archive::Entry));
+	writeAll(rw, names.data(), names.size());
+	writePadding(rw, header.namesOffset + names.size(), header.bucketsOffset);
+	writeAll(rw, buckets.data(), buckets.size() * sizeof(Uint32));
+
+	if (SDL_RWclose(rw) != 0)
+		SDLPP_THROW(Exception{"SDL_RWclose"});
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,401 @@
+/*
+** SDL++, 2020
+** BitmapFont.cpp
+*/
+
+#include "SDL++/BitmapFont.hpp"
+#include "SDL++/Error.hpp"
+#include "SDL++/Exception.hpp"
+
+#include <SDL2/SDL_rwops.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr Uint32 replacement = 0xFFFD;
+
+	Uint32 nextId()
+	{
+		static std::atomic<Uint32> next{1};
+		return next.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/// Decodes the codepoint at text[i] and advances i past it; malformed
+	/// sequences give U+FFFD and skip one byte.
+	Uint32 decodeUtf8(std::string_view text, size_t &i)
+	{
+		const auto byte = [&](size_t k) { return static_cast<Uint8>(text[k]); };
+
+		const Uint8 lead = byte(i);
+		if (lead < 0x80) {
+			++i;
+			return lead;
+		}
+
+		size_t length;
+		Uint32 cp;
+		if ((lead & 0xE0) == 0xC0) {
+			length = 2;
+			cp = lead & 0x1F;
+		} else if ((lead & 0xF0) == 0xE0) {
+			length = 3;
+			cp = lead & 0x0F;
+		} else if ((lead & 0xF8) == 0xF0) {
+			length = 4;
+			cp = lead & 0x07;
+		} else {
+			++i;
+			return replacement;
+		}
+
+		if (i + length > text.size()) {
+			++i;
+			return replacement;
+		}
+		for (size_t k = 1; k < length; ++k) {
+			if ((byte(i + k) & 0xC0) != 0x80) {
+				++i;
+				return replacement;
+			}
+			cp = cp << 6 | (byte(i + k) & 0x3F);
+		}
+
+		static constexpr Uint32 smallest[5] = {0, 0, 0x80, 0x800, 0x10000};
+		if (cp < smallest[length] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+			++i;
+			return replacement;
+		}
+		i += length;
+		return cp;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// One line of a BMFont text descriptor: a tag followed by key=value
+	/// pairs, values optionally quoted.
+	class DescriptorLine
+	{
+	public:
+		explicit DescriptorLine(std::string_view line)
+		{
+			size_t i = 0;
+			const auto skipSpaces = [&] {
+				while (i < line.size() && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r'))
+					++i;
+			};
+
+			skipSpaces();
+			const size_t tagStart = i;
+			while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+				++i;
+			m_tag = line.substr(tagStart, i - tagStart);
+
+			while (true) {
+				skipSpaces();
+				if (i >= line.size())
+					break;
+
+				const size_t keyStart = i;
+				while (i < line.size() && line[i] != '=' && line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+					++i;
+				const auto key = line.substr(keyStart, i - keyStart);
+				if (i >= line.size() || line[i] != '=') {
+					m_pairs.emplace_back(key, std::string_view{});
+					continue;
+				}
+				++i;
+
+				size_t valueStart = i;
+				if (i < line.size() && line[i] == '"') {
+					valueStart = ++i;
+					while (i < line.size() && line[i] != '"')
+						++i;
+					m_pairs.emplace_back(key, line.substr(valueStart, i - valueStart));
+					if (i < line.size())
+						++i;
+				} else {
+					while (i < line.size() && line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+						++i;
+					m_pairs.emplace_back(key, line.substr(valueStart, i - valueStart));
+				}
+			}
+		}
+
+		std::string_view tag() const { return m_tag; }
+
+		std::string_view string(std::string_view key) const
+		{
+			for (const auto &[k, v] : m_pairs)
+				if (k == key)
+					return v;
+			return {};
+		}
+
+		int integer(std::string_view key, int fallback = 0) const
+		{
+			const auto v = string(key);
+			if (v.empty())
+				return fallback;
+			return std::atoi(std::string{v}.c_str());
+		}
+
+	private:
+		std::string_view m_tag;
+		std::vector<std::pair<std::string_view, std::string_view>> m_pairs;
+	};
+
+	[[noreturn]] void malformed(const char *what)
+	{
+		Error::set((std::string{"Malformed BMFont descriptor: "} + what).c_str());
+		SDLPP_THROW(Exception{"BitmapFont::fromDescriptor"});
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BitmapFont &BitmapFont::operator =(BitmapFont &&other) noexcept
+{
+	if (this != &other) {
+		m_id = other.m_id;
+		m_lineHeight = other.m_lineHeight;
+		m_base = other.m_base;
+		m_pages = std::move(other.m_pages);
+		m_pageSizes = std::move(other.m_pageSizes);
+		m_glyphs = std::move(other.m_glyphs);
+		std::memcpy(m_ascii, other.m_ascii, sizeof(m_ascii));
+		m_extended = std::move(other.m_extended);
+		m_kerning = std::move(other.m_kerning);
+
+		other.m_id = 0;
+		other.m_pages.clear();
+		other.m_pageSizes.clear();
+		other.m_glyphs.clear();
+		std::memset(other.m_ascii, 0, sizeof(other.m_ascii));
+		other.m_extended.clear();
+		other.m_kerning.clear();
+	}
+	return *this;
+}
+
+BitmapFont BitmapFont::load(const Renderer &renderer, const std::string &filename)
+{
+	size_t size = 0;
+	void *data = SDL_LoadFile(filename.c_str(), &size);
+	if (!data)
+		SDLPP_THROW(Exception{"SDL_LoadFile"});
+	const std::string descriptor{static_cast<const char*>(data), size};
+	SDL_free(data);
+
+	const size_t slash = filename.find_last_of("/\\");
+	const std::string directory = slash == std::string::npos ? std::string{} : filename.substr(0, slash + 1);
+
+	return fromDescriptor(renderer, descriptor, [&](const std::string &file) { return Surface{directory + file}; });
+}
+
+BitmapFont BitmapFont::fromDescriptor(const Renderer &renderer, std::string_view descriptor, const PageLoader &loadPage)
+{
+	if (descriptor.substr(0, 3) == "BMF" || descriptor.substr(0, 1) == "<") {
+		Error::set("Only text BMFont descriptors are supported");
+		SDLPP_THROW(Exception{"BitmapFont::fromDescriptor"});
+	}
+
+	BitmapFont font;
+	font.m_id = nextId();
+
+	std::vector<std::string> pageFiles;
+	bool common = false;
+
+	size_t start = 0;
+	while (start < descriptor.size()) {
+		size_t end = descriptor.find('\n', start);
+		if (end == std::string_view::npos)
+			end = descriptor.size();
+		const DescriptorLine line{descriptor.substr(start, end - start)};
+		start = end + 1;
+
+		if (line.tag() == "common") {
+			font.m_lineHeight = line.integer("lineHeight");
+			font.m_base = line.integer("base", font.m_lineHeight);
+			common = true;
+		} else if (line.tag() == "page") {
+			const int id = line.integer("id", -1);
+			if (id < 0 || id > 0xFFFF || line.string("file").empty())
+				malformed("bad page line");
+			if (pageFiles.size() <= size_t(id))
+				pageFiles.resize(size_t(id) + 1);
+			pageFiles[size_t(id)] = std::string{line.string("file")};
+		} else if (line.tag() == "char") {
+			const int id = line.integer("id", -1);
+			if (id < 0)
+				malformed("bad char line");
+			Glyph g;
+			g.source = Rect{line.integer("x"), line.integer("y"), line.integer("width"), line.integer("height")};
+			g.offset = Vec2i{line.integer("xoffset"), line.integer("yoffset")};
+			g.advance = line.integer("xadvance");
+			g.page = static_cast<Uint16>(line.integer("page"));
+			font.addGlyph(static_cast<Uint32>(id), g);
+		} else if (line.tag() == "kerning") {
+			const Uint64 key = Uint64(Uint32(line.integer("first"))) << 32 | Uint32(line.integer("second"));
+			font.m_kerning[key] = line.integer("amount");
+		}
+	}
+
+	if (!common)
+		malformed("no common line");
+	if (pageFiles.empty())
+		malformed("no pages");
+	for (const auto &file : pageFiles)
+		if (file.empty())
+			malformed("missing page");
+	for (const auto &g : font.m_glyphs)
+		if (g.page >= pageFiles.size())
+			malformed("glyph on a missing page");
+
+	for (const auto &file : pageFiles)
+		font.addPage(renderer, loadPage(file));
+	return font;
+}
+
+BitmapFont BitmapFont::fromGrid(const Renderer &renderer, const Surface &sheet, const Vec2i &cell, Uint32 first, Uint32 count)
+{
+	if (cell.x <= 0 || cell.y <= 0 || sheet.width() < cell.x || sheet.height() < cell.y) {
+		Error::set("Glyph cells must be positive and fit in the sheet");
+		SDLPP_THROW(Exception{"BitmapFont::fromGrid"});
+	}
+
+	const Uint32 columns = static_cast<Uint32>(sheet.width() / cell.x);
+	const Uint32 cells = columns * static_cast<Uint32>(sheet.height() / cell.y);
+	if (count == 0 || count > cells)
+		count = cells;
+
+	BitmapFont font;
+	font.m_id = nextId();
+	font.m_lineHeight = cell.y;
+	font.m_base = cell.y;
+	for (Uint32 i = 0; i < count; ++i) {
+		Glyph g;
+		g.source = Rect{static_cast<int>(i % columns) * cell.x, static_cast<int>(i / columns) * cell.y, cell.x, cell.y};
+		g.advance = cell.x;
+		font.addGlyph(first + i, g);
+	}
+	font.addPage(renderer, sheet);
+	return font;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BitmapFont::layout(std::string_view text, Layout &out) const
+{
+	out.quads.clear();
+	out.size = Vec2i{};
+	if (text.empty())
+		return;
+
+	int x = 0;
+	int y = 0;
+	Uint32 previous = 0;
+	for (size_t i = 0; i < text.size();) {
+		const Uint32 cp = decodeUtf8(text, i);
+		if (cp == '\n') {
+			out.size.x = std::max(out.size.x, x);
+			x = 0;
+			y += m_lineHeight;
+			previous = 0;
+			continue;
+		}
+
+		const Glyph *g = glyphOrFallback(cp);
+		if (!g)
+			continue;
+		x += kerning(previous, cp);
+		if (g->source.w > 0 && g->source.h > 0)
+			out.quads.push_back(Quad{g->source, Rect{x + g->offset.x, y + g->offset.y, g->source.w, g->source.h}, g->page});
+		x += g->advance;
+		previous = cp;
+	}
+	out.size.x = std::max(out.size.x, x);
+	out.size.y = y + m_lineHeight;
+}
+
+Vec2i BitmapFont::measure(std::string_view text) const
+{
+	if (text.empty())
+		return Vec2i{};
+
+	Vec2i size{};
+	int x = 0;
+	Uint32 previous = 0;
+	for (size_t i = 0; i < text.size();) {
+		const Uint32 cp = decodeUtf8(text, i);
+		if (cp == '\n') {
+			size.x = std::max(size.x, x);
+			x = 0;
+			size.y += m_lineHeight;
+			previous = 0;
+			continue;
+		}
+
+		const Glyph *g = glyphOrFallback(cp);
+		if (!g)
+			continue;
+		x += kerning(previous, cp) + g->advance;
+		previous = cp;
+	}
+	size.x = std::max(size.x, x);
+	size.y += m_lineHeight;
+	return size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void BitmapFont::addGlyph(Uint32 codepoint, const Glyph &glyph)
+{
+	const Uint32 *existing = codepoint < 128 ? &m_ascii[codepoint] : nullptr;
+	if (!existing) {
+		const auto it = m_extended.find(codepoint);
+		if (it != m_extended.end())
+			existing = &it->second;
+	}
+	if (existing && *existing) {
+		m_glyphs[*existing - 1] = glyph;
+		return;
+	}
+
+	m_glyphs.push_back(glyph);
+	const auto index = static_cast<Uint32>(m_glyphs.size());
+	if (codepoint < 128)
+		m_ascii[codepoint] = index;
+	else
+		m_extended[codepoint] = index;
+}
+
+void BitmapFont::addPage(const Renderer &renderer, const Surface &surface)
+{
+	Texture page{renderer.ptr(), surface};
+	page.setBlendMode(SDL_BLENDMODE_BLEND);
+	m_pageSizes.push_back(surface.size());
+	m_pages.push_back(std::move(page));
+}
+
+const BitmapFont::Glyph *BitmapFont::glyphOrFallback(Uint32 codepoint) const
+{
+	const Glyph *g = glyph(codepoint);
+	return g ? g : glyph('?');
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
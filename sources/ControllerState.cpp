@@ -0,0 +1,266 @@
+/*
+** SDL++, 2020
+** ControllerState.cpp
+*/
+
+#include "SDL++/ControllerState.hpp"
+
+#include <SDL2/SDL_version.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	/// v dead-zoned by the magnitude of (v, partner): partner is 0 for axes
+	/// on their own, the other stick axis for radial dead zones.
+	Sint16 deadZone(float v, float partner, float threshold, float scale)
+	{
+		const float magnitude = std::sqrt(v * v + partner * partner);
+		const float scaled = std::min(std::max(magnitude - threshold, 0.0f) * scale, 32767.0f);
+		return Sint16(magnitude > 0.0f ? v * (scaled / magnitude) : 0.0f);
+	}
+
+	/// Dead zone and rescaling of every axis, branchless over contiguous
+	/// arrays so that compilers vectorize it. Works on axis pairs, so out
+	/// may be raw; n is even.
+	void applyDeadZones(const Sint16 *raw, const float *threshold, const float *scale, const float *paired, size_t n, Sint16 *out)
+	{
+		for (size_t i = 0; i < n; i += 2) {
+			const float x = float(raw[i]);
+			const float y = float(raw[i + 1]);
+			out[i] = deadZone(x, y * paired[i], threshold[i], scale[i]);
+			out[i + 1] = deadZone(y, x * paired[i + 1], threshold[i + 1], scale[i + 1]);
+		}
+	}
+
+	class JoystickLock
+	{
+	public:
+		JoystickLock()
+		{
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+			SDL_LockJoysticks();
+#endif
+		}
+
+		~JoystickLock()
+		{
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+			SDL_UnlockJoysticks();
+#endif
+		}
+	};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ControllerPoller::ControllerPoller()
+: ControllerPoller{DeadZone{}}
+{}
+
+ControllerPoller::ControllerPoller(const DeadZone &deadZone)
+: m_deadZone{deadZone}
+{}
+
+ControllerPoller::ControllerPoller(ControllerPoller &&other) noexcept
+{
+	*this = std::move(other);
+}
+
+ControllerPoller &ControllerPoller::operator =(ControllerPoller &&other) noexcept
+{
+	if (this != &other) {
+		m_deadZone = other.m_deadZone;
+		m_devices = std::move(other.m_devices);
+		m_states = std::move(other.m_states);
+		m_frame = other.m_frame;
+		m_raw = std::move(other.m_raw);
+		m_threshold = std::move(other.m_threshold);
+		m_scale = std::move(other.m_scale);
+		m_paired = std::move(other.m_paired);
+		for (int i = 0; i < 3; ++i)
+			m_buffers[i] = std::move(other.m_buffers[i]);
+		m_back = other.m_back;
+		m_shared.store(other.m_shared.load());
+		m_front = other.m_front;
+	}
+	return *this;
+}
+
+size_t ControllerPoller::add(const GameController &controller)
+{
+	return add(controller.ptr(), SDL_GameControllerGetJoystick(controller.ptr()));
+}
+
+size_t ControllerPoller::add(const Joystick &joystick)
+{
+	return add(nullptr, joystick.ptr());
+}
+
+size_t ControllerPoller::add(SDL_GameController *controller, SDL_Joystick *joystick)
+{
+	if (!joystick)
+		SDLPP_THROW(Exception{controller ? "SDL_GameControllerGetJoystick" : "ControllerPoller::add"});
+
+	const SDL_JoystickID id = SDL_JoystickInstanceID(joystick);
+	for (size_t i = 0; i < m_devices.size(); ++i)
+		if (m_states[i].id == id)
+			return i;
+
+	ControllerState s;
+	s.id = id;
+	s.gameController = controller != nullptr;
+	if (controller) {
+		s.axisCount = SDL_CONTROLLER_AXIS_MAX;
+		s.buttonCount = std::min(int(SDL_CONTROLLER_BUTTON_MAX), ControllerState::maxButtons);
+	} else {
+		s.axisCount = Uint8(std::clamp(SDL_JoystickNumAxes(joystick), 0, ControllerState::maxAxes));
+		s.buttonCount = Uint8(std::clamp(SDL_JoystickNumButtons(joystick), 0, ControllerState::maxButtons));
+		s.hatCount = Uint8(std::clamp(SDL_JoystickNumHats(joystick), 0, ControllerState::maxHats));
+	}
+
+	m_devices.push_back(Device{controller, joystick});
+	m_states.push_back(s);
+	m_raw.resize(m_devices.size() * ControllerState::maxAxes);
+	m_threshold.resize(m_raw.size());
+	m_scale.resize(m_raw.size());
+	m_paired.resize(m_raw.size());
+	updateThresholds(m_devices.size() - 1);
+	return m_devices.size() - 1;
+}
+
+bool ControllerPoller::remove(SDL_JoystickID id)
+{
+	for (size_t i = 0; i < m_devices.size(); ++i) {
+		if (m_states[i].id != id)
+			continue;
+
+		const size_t last = m_devices.size() - 1;
+		m_devices[i] = m_devices[last];
+		m_states[i] = m_states[last];
+		m_devices.pop_back();
+		m_states.pop_back();
+		if (i != last)
+			updateThresholds(i);
+		m_raw.resize(m_devices.size() * ControllerState::maxAxes);
+		m_threshold.resize(m_raw.size());
+		m_scale.resize(m_raw.size());
+		m_paired.resize(m_raw.size());
+		return true;
+	}
+	return false;
+}
+
+void ControllerPoller::clear()
+{
+	m_devices.clear();
+	m_states.clear();
+	m_raw.clear();
+	m_threshold.clear();
+	m_scale.clear();
+	m_paired.clear();
+}
+
+void ControllerPoller::setDeadZone(const DeadZone &deadZone)
+{
+	m_deadZone = deadZone;
+	for (size_t i = 0; i < m_devices.size(); ++i)
+		updateThresholds(i);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ControllerPoller::poll()
+{
+	++m_frame;
+	{
+		JoystickLock lock;
+		for (size_t i = 0; i < m_devices.size(); ++i)
+			capture(i);
+	}
+
+	applyDeadZones(m_raw.data(), m_threshold.data(), m_scale.data(), m_paired.data(), m_raw.size(), m_raw.data());
+	for (size_t i = 0; i < m_states.size(); ++i)
+		std::copy_n(&m_raw[i * ControllerState::maxAxes], ControllerState::maxAxes, m_states[i].axes);
+
+	// Release: the reader that takes this buffer sees it whole. Acquire:
+	// the buffer coming back is no longer being read.
+	m_buffers[m_back] = m_states;
+	m_back = m_shared.exchange(m_back | fresh, std::memory_order_acq_rel) & ~fresh;
+}
+
+const std::vector<ControllerState> &ControllerPoller::latest()
+{
+	if (m_shared.load(std::memory_order_relaxed) & fresh)
+		m_front = m_shared.exchange(m_front, std::memory_order_acq_rel) & ~fresh;
+	return m_buffers[m_front];
+}
+
+const ControllerState *ControllerPoller::find(SDL_JoystickID id) const
+{
+	for (const auto &s : m_states)
+		if (s.id == id)
+			return &s;
+	return nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void ControllerPoller::updateThresholds(size_t device)
+{
+	const bool controller = m_devices[device].controller != nullptr;
+	for (int a = 0; a < ControllerState::maxAxes; ++a) {
+		// The triggers are axes 4 and 5: a pair by index, not a stick.
+		const bool trigger = controller && (a == SDL_CONTROLLER_AXIS_TRIGGERLEFT || a == SDL_CONTROLLER_AXIS_TRIGGERRIGHT);
+		const float threshold = float(std::clamp<int>(trigger ? m_deadZone.trigger : m_deadZone.stick, 0, 32766));
+		m_threshold[device * ControllerState::maxAxes + a] = threshold;
+		m_scale[device * ControllerState::maxAxes + a] = 32767.0f / (32767.0f - threshold);
+		m_paired[device * ControllerState::maxAxes + a] = m_deadZone.radial && !trigger ? 1.0f : 0.0f;
+	}
+}
+
+void ControllerPoller::capture(size_t device)
+{
+	const Device &d = m_devices[device];
+	ControllerState &s = m_states[device];
+	Sint16 *raw = &m_raw[device * ControllerState::maxAxes];
+
+	const Uint64 previous = s.buttons;
+	s.frame = m_frame;
+	s.attached = SDL_JoystickGetAttached(d.joystick) == SDL_TRUE;
+	s.buttons = 0;
+	std::fill_n(raw, ControllerState::maxAxes, Sint16(0));
+	std::fill_n(s.hats, ControllerState::maxHats, Uint8(SDL_HAT_CENTERED));
+
+	if (s.attached) {
+		if (d.controller) {
+			for (int a = 0; a < s.axisCount; ++a)
+				raw[a] = SDL_GameControllerGetAxis(d.controller, SDL_GameControllerAxis(a));
+			for (int b = 0; b < s.buttonCount; ++b)
+				s.buttons |= Uint64(SDL_GameControllerGetButton(d.controller, SDL_GameControllerButton(b)) != 0) << b;
+		} else {
+			for (int a = 0; a < s.axisCount; ++a)
+				raw[a] = SDL_JoystickGetAxis(d.joystick, a);
+			for (int b = 0; b < s.buttonCount; ++b)
+				s.buttons |= Uint64(SDL_JoystickGetButton(d.joystick, b) != 0) << b;
+			for (int h = 0; h < s.hatCount; ++h)
+				s.hats[h] = SDL_JoystickGetHat(d.joystick, h);
+		}
+	}
+
+	s.pressed = s.buttons & ~previous;
+	s.released = previous & ~s.buttons;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
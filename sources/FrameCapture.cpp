@@ -0,0 +1,138 @@
+/*
+** SDL++, 2020
+** FrameCapture.cpp
+*/
+
+#include "SDL++/FrameCapture.hpp"
+
+#include <SDL2/SDL_surface.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+FrameCapture::FrameCapture(Writer writer, size_t slots, Overflow overflow, Uint32 format)
+: m_writer{std::move(writer)}
+, m_overflow{overflow}
+, m_format{format}
+, m_slots(std::max<size_t>(slots, 1))
+{
+	for (size_t i = m_slots.size(); i > 0; --i)
+		m_free.push_back(i - 1);
+	m_worker = std::thread{[this] { workerLoop(); }};
+}
+
+FrameCapture::~FrameCapture()
+{
+	{
+		std::lock_guard lock{m_mutex};
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+	m_worker.join();
+}
+
+bool FrameCapture::capture(const Renderer &renderer)
+{
+	const auto v = renderer.viewport();
+	return capture(renderer, Rect{0, 0, v.w, v.h});
+}
+
+bool FrameCapture::capture(const Renderer &renderer, const Rect &area)
+{
+	size_t index;
+	{
+		std::unique_lock lock{m_mutex};
+		if (m_free.empty()) {
+			if (m_overflow == Overflow::Drop) {
+				++m_stats.dropped;
+				return false;
+			}
+			m_idle.wait(lock, [this] { return !m_free.empty(); });
+		}
+		index = m_free.back();
+		m_free.pop_back();
+	}
+
+	// The slot is out of both lists, so it is ours until queued.
+	Slot &slot = m_slots[index];
+	SDLPP_TRY {
+		if (!slot.surface.ptr() || slot.surface.size() != Vec2i{area.w, area.h})
+			slot.surface = Surface{area.w, area.h, static_cast<int>(SDL_BITSPERPIXEL(m_format)), m_format};
+		renderer.readPixels(area, slot.surface);
+	} SDLPP_CATCH(...) {
+		std::lock_guard lock{m_mutex};
+		m_free.push_back(index);
+		SDLPP_RETHROW;
+	}
+
+	{
+		std::lock_guard lock{m_mutex};
+		slot.index = m_next++;
+		m_queue.push_back(index);
+		++m_stats.captured;
+	}
+	m_wake.notify_one();
+	return true;
+}
+
+void FrameCapture::flush()
+{
+	std::unique_lock lock{m_mutex};
+	m_idle.wait(lock, [this] { return m_queue.empty() && m_writing == 0; });
+}
+
+FrameCapture::Stats FrameCapture::stats() const
+{
+	std::lock_guard lock{m_mutex};
+	return m_stats;
+}
+
+FrameCapture::Writer FrameCapture::bmpWriter(const std::string &prefix)
+{
+	return [prefix](const Surface &frame, Uint64 index) {
+		char number[32];
+		std::snprintf(number, sizeof number, "%06llu", static_cast<unsigned long long>(index));
+		if (SDL_SaveBMP(frame.ptr(), (prefix + number + ".bmp").c_str()) != 0)
+			SDLPP_THROW(Exception{"SDL_SaveBMP"});
+	};
+}
+
+void FrameCapture::workerLoop()
+{
+	std::unique_lock lock{m_mutex};
+	for (;;) {
+		m_wake.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+		if (m_queue.empty())
+			return;
+
+		const size_t index = m_queue.front();
+		m_queue.pop_front();
+		++m_writing;
+		lock.unlock();
+
+		bool ok = true;
+		SDLPP_TRY {
+			m_writer(m_slots[index].surface, m_slots[index].index);
+		} SDLPP_CATCH(...) {
+			ok = false;
+		}
+
+		lock.lock();
+		--m_writing;
+		++(ok ? m_stats.written : m_stats.writeErrors);
+		m_free.push_back(index);
+		m_idle.notify_all();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
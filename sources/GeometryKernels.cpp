@@ -0,0 +1,849 @@
+/*
+** SDL++, 2020
+** GeometryKernels.cpp
+*/
+
+#include "SDL++/GeometryKernels.hpp"
+#include "SDL++/PixelKernels.hpp"
+#include "Simd.hpp"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL::Kernels
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// The SIMD loops process whole vectors and hand the remainder to the
+	// scalar versions. Lengths are computed as sqrt(x * x + y * y) and
+	// normalization divides by that length, so every path rounds the same way.
+
+	////////////////////////////////////////////////////////////////////////////
+	// Scalar
+
+	template<typename T>
+	void translateScalar(T *x, T *y, size_t n, T dx, T dy)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			x[i] += dx;
+			y[i] += dy;
+		}
+	}
+
+	void scaleScalar(float *x, float *y, size_t n, float sx, float sy)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			x[i] *= sx;
+			y[i] *= sy;
+		}
+	}
+
+	void normalizeScalar(float *x, float *y, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			const float length = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+			if (length > 0.0f) {
+				x[i] /= length;
+				y[i] /= length;
+			}
+		}
+	}
+
+	void lengthsScalar(const float *x, const float *y, float *lengths, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			lengths[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+	}
+
+	template<typename T>
+	void clampScalar(T *x, T *y, size_t n, T minX, T minY, T maxX, T maxY)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			x[i] = std::min(std::max(x[i], minX), maxX);
+			y[i] = std::min(std::max(y[i], minY), maxY);
+		}
+	}
+
+	template<typename T>
+	void boundsScalar(const T *x, const T *y, size_t n, T &minX, T &minY, T &maxX, T &maxY)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			minX = std::min(minX, x[i]);
+			minY = std::min(minY, y[i]);
+			maxX = std::max(maxX, x[i]);
+			maxY = std::max(maxY, y[i]);
+		}
+	}
+
+	void rectBoundsScalar(const int *x, const int *y, const int *w, const int *h, size_t n, int &x1, int &y1, int &x2, int &y2)
+	{
+		for (size_t i = 0; i < n; ++i) {
+			x1 = std::min(x1, x[i]);
+			y1 = std::min(y1, y[i]);
+			x2 = std::max(x2, x[i] + w[i]);
+			y2 = std::max(y2, y[i] + h[i]);
+		}
+	}
+
+	size_t containingScalar(const int *x, const int *y, const int *w, const int *h, size_t n, int px, int py, Uint8 *mask)
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < n; ++i) {
+			const bool inside = px >= x[i] && px < x[i] + w[i] && py >= y[i] && py < y[i] + h[i];
+			mask[i] = inside;
+			count += inside;
+		}
+		return count;
+	}
+
+	size_t intersectingScalar(const int *x, const int *y, const int *w, const int *h, size_t n, int x1, int y1, int x2, int y2, Uint8 *mask)
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < n; ++i) {
+			const bool overlap = x[i] < x2 && x[i] + w[i] > x1 && y[i] < y2 && y[i] + h[i] > y1;
+			mask[i] = overlap;
+			count += overlap;
+		}
+		return count;
+	}
+
+	size_t intersectingRectsScalar(const SDL_Rect *rects, size_t n, int x1, int y1, int x2, int y2, Uint8 *mask)
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < n; ++i) {
+			const SDL_Rect &r = rects[i];
+			const bool overlap = r.x < x2 && r.x + r.w > x1 && r.y < y2 && r.y + r.h > y1;
+			mask[i] = overlap;
+			count += overlap;
+		}
+		return count;
+	}
+
+	size_t insideScalar(const SDL_Point *points, size_t n, int x1, int y1, int x2, int y2, Uint8 *mask)
+	{
+		size_t count = 0;
+		for (size_t i = 0; i < n; ++i) {
+			const bool inside = points[i].x >= x1 && points[i].x < x2 && points[i].y >= y1 && points[i].y < y2;
+			mask[i] = inside;
+			count += inside;
+		}
+		return count;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// x86
+
+#if defined(SDLPP_KERNELS_X86)
+
+	SDLPP_TARGET("sse2") void translateSSE2(float *x, float *y, size_t n, float dx, float dy)
+	{
+		const __m128 vx = _mm_set1_ps(dx);
+		const __m128 vy = _mm_set1_ps(dy);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), vx));
+			_mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), vy));
+		}
+		translateScalar(x + i, y + i, n - i, dx, dy);
+	}
+
+	SDLPP_TARGET("sse2") void translateIntSSE2(int *x, int *y, size_t n, int dx, int dy)
+	{
+		const __m128i vx = _mm_set1_epi32(dx);
+		const __m128i vy = _mm_set1_epi32(dy);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			auto px = reinterpret_cast<__m128i*>(x + i);
+			auto py = reinterpret_cast<__m128i*>(y + i);
+			_mm_storeu_si128(px, _mm_add_epi32(_mm_loadu_si128(px), vx));
+			_mm_storeu_si128(py, _mm_add_epi32(_mm_loadu_si128(py), vy));
+		}
+		translateScalar(x + i, y + i, n - i, dx, dy);
+	}
+
+	SDLPP_TARGET("sse2") void scaleSSE2(float *x, float *y, size_t n, float sx, float sy)
+	{
+		const __m128 vx = _mm_set1_ps(sx);
+		const __m128 vy = _mm_set1_ps(sy);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(x + i, _mm_mul_ps(_mm_loadu_ps(x + i), vx));
+			_mm_storeu_ps(y + i, _mm_mul_ps(_mm_loadu_ps(y + i), vy));
+		}
+		scaleScalar(x + i, y + i, n - i, sx, sy);
+	}
+
+	SDLPP_TARGET("sse2") void normalizeSSE2(float *x, float *y, size_t n)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 vx = _mm_loadu_ps(x + i);
+			const __m128 vy = _mm_loadu_ps(y + i);
+			const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+			const __m128 keep = _mm_cmpgt_ps(length, zero);
+			_mm_storeu_ps(x + i, _mm_or_ps(_mm_and_ps(keep, _mm_div_ps(vx, length)), _mm_andnot_ps(keep, vx)));
+			_mm_storeu_ps(y + i, _mm_or_ps(_mm_and_ps(keep, _mm_div_ps(vy, length)), _mm_andnot_ps(keep, vy)));
+		}
+		normalizeScalar(x + i, y + i, n - i);
+	}
+
+	SDLPP_TARGET("sse2") void lengthsSSE2(const float *x, const float *y, float *lengths, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 vx = _mm_loadu_ps(x + i);
+			const __m128 vy = _mm_loadu_ps(y + i);
+			_mm_storeu_ps(lengths + i, _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy))));
+		}
+		lengthsScalar(x + i, y + i, lengths + i, n - i);
+	}
+
+	SDLPP_TARGET("sse2") void clampSSE2(float *x, float *y, size_t n, float minX, float minY, float maxX, float maxY)
+	{
+		const __m128 lx = _mm_set1_ps(minX), ly = _mm_set1_ps(minY);
+		const __m128 hx = _mm_set1_ps(maxX), hy = _mm_set1_ps(maxY);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(x + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(x + i), lx), hx));
+			_mm_storeu_ps(y + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(y + i), ly), hy));
+		}
+		clampScalar(x + i, y + i, n - i, minX, minY, maxX, maxY);
+	}
+
+	SDLPP_TARGET("sse2") float horizontalSSE2(__m128 v, bool max)
+	{
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, v);
+		return max ? *std::max_element(lanes, lanes + 4) : *std::min_element(lanes, lanes + 4);
+	}
+
+	SDLPP_TARGET("sse2") void boundsSSE2(const float *x, const float *y, size_t n, float &minX, float &minY, float &maxX, float &maxY)
+	{
+		__m128 lx = _mm_set1_ps(minX), ly = _mm_set1_ps(minY);
+		__m128 hx = _mm_set1_ps(maxX), hy = _mm_set1_ps(maxY);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128 vx = _mm_loadu_ps(x + i);
+			const __m128 vy = _mm_loadu_ps(y + i);
+			lx = _mm_min_ps(lx, vx);
+			ly = _mm_min_ps(ly, vy);
+			hx = _mm_max_ps(hx, vx);
+			hy = _mm_max_ps(hy, vy);
+		}
+		minX = horizontalSSE2(lx, false);
+		minY = horizontalSSE2(ly, false);
+		maxX = horizontalSSE2(hx, true);
+		maxY = horizontalSSE2(hy, true);
+		boundsScalar(x + i, y + i, n - i, minX, minY, maxX, maxY);
+	}
+
+	SDLPP_TARGET("sse2") inline __m128i loadSSE2(const int *p)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+	}
+
+	/// Stores 16 lane masks (all ones or zero) as 0/1 bytes, returns the
+	/// number of ones.
+	SDLPP_TARGET("sse2") size_t storeMaskSSE2(__m128i a, __m128i b, __m128i c, __m128i d, Uint8 *mask)
+	{
+		const __m128i bytes = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(mask), _mm_and_si128(bytes, _mm_set1_epi8(1)));
+		return std::bitset<16>(static_cast<unsigned>(_mm_movemask_epi8(bytes))).count();
+	}
+
+	SDLPP_TARGET("sse2") inline __m128i containsSSE2(const int *x, const int *y, const int *w, const int *h, __m128i px, __m128i py)
+	{
+		const __m128i rx = loadSSE2(x);
+		const __m128i ry = loadSSE2(y);
+		const __m128i inX = _mm_andnot_si128(_mm_cmpgt_epi32(rx, px), _mm_cmpgt_epi32(_mm_add_epi32(rx, loadSSE2(w)), px));
+		const __m128i inY = _mm_andnot_si128(_mm_cmpgt_epi32(ry, py), _mm_cmpgt_epi32(_mm_add_epi32(ry, loadSSE2(h)), py));
+		return _mm_and_si128(inX, inY);
+	}
+
+	SDLPP_TARGET("sse2") size_t containingSSE2(const int *x, const int *y, const int *w, const int *h, size_t n, int px, int py, Uint8 *mask)
+	{
+		const __m128i vx = _mm_set1_epi32(px);
+		const __m128i vy = _mm_set1_epi32(py);
+		size_t i = 0, count = 0;
+		for (; i + 16 <= n; i += 16) {
+			count += storeMaskSSE2(
+				containsSSE2(x + i, y + i, w + i, h + i, vx, vy),
+				containsSSE2(x + i + 4, y + i + 4, w + i + 4, h + i + 4, vx, vy),
+				containsSSE2(x + i + 8, y + i + 8, w + i + 8, h + i + 8, vx, vy),
+				containsSSE2(x + i + 12, y + i + 12, w + i + 12, h + i + 12, vx, vy),
+				mask + i);
+		}
+		return count + containingScalar(x + i, y + i, w + i, h + i, n - i, px, py, mask + i);
+	}
+
+	SDLPP_TARGET("sse2") inline __m128i overlapSSE2(__m128i rx, __m128i ry, __m128i rw, __m128i rh, __m128i x1, __m128i y1, __m128i x2, __m128i y2)
+	{
+		const __m128i inX = _mm_and_si128(_mm_cmpgt_epi32(x2, rx), _mm_cmpgt_epi32(_mm_add_epi32(rx, rw), x1));
+		const __m128i inY = _mm_and_si128(_mm_cmpgt_epi32(y2, ry), _mm_cmpgt_epi32(_mm_add_epi32(ry, rh), y1));
+		return _mm_and_si128(inX, inY);
+	}
+
+	SDLPP_TARGET("sse2") inline __m128i intersectsSSE2(const int *x, const int *y, const int *w, const int *h, __m128i x1, __m128i y1, __m128i x2, __m128i y2)
+	{
+		return overlapSSE2(loadSSE2(x), loadSSE2(y), loadSSE2(w), loadSSE2(h), x1, y1, x2, y2);
+	}
+
+	SDLPP_TARGET("sse2") size_t intersectingSSE2(const int *x, const int *y, const int *w, const int *h, size_t n, int x1, int y1, int x2, int y2, Uint8 *mask)
+	{
+		const __m128i vx1 = _mm_set1_epi32(x1), vy1 = _mm_set1_epi32(y1);
+		const __m128i vx2 = _mm_set1_epi32(x2), vy2 = _mm_set1_epi32(y2);
+		size_t i = 0, count = 0;
+		for (; i + 16 <= n; i += 16) {
+			count += storeMaskSSE2(
+				intersectsSSE2(x + i, y + i, w + i, h + i, vx1, vy1, vx2, vy2),
+				intersectsSSE2(x + i + 4, y + i + 4, w + i + 4, h + i + 4, vx1, vy1, vx2, vy2),
+				intersectsSSE2(x + i + 8, y + i + 8, w + i + 8, h + i + 8, vx1, vy1, vx2, vy2),
+				intersectsSSE2(x + i + 12, y + i + 12, w + i + 12, h + i + 12, vx1, vy1, vx2, vy2),
+				mask + i);
+		}
+		return count + intersectingScalar(x + i, y + i, w + i, h + i, n - i, x1, y1, x2, y2, mask + i);
+	}
+
+	/// Four SDL_Rect transposed into x, y, w and h vectors.
+	SDLPP_TARGET("sse2") inline __m128i intersectsAoSSSE2(const SDL_Rect *r, __m128i x1, __m128i y1, __m128i x2, __m128i y2)
+	{
+		const __m128i r0 = loadSSE2(&r[0].x), r1 = loadSSE2(&r[1].x);
+		const __m128i r2 = loadSSE2(&r[2].x), r3 = loadSSE2(&r[3].x);
+		const __m128i xy01 = _mm_unpacklo_epi32(r0, r1), xy23 = _mm_unpacklo_epi32(r2, r3);
+		const __m128i wh01 = _mm_unpackhi_epi32(r0, r1), wh23 = _mm_unpackhi_epi32(r2, r3);
+		return overlapSSE2(
+			_mm_unpacklo_epi64(xy01, xy23), _mm_unpackhi_epi64(xy01, xy23),
+			_mm_unpacklo_epi64(wh01, wh23), _mm_unpackhi_epi64(wh01, wh23),
+			x1, y1, x2, y2);
+	}
+
+	SDLPP_TARGET("sse2") size_t intersectingRectsSSE2(const SDL_Rect *rects, size_t n, int x1, int y1, int x2, int y2, Uint8 *mask)
+	{
+		const __m128i vx1 = _mm_set1_epi32(x1), vy1 = _mm_set1_epi32(y1);
+		const __m128i vx2 = _mm_set1_epi32(x2), vy2 = _mm_set1_epi32(y2);
+		size_t i = 0, count = 0;
+		for (; i + 16 <= n; i += 16) {
+			count += storeMaskSSE2(
+				intersectsAoSSSE2(rects + i, vx1, vy1, vx2, vy2),
+				intersectsAoSSSE2(rects + i + 4, vx1, vy1, vx2, vy2),
+				intersectsAoSSSE2(rects + i + 8, vx1, vy1, vx2, vy2),
+				intersectsAoSSSE2(rects + i + 12, vx1, vy1, vx2, vy2),
+				mask + i);
+		}
+		return count + intersectingRectsScalar(rects + i, n - i, x1, y1, x2, y2, mask + i);
+	}
+
+	/// Four SDL_Point split into x and y vectors.
+	SDLPP_TARGET("sse2") inline __m128i insideAoSSSE2(const SDL_Point *p, __m128i x1, __m128i y1, __m128i x2, __m128i y2)
+	{
+		const __m128 p01 = _mm_castsi128_ps(loadSSE2(&p[0].x));
+		const __m128 p23 = _mm_castsi128_ps(loadSSE2(&p[2].x));
+		const __m128i px = _mm_castps_si128(_mm_shuffle_ps(p01, p23, _MM_SHUFFLE(2, 0, 2, 0)));
+		const __m128i py = _mm_castps_si128(_mm_shuffle_ps(p01, p23, _MM_SHUFFLE(3, 1, 3, 1)));
+		const __m128i inX = _mm_andnot_si128(_mm_cmpgt_epi32(x1, px), _mm_cmpgt_epi32(x2, px));
+		const __m128i inY = _mm_andnot_si128(_mm_cmpgt_epi32(y1, py), _mm_cmpgt_epi32(y2, py));
+		return _mm_and_si128(inX, inY);
+	}
+
+	SDLPP_TARGET("sse2") size_t insideSSE2(const SDL_Point *points, size_t n, int x1, int y1, int x2, int y2, Uint8 *mask)
+	{
+		const __m128i vx1 = _mm_set1_epi32(x1), vy1 = _mm_set1_epi32(y1);
+		const __m128i vx2 = _mm_set1_epi32(x2), vy2 = _mm_set1_epi32(y2);
+		size_t i = 0, count = 0;
+		for (; i + 16 <= n; i += 16) {
+			count += storeMaskSSE2(
+				insideAoSSSE2(points + i, vx1, vy1, vx2, vy2),
+				insideAoSSSE2(points + i + 4, vx1, vy1, vx2, vy2),
+				insideAoSSSE2(points + i + 8, vx1, vy1, vx2, vy2),
+				insideAoSSSE2(points + i + 12, vx1, vy1, vx2, vy2),
+				mask + i);
+		}
+		return count + insideScalar(points + i, n - i, x1, y1, x2, y2, mask + i);
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	SDLPP_TARGET("sse4.1") int horizontalSSE41(__m128i v, bool max)
+	{
+		alignas(16) int lanes[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes), v);
+		return max ? *std::max_element(lanes, lanes + 4) : *std::min_element(lanes, lanes + 4);
+	}
+
+	SDLPP_TARGET("sse4.1") void clampIntSSE41(int *x, int *y, size_t n, int minX, int minY, int maxX, int maxY)
+	{
+		const __m128i lx = _mm_set1_epi32(minX), ly = _mm_set1_epi32(minY);
+		const __m128i hx = _mm_set1_epi32(maxX), hy = _mm_set1_epi32(maxY);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			auto px = reinterpret_cast<__m128i*>(x + i);
+			auto py = reinterpret_cast<__m128i*>(y + i);
+			_mm_storeu_si128(px, _mm_min_epi32(_mm_max_epi32(_mm_loadu_si128(px), lx), hx));
+			_mm_storeu_si128(py, _mm_min_epi32(_mm_max_epi32(_mm_loadu_si128(py), ly), hy));
+		}
+		clampScalar(x + i, y + i, n - i, minX, minY, maxX, maxY);
+	}
+
+	SDLPP_TARGET("sse4.1") void boundsIntSSE41(const int *x, const int *y, size_t n, int &minX, int &minY, int &maxX, int &maxY)
+	{
+		__m128i lx = _mm_set1_epi32(minX), ly = _mm_set1_epi32(minY);
+		__m128i hx = _mm_set1_epi32(maxX), hy = _mm_set1_epi32(maxY);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128i vx = loadSSE2(x + i);
+			const __m128i vy = loadSSE2(y + i);
+			lx = _mm_min_epi32(lx, vx);
+			ly = _mm_min_epi32(ly, vy);
+			hx = _mm_max_epi32(hx, vx);
+			hy = _mm_max_epi32(hy, vy);
+		}
+		minX = horizontalSSE41(lx, false);
+		minY = horizontalSSE41(ly, false);
+		maxX = horizontalSSE41(hx, true);
+		maxY = horizontalSSE41(hy, true);
+		boundsScalar(x + i, y + i, n - i, minX, minY, maxX, maxY);
+	}
+
+	SDLPP_TARGET("sse4.1") void rectBoundsSSE41(const int *x, const int *y, const int *w, const int *h, size_t n, int &x1, int &y1, int &x2, int &y2)
+	{
+		__m128i lx = _mm_set1_epi32(x1), ly = _mm_set1_epi32(y1);
+		__m128i hx = _mm_set1_epi32(x2), hy = _mm_set1_epi32(y2);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128i vx = loadSSE2(x + i);
+			const __m128i vy = loadSSE2(y + i);
+			lx = _mm_min_epi32(lx, vx);
+			ly = _mm_min_epi32(ly, vy);
+			hx = _mm_max_epi32(hx, _mm_add_epi32(vx, loadSSE2(w + i)));
+			hy = _mm_max_epi32(hy, _mm_add_epi32(vy, loadSSE2(h + i)));
+		}
+		x1 = horizontalSSE41(lx, false);
+		y1 = horizontalSSE41(ly, false);
+		x2 = horizontalSSE41(hx, true);
+		y2 = horizontalSSE41(hy, true);
+		rectBoundsScalar(x + i, y + i, w + i, h + i, n - i, x1, y1, x2, y2);
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	SDLPP_TARGET("avx2") void translateAVX2(float *x, float *y, size_t n, float dx, float dy)
+	{
+		const __m256 vx = _mm256_set1_ps(dx);
+		const __m256 vy = _mm256_set1_ps(dy);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), vx));
+			_mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), vy));
+		}
+		translateScalar(x + i, y + i, n - i, dx, dy);
+	}
+
+	SDLPP_TARGET("avx2") void translateIntAVX2(int *x, int *y, size_t n, int dx, int dy)
+	{
+		const __m256i vx = _mm256_set1_epi32(dx);
+		const __m256i vy = _mm256_set1_epi32(dy);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			auto px = reinterpret_cast<__m256i*>(x + i);
+			auto py = reinterpret_cast<__m256i*>(y + i);
+			_mm256_storeu_si256(px, _mm256_add_epi32(_mm256_loadu_si256(px), vx));
+			_mm256_storeu_si256(py, _mm256_add_epi32(_mm256_loadu_si256(py), vy));
+		}
+		translateScalar(x + i, y + i, n - i, dx, dy);
+	}
+
+	SDLPP_TARGET("avx2") void scaleAVX2(float *x, float *y, size_t n, float sx, float sy)
+	{
+		const __m256 vx = _mm256_set1_ps(sx);
+		const __m256 vy = _mm256_set1_ps(sy);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(x + i, _mm256_mul_ps(_mm256_loadu_ps(x + i), vx));
+			_mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_loadu_ps(y + i), vy));
+		}
+		scaleScalar(x + i, y + i, n - i, sx, sy);
+	}
+
+	SDLPP_TARGET("avx2") void normalizeAVX2(float *x, float *y, size_t n)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 vx = _mm256_loadu_ps(x + i);
+			const __m256 vy = _mm256_loadu_ps(y + i);
+			const __m256 length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)));
+			const __m256 keep = _mm256_cmp_ps(length, zero, _CMP_GT_OQ);
+			_mm256_storeu_ps(x + i, _mm256_blendv_ps(vx, _mm256_div_ps(vx, length), keep));
+			_mm256_storeu_ps(y + i, _mm256_blendv_ps(vy, _mm256_div_ps(vy, length), keep));
+		}
+		normalizeScalar(x + i, y + i, n - i);
+	}
+
+	SDLPP_TARGET("avx2") void lengthsAVX2(const float *x, const float *y, float *lengths, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 vx = _mm256_loadu_ps(x + i);
+			const __m256 vy = _mm256_loadu_ps(y + i);
+			_mm256_storeu_ps(lengths + i, _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy))));
+		}
+		lengthsScalar(x + i, y + i, lengths + i, n - i);
+	}
+
+	SDLPP_TARGET("avx2") void clampAVX2(float *x, float *y, size_t n, float minX, float minY, float maxX, float maxY)
+	{
+		const __m256 lx = _mm256_set1_ps(minX), ly = _mm256_set1_ps(minY);
+		const __m256 hx = _mm256_set1_ps(maxX), hy = _mm256_set1_ps(maxY);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(x + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(x + i), lx), hx));
+			_mm256_storeu_ps(y + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(y + i), ly), hy));
+		}
+		clampScalar(x + i, y + i, n - i, minX, minY, maxX, maxY);
+	}
+
+	SDLPP_TARGET("avx2") void clampIntAVX2(int *x, int *y, size_t n, int minX, int minY, int maxX, int maxY)
+	{
+		const __m256i lx = _mm256_set1_epi32(minX), ly = _mm256_set1_epi32(minY);
+		const __m256i hx = _mm256_set1_epi32(maxX), hy = _mm256_set1_epi32(maxY);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			auto px = reinterpret_cast<__m256i*>(x + i);
+			auto py = reinterpret_cast<__m256i*>(y + i);
+			_mm256_storeu_si256(px, _mm256_min_epi32(_mm256_max_epi32(_mm256_loadu_si256(px), lx), hx));
+			_mm256_storeu_si256(py, _mm256_min_epi32(_mm256_max_epi32(_mm256_loadu_si256(py), ly), hy));
+		}
+		clampScalar(x + i, y + i, n - i, minX, minY, maxX, maxY);
+	}
+
+	SDLPP_TARGET("avx2") void boundsAVX2(const float *x, const float *y, size_t n, float &minX, float &minY, float &maxX, float &maxY)
+	{
+		__m256 lx = _mm256_set1_ps(minX), ly = _mm256_set1_ps(minY);
+		__m256 hx = _mm256_set1_ps(maxX), hy = _mm256_set1_ps(maxY);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256 vx = _mm256_loadu_ps(x + i);
+			const __m256 vy = _mm256_loadu_ps(y + i);
+			lx = _mm256_min_ps(lx, vx);
+			ly = _mm256_min_ps(ly, vy);
+			hx = _mm256_max_ps(hx, vx);
+			hy = _mm256_max_ps(hy, vy);
+		}
+		minX = horizontalSSE2(_mm_min_ps(_mm256_castps256_ps128(lx), _mm256_extractf128_ps(lx, 1)), false);
+		minY = horizontalSSE2(_mm_min_ps(_mm256_castps256_ps128(ly), _mm256_extractf128_ps(ly, 1)), false);
+		maxX = horizontalSSE2(_mm_max_ps(_mm256_castps256_ps128(hx), _mm256_extractf128_ps(hx, 1)), true);
+		maxY = horizontalSSE2(_mm_max_ps(_mm256_castps256_ps128(hy), _mm256_extractf128_ps(hy, 1)), true);
+		boundsScalar(x + i, y + i, n - i, minX, minY, maxX, maxY);
+	}
+
+	SDLPP_TARGET("avx2") inline __m256i loadAVX2(const int *p)
+	{
+		return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+	}
+
+	SDLPP_TARGET("avx2") __m128i lowMinAVX2(__m256i v)
+	{
+		return _mm_min_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	}
+
+	SDLPP_TARGET("avx2") __m128i lowMaxAVX2(__m256i v)
+	{
+		return _mm_max_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+	}
+
+	SDLPP_TARGET("avx2") void boundsIntAVX2(const int *x, const int *y, size_t n, int &minX, int &minY, int &maxX, int &maxY)
+	{
+		__m256i lx = _mm256_set1_epi32(minX), ly = _mm256_set1_epi32(minY);
+		__m256i hx = _mm256_set1_epi32(maxX), hy = _mm256_set1_epi32(maxY);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i vx = loadAVX2(x + i);
+			const __m256i vy = loadAVX2(y + i);
+			lx = _mm256_min_epi32(lx, vx);
+			ly = _mm256_min_epi32(ly, vy);
+			hx = _mm256_max_epi32(hx, vx);
+			hy = _mm256_max_epi32(hy, vy);
+		}
+		minX = horizontalSSE41(lowMinAVX2(lx), false);
+		minY = horizontalSSE41(lowMinAVX2(ly), false);
+		maxX = horizontalSSE41(lowMaxAVX2(hx), true);
+		maxY = horizontalSSE41(lowMaxAVX2(hy), true);
+		boundsScalar(x + i, y + i, n - i, minX, minY, maxX, maxY);
+	}
+
+	SDLPP_TARGET("avx2") void rectBoundsAVX2(const int *x, const int *y, const int *w, const int *h, size_t n, int &x1, int &y1, int &x2, int &y2)
+	{
+		__m256i lx = _mm256_set1_epi32(x1), ly = _mm256_set1_epi32(y1);
+		__m256i hx = _mm256_set1_epi32(x2), hy = _mm256_set1_epi32(y2);
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i vx = loadAVX2(x + i);
+			const __m256i vy = loadAVX2(y + i);
+			lx = _mm256_min_epi32(lx, vx);
+			ly = _mm256_min_epi32(ly, vy);
+			hx = _mm256_max_epi32(hx, _mm256_add_epi32(vx, loadAVX2(w + i)));
+			hy = _mm256_max_epi32(hy, _mm256_add_epi32(vy, loadAVX2(h + i)));
+		}
+		x1 = horizontalSSE41(lowMinAVX2(lx), false);
+		y1 = horizontalSSE41(lowMinAVX2(ly), false);
+		x2 = horizontalSSE41(lowMaxAVX2(hx), true);
+		y2 = horizontalSSE41(lowMaxAVX2(hy), true);
+		rectBoundsScalar(x + i, y + i, w + i, h + i, n - i, x1, y1, x2, y2);
+	}
+
+	/// storeMaskSSE2() for 32 lanes. The packs work within 128-bit halves, so
+	/// the 4-byte groups come out as a0 b0 c0 d0 a1 b1 c1 d1 and are put back
+	/// in order with a single permute.
+	SDLPP_TARGET("avx2") size_t storeMaskAVX2(__m256i a, __m256i b, __m256i c, __m256i d, Uint8 *mask)
+	{
+		const __m256i packed = _mm256_packs_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+		const __m256i bytes = _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(mask), _mm256_and_si256(bytes, _mm256_set1_epi8(1)));
+		return std::bitset<32>(static_cast<unsigned>(_mm256_movemask_epi8(bytes))).count();
+	}
+
+	SDLPP_TARGET("avx2") inline __m256i containsAVX2(const int *x, const int *y, const int *w, const int *h, __m256i px, __m256i py)
+	{
+		const __m256i rx = loadAVX2(x);
+		const __m256i ry = loadAVX2(y);
+		const __m256i inX = _mm256_andnot_si256(_mm256_cmpgt_epi32(rx, px), _mm256_cmpgt_epi32(_mm256_add_epi32(rx, loadAVX2(w)), px));
+		const __m256i inY = _mm256_andnot_si256(_mm256_cmpgt_epi32(ry, py), _mm256_cmpgt_epi32(_mm256_add_epi32(ry, loadAVX2(h)), py));
+		return _mm256_and_si256(inX, inY);
+	}
+
+	SDLPP_TARGET("avx2") size_t containingAVX2(const int *x, const int *y, const int *w, const int *h, size_t n, int px, int py, Uint8 *mask)
+	{
+		const __m256i vx = _mm256_set1_epi32(px);
+		const __m256i vy = _mm256_set1_epi32(py);
+		size_t i = 0, count = 0;
+		for (; i + 32 <= n; i += 32) {
+			count += storeMaskAVX2(
+				containsAVX2(x + i, y + i, w + i, h + i, vx, vy),
+				containsAVX2(x + i + 8, y + i + 8, w + i + 8, h + i + 8, vx, vy),
+				containsAVX2(x + i + 16, y + i + 16, w + i + 16, h + i + 16, vx, vy),
+				containsAVX2(x + i + 24, y + i + 24, w + i + 24, h + i + 24, vx, vy),
+				mask + i);
+		}
+		return count + containingScalar(x + i, y + i, w + i, h + i, n - i, px, py, mask + i);
+	}
+
+	SDLPP_TARGET("avx2") inline __m256i intersectsAVX2(const int *x, const int *y, const int *w, const int *h, __m256i x1, __m256i y1, __m256i x2, __m256i y2)
+	{
+		const __m256i rx = loadAVX2(x);
+		const __m256i ry = loadAVX2(y);
+		const __m256i inX = _mm256_and_si256(_mm256_cmpgt_epi32(x2, rx), _mm256_cmpgt_epi32(_mm256_add_epi32(rx, loadAVX2(w)), x1));
+		const __m256i inY = _mm256_and_si256(_mm256_cmpgt_epi32(y2, ry), _mm256_cmpgt_epi32(_mm256_add_epi32(ry, loadAVX2(h)), y1));
+		return _mm256_and_si256(inX, inY);
+	}
+
+	SDLPP_TARGET("avx2") size_t intersectingAVX2(const int *x, const int *y, const int *w, const int *h, size_t n, int x1, int y1, int x2, int y2, Uint8 *mask)
+	{
+		const __m256i vx1 = _mm256_set1_epi32(x1), vy1 = _mm256_set1_epi32(y1);
+		const __m256i vx2 = _mm256_set1_epi32(x2), vy2 = _mm256_set1_epi32(y2);
+		size_t i = 0, count = 0;
+		for (; i + 32 <= n; i += 32) {
+			count += storeMaskAVX2(
+				intersectsAVX2(x + i, y + i, w + i, h + i, vx1, vy1, vx2, vy2),
+				intersectsAVX2(x + i + 8, y + i + 8, w + i + 8, h + i + 8, vx1, vy1, vx2, vy2),
+				intersectsAVX2(x + i + 16, y + i + 16, w + i + 16, h + i + 16, vx1, vy1, vx2, vy2),
+				intersectsAVX2(x + i + 24, y + i + 24, w + i + 24, h + i + 24, vx1, vy1, vx2, vy2),
+				mask + i);
+		}
+		return count + intersectingScalar(x + i, y + i, w + i, h + i, n - i, x1, y1, x2, y2, mask + i);
+	}
+
+#endif
+
+	////////////////////////////////////////////////////////////////////////////
+	// Dispatch
+
+	struct Table
+	{
+		void (*translate)(float*, float*, size_t, float, float);
+		void (*translateInt)(int*, int*, size_t, int, int);
+		void (*scale)(float*, float*, size_t, float, float);
+		void (*normalize)(float*, float*, size_t);
+		void (*lengths)(const float*, const float*, float*, size_t);
+		void (*clamp)(float*, float*, size_t, float, float, float, float);
+		void (*clampInt)(int*, int*, size_t, int, int, int, int);
+		void (*bounds)(const float*, const float*, size_t, float&, float&, float&, float&);
+		void (*boundsInt)(const int*, const int*, size_t, int&, int&, int&, int&);
+		void (*rectBounds)(const int*, const int*, const int*, const int*, size_t, int&, int&, int&, int&);
+		size_t (*containing)(const int*, const int*, const int*, const int*, size_t, int, int, Uint8*);
+		size_t (*intersecting)(const int*, const int*, const int*, const int*, size_t, int, int, int, int, Uint8*);
+		size_t (*intersectingRects)(const SDL_Rect*, size_t, int, int, int, int, Uint8*);
+		size_t (*inside)(const SDL_Point*, size_t, int, int, int, int, Uint8*);
+	};
+
+	const Table scalarTable = {
+		translateScalar<float>,
+		translateScalar<int>,
+		scaleScalar,
+		normalizeScalar,
+		lengthsScalar,
+		clampScalar<float>,
+		clampScalar<int>,
+		boundsScalar<float>,
+		boundsScalar<int>,
+		rectBoundsScalar,
+		containingScalar,
+		intersectingScalar,
+		intersectingRectsScalar,
+		insideScalar,
+	};
+
+#if defined(SDLPP_KERNELS_X86)
+	const Table sse2Table = {
+		translateSSE2,
+		translateIntSSE2,
+		scaleSSE2,
+		normalizeSSE2,
+		lengthsSSE2,
+		clampSSE2,
+		clampScalar<int>,
+		boundsSSE2,
+		boundsScalar<int>,
+		rectBoundsScalar,
+		containingSSE2,
+		intersectingSSE2,
+		intersectingRectsSSE2,
+		insideSSE2,
+	};
+
+	const Table sse41Table = {
+		translateSSE2,
+		translateIntSSE2,
+		scaleSSE2,
+		normalizeSSE2,
+		lengthsSSE2,
+		clampSSE2,
+		clampIntSSE41,
+		boundsSSE2,
+		boundsIntSSE41,
+		rectBoundsSSE41,
+		containingSSE2,
+		intersectingSSE2,
+		intersectingRectsSSE2,
+		insideSSE2,
+	};
+
+	const Table avx2Table = {
+		translateAVX2,
+		translateIntAVX2,
+		scaleAVX2,
+		normalizeAVX2,
+		lengthsAVX2,
+		clampAVX2,
+		clampIntAVX2,
+		boundsAVX2,
+		boundsIntAVX2,
+		rectBoundsAVX2,
+		containingAVX2,
+		intersectingAVX2,
+		intersectingRectsSSE2,
+		insideSSE2,
+	};
+#endif
+
+	const Table &table()
+	{
+		switch (isa()) {
+#if defined(SDLPP_KERNELS_X86)
+		case Isa::AVX2:  return avx2Table;
+		case Isa::SSE41: return sse41Table;
+		case Isa::SSE2:  return sse2Table;
+#endif
+		default:         return scalarTable;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void translatePoints(float *x, float *y, size_t n, float dx, float dy)
+{
+	table().translate(x, y, n, dx, dy);
+}
+
+void translatePoints(int *x, int *y, size_t n, int dx, int dy)
+{
+	table().translateInt(x, y, n, dx, dy);
+}
+
+void scalePoints(float *x, float *y, size_t n, float sx, float sy)
+{
+	table().scale(x, y, n, sx, sy);
+}
+
+void normalizePoints(float *x, float *y, size_t n)
+{
+	table().normalize(x, y, n);
+}
+
+void pointLengths(const float *x, const float *y, float *lengths, size_t n)
+{
+	table().lengths(x, y, lengths, n);
+}
+
+void clampPoints(float *x, float *y, size_t n, float minX, float minY, float maxX, float maxY)
+{
+	table().clamp(x, y, n, minX, minY, maxX, maxY);
+}
+
+void clampPoints(int *x, int *y, size_t n, int minX, int minY, int maxX, int maxY)
+{
+	table().clampInt(x, y, n, minX, minY, maxX, maxY);
+}
+
+void pointBounds(const float *x, const float *y, size_t n, float &minX, float &minY, float &maxX, float &maxY)
+{
+	minX = maxX = x[0];
+	minY = maxY = y[0];
+	table().bounds(x, y, n, minX, minY, maxX, maxY);
+}
+
+void pointBounds(const int *x, const int *y, size_t n, int &minX, int &minY, int &maxX, int &maxY)
+{
+	minX = maxX = x[0];
+	minY = maxY = y[0];
+	table().boundsInt(x, y, n, minX, minY, maxX, maxY);
+}
+
+size_t rectsContaining(const int *x, const int *y, const int *w, const int *h, size_t n, int px, int py, Uint8 *mask)
+{
+	return table().containing(x, y, w, h, n, px, py, mask);
+}
+
+size_t rectsIntersecting(const int *x, const int *y, const int *w, const int *h, size_t n, const SDL_Rect &area, Uint8 *mask)
+{
+	return table().intersecting(x, y, w, h, n, area.x, area.y, area.x + area.w, area.y + area.h, mask);
+}
+
+size_t rectsIntersecting(const SDL_Rect *rects, size_t n, const SDL_Rect &area, Uint8 *mask)
+{
+	return table().intersectingRects(rects, n, area.x, area.y, area.x + area.w, area.y + area.h, mask);
+}
+
+size_t pointsInside(const SDL_Point *points, size_t n, const SDL_Rect &area, Uint8 *mask)
+{
+	return table().inside(points, n, area.x, area.y, area.x + area.w, area.y + area.h, mask);
+}
+
+SDL_Rect rectBounds(const int *x, const int *y, const int *w, const int *h, size_t n)
+{
+	int x1 = x[0], y1 = y[0];
+	int x2 = x[0] + w[0], y2 = y[0] + h[0];
+	table().rectBounds(x, y, w, h, n, x1, y1, x2, y2);
+	return SDL_Rect{x1, y1, x2 - x1, y2 - y1};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,165 @@
+/*
+** SDL++, 2020
+** Haptic.cpp
+*/
+
+#include "SDL++/Haptic.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+Haptic::EffectId Haptic::Effects::acquire(const Effect &e)
+{
+	// An idle effect of the same type only needs new parameters, if any.
+	for (size_t i = 0; i < idle.size(); ++i) {
+		if (idle[i].effect.type != e.type)
+			continue;
+
+		const EffectId id = idle[i].id;
+		const bool same = idle[i].effect == e;
+		idle[i] = std::move(idle.back());
+		idle.pop_back();
+		if (same || SDL_HapticUpdateEffect(haptic, id, e) >= 0)
+			return id;
+		SDL_HapticDestroyEffect(haptic, id);
+		break;
+	}
+
+	// The device may be out of effect slots: free idle ones until it fits.
+	for (;;) {
+		const EffectId id = SDL_HapticNewEffect(haptic, e);
+		if (id >= 0)
+			return id;
+		if (idle.empty())
+			return -1;
+		SDL_HapticDestroyEffect(haptic, idle.back().id);
+		idle.pop_back();
+	}
+}
+
+void Haptic::Effects::release(SlotMap<InstalledSlot>::Key key)
+{
+	const InstalledSlot *slot = installed.find(key);
+	if (!slot)
+		return;
+
+	SDL_HapticStopEffect(haptic, slot->id);
+	if (idle.size() < idleLimit)
+		idle.push_back(*slot);
+	else
+		SDL_HapticDestroyEffect(haptic, slot->id);
+	installed.erase(key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Haptic::InstalledEffect::run(Uint32 iterations)
+{
+	run(iterations, std::nothrow).raise();
+}
+
+void Haptic::InstalledEffect::stop()
+{
+	stop(std::nothrow).raise();
+}
+
+void Haptic::InstalledEffect::update(const Effect &e)
+{
+	update(e, std::nothrow).raise();
+}
+
+Status Haptic::InstalledEffect::run(Uint32 iterations, std::nothrow_t) noexcept
+{
+	const InstalledSlot *slot = m_effects ? m_effects->installed.find(m_key) : nullptr;
+	return slot ? Status::check(SDL_HapticRunEffect(m_effects->haptic, slot->id, iterations), "SDL_HapticRunEffect") : Status{};
+}
+
+Status Haptic::InstalledEffect::stop(std::nothrow_t) noexcept
+{
+	const InstalledSlot *slot = m_effects ? m_effects->installed.find(m_key) : nullptr;
+	return slot ? Status::check(SDL_HapticStopEffect(m_effects->haptic, slot->id), "SDL_HapticStopEffect") : Status{};
+}
+
+Status Haptic::InstalledEffect::update(const Effect &e, std::nothrow_t) noexcept
+{
+	InstalledSlot *slot = m_effects ? m_effects->installed.find(m_key) : nullptr;
+	if (!slot || slot->effect == e)
+		return {};
+
+	if (SDL_HapticUpdateEffect(m_effects->haptic, slot->id, e) < 0)
+		return Status::failure("SDL_HapticUpdateEffect");
+	slot->effect = e;
+	return {};
+}
+
+const Haptic::Effect *Haptic::InstalledEffect::effect() const
+{
+	const InstalledSlot *slot = m_effects ? m_effects->installed.find(m_key) : nullptr;
+	return slot ? &slot->effect : nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Haptic::InstalledEffect Haptic::newEffect(const Effect &e)
+{
+	return newEffect(e, std::nothrow).value();
+}
+
+Result<Haptic::InstalledEffect> Haptic::newEffect(const Effect &e, std::nothrow_t)
+{
+	if (!valid())
+		return InstalledEffect{};
+	const unsigned capabilities = SDL_HapticQuery(m_haptic);
+	if (!capabilities)
+		return Status::failure("SDL_HapticQuery");
+	if (!(capabilities & e.type))
+		return InstalledEffect{};
+
+	InstalledSlot slot;
+	slot.id = m_effects->acquire(e);
+	if (slot.id < 0)
+		return Status::failure("SDL_HapticNewEffect");
+	slot.effect = e;
+	return InstalledEffect{m_effects.get(), m_effects->installed.insert(slot)};
+}
+
+void Haptic::runEffect(const InstalledEffect &h, Uint32 iterations) const
+{
+	const_cast<InstalledEffect&>(h).run(iterations);
+}
+
+void Haptic::stopEffect(const InstalledEffect &h) const
+{
+	const_cast<InstalledEffect&>(h).stop();
+}
+
+void Haptic::updateEffect(const InstalledEffect &h, const Effect &e) const
+{
+	const_cast<InstalledEffect&>(h).update(e);
+}
+
+Haptic::EffectId Haptic::getEffectId(const InstalledEffect &h) const
+{
+	const InstalledSlot *slot = h.m_effects ? h.m_effects->installed.find(h.m_key) : nullptr;
+	return slot ? slot->id : -1;
+}
+
+void Haptic::setIdleEffectLimit(size_t limit)
+{
+	if (!m_effects)
+		return;
+
+	m_effects->idleLimit = limit;
+	while (m_effects->idle.size() > limit) {
+		SDL_HapticDestroyEffect(m_haptic, m_effects->idle.back().id);
+		m_effects->idle.pop_back();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
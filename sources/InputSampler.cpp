@@ -0,0 +1,164 @@
+/*
+** SDL++, 2020
+** InputSampler.cpp
+*/
+
+#include "SDL++/InputSampler.hpp"
+
+#include <SDL2/SDL_events.h>
+#include <SDL2/SDL_joystick.h>
+#include <SDL2/SDL_platform.h>
+
+#include <cstring>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	bool sameInput(const ControllerState &a, const ControllerState &b)
+	{
+		return a.buttons == b.buttons
+			&& a.attached == b.attached
+			&& std::memcmp(a.axes, b.axes, sizeof(a.axes)) == 0
+			&& std::memcmp(a.hats, b.hats, sizeof(a.hats)) == 0;
+	}
+
+	// The poller's edges are relative to its previous poll, which the game
+	// never sees if that sample was not queued.
+	ControllerState withEdges(ControllerState state, Uint64 previous)
+	{
+		state.pressed = state.buttons & ~previous;
+		state.released = previous & ~state.buttons;
+		return state;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+InputSampler::InputSampler(ControllerPoller poller, Mode mode, std::chrono::microseconds interval, size_t capacity)
+: m_poller{std::move(poller)}
+, m_mode{mode == Mode::Thread && !threadSupported() ? Mode::SubFrame : mode}
+, m_interval{interval}
+, m_intervalTicks{static_cast<Uint64>(interval.count()) * Timer::perfFrequency() / 1000000}
+, m_ring{capacity}
+{
+	start();
+}
+
+InputSampler::~InputSampler()
+{
+	stop();
+}
+
+bool InputSampler::threadSupported()
+{
+	// Joystick backends there expect the thread that runs the event loop.
+#if defined(__MACOSX__) || defined(__IPHONEOS__) || defined(__TVOS__) || defined(__ANDROID__) || defined(__EMSCRIPTEN__)
+	return false;
+#else
+	return true;
+#endif
+}
+
+void InputSampler::start()
+{
+	if (m_mode != Mode::Thread || m_thread.joinable())
+		return;
+
+	m_stopping.store(false);
+	m_thread = std::thread{[this] { run(); }};
+}
+
+void InputSampler::stop()
+{
+	if (!m_thread.joinable())
+		return;
+
+	m_stopping.store(true);
+	m_thread.join();
+}
+
+size_t InputSampler::sample()
+{
+	if (m_mode != Mode::SubFrame)
+		return 0;
+
+	const Uint64 now = Timer::perfCounter();
+	if (m_lastPoll && now - m_lastPoll < m_intervalTicks)
+		return 0;
+
+	SDL_PumpEvents();
+	return poll();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void InputSampler::run()
+{
+	while (!m_stopping.load(std::memory_order_relaxed)) {
+		SDL_JoystickUpdate();
+		poll();
+		std::this_thread::sleep_for(m_interval);
+	}
+}
+
+size_t InputSampler::poll()
+{
+	m_lastPoll = Timer::perfCounter();
+	m_poller.poll();
+
+	const auto &states = m_poller.states();
+	m_published.resize(states.size());
+	m_pending.resize(states.size());
+
+	size_t queued = 0;
+	for (size_t i = 0; i < states.size(); ++i) {
+		const ControllerState &s = states[i];
+		ControllerState &last = m_published[i];
+		const bool sameDevice = last.id == s.id;
+		if (!sameDevice)
+			m_pending[i] = 0;
+		else if (!m_pending[i] && sameInput(last, s))
+			continue;
+
+		// Buttons that changed while the ring was full but are back to their
+		// published state: queue one sample with them flipped first, so the
+		// game still sees the press and the release.
+		const Uint64 changed = last.buttons ^ s.buttons;
+		if (const Uint64 bounced = m_pending[i] & ~changed) {
+			ControllerState between = s;
+			between.buttons ^= bounced;
+			between = withEdges(between, last.buttons);
+			if (!m_ring.push(Sample{m_lastPoll, between})) {
+				m_pending[i] |= changed;
+				m_dropped.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+			last = between;
+			m_pending[i] = 0;
+			m_coalesced.fetch_add(1, std::memory_order_relaxed);
+			++queued;
+		}
+
+		const ControllerState next = withEdges(s, sameDevice ? last.buttons : 0);
+		if (m_ring.push(Sample{m_lastPoll, next})) {
+			last = next;
+			m_pending[i] = 0;
+			++queued;
+		} else {
+			m_pending[i] |= last.buttons ^ s.buttons;
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+	return queued;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,213 @@
+/*
+** SDL++, 2020
+** LooseQuadtree.cpp
+*/
+
+#include "SDL++/LooseQuadtree.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	Uint32 spreadBits(Uint32 v)
+	{
+		v &= 0xFFFFu;
+		v = (v | (v << 8)) & 0x00FF00FFu;
+		v = (v | (v << 4)) & 0x0F0F0F0Fu;
+		v = (v | (v << 2)) & 0x33333333u;
+		v = (v | (v << 1)) & 0x55555555u;
+		return v;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+LooseQuadtree::LooseQuadtree(const Rect &world, int maxDepth)
+: m_shift{0}
+{
+	const int extent = std::max({world.w, world.h, 1});
+	while (m_shift < 30 && (1 << m_shift) < extent)
+		++m_shift;
+
+	m_world = Rect{world.x, world.y, 1 << m_shift, 1 << m_shift};
+	m_maxDepth = std::clamp(maxDepth, 0, m_shift);
+	m_nodes.emplace_back(m_world);
+}
+
+const Rect *LooseQuadtree::bounds(Id id) const
+{
+	const auto it = m_slots.find(id);
+	return it == m_slots.end() ? nullptr : &m_bounds[it->second];
+}
+
+void LooseQuadtree::insert(Id id, const Rect &bounds)
+{
+	if (move(id, bounds))
+		return;
+
+	const auto slot = static_cast<Uint32>(m_ids.size());
+	m_slots.emplace(id, slot);
+	m_ids.push_back(id);
+	m_bounds.push_back(bounds);
+	m_nodeOf.push_back(0);
+	link(slot, nodeFor(bounds));
+}
+
+bool LooseQuadtree::move(Id id, const Rect &bounds)
+{
+	const auto it = m_slots.find(id);
+	if (it == m_slots.end())
+		return false;
+
+	const Uint32 slot = it->second;
+	const Uint32 node = nodeFor(bounds);
+	m_bounds[slot] = bounds;
+	if (node == m_nodeOf[slot]) {
+		for (auto &e : m_nodes[node].entries)
+			if (e.slot == slot)
+				e.bounds = bounds;
+	} else {
+		unlink(slot);
+		link(slot, node);
+	}
+	return true;
+}
+
+bool LooseQuadtree::remove(Id id)
+{
+	const auto it = m_slots.find(id);
+	if (it == m_slots.end())
+		return false;
+
+	const Uint32 slot = it->second;
+	const auto last = static_cast<Uint32>(m_ids.size() - 1);
+	unlink(slot);
+	m_slots.erase(it);
+
+	if (slot != last) {
+		m_ids[slot] = m_ids[last];
+		m_bounds[slot] = m_bounds[last];
+		m_nodeOf[slot] = m_nodeOf[last];
+		m_slots[m_ids[slot]] = slot;
+		for (auto &e : m_nodes[m_nodeOf[slot]].entries)
+			if (e.slot == last)
+				e.slot = slot;
+	}
+	m_ids.pop_back();
+	m_bounds.pop_back();
+	m_nodeOf.pop_back();
+	return true;
+}
+
+void LooseQuadtree::clear()
+{
+	m_nodes.clear();
+	m_nodes.emplace_back(m_world);
+	m_slots.clear();
+	m_ids.clear();
+	m_bounds.clear();
+	m_nodeOf.clear();
+}
+
+void LooseQuadtree::rebuild(const std::vector<std::pair<Id, Rect>> &objects)
+{
+	clear();
+
+	// Z order of the centers, quantized to 16 bits per axis.
+	const Sint64 side = m_world.w;
+	std::vector<Uint32> code(objects.size());
+	for (size_t i = 0; i < objects.size(); ++i) {
+		const Rect &r = objects[i].second;
+		const Sint64 cx = std::clamp<Sint64>(Sint64(r.x) + r.w / 2 - m_world.x, 0, side - 1);
+		const Sint64 cy = std::clamp<Sint64>(Sint64(r.y) + r.h / 2 - m_world.y, 0, side - 1);
+		code[i] = spreadBits(Uint32((cx << 16) / side)) | spreadBits(Uint32((cy << 16) / side)) << 1;
+	}
+
+	std::vector<Uint32> order(objects.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&](Uint32 a, Uint32 b) { return code[a] < code[b]; });
+
+	m_slots.reserve(objects.size());
+	m_ids.reserve(objects.size());
+	m_bounds.reserve(objects.size());
+	m_nodeOf.reserve(objects.size());
+	for (Uint32 i : order) {
+		const auto slot = static_cast<Uint32>(m_ids.size());
+		if (!m_slots.emplace(objects[i].first, slot).second)
+			continue;
+		m_ids.push_back(objects[i].first);
+		m_bounds.push_back(objects[i].second);
+		m_nodeOf.push_back(0);
+		link(slot, nodeFor(objects[i].second));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint32 LooseQuadtree::nodeFor(const Rect &bounds)
+{
+	// The node is the deepest one at least as large as the object, among
+	// those containing its center; its loose bounds then contain the object.
+	const Sint64 side = m_world.w;
+	const Sint64 extent = std::max({bounds.w, bounds.h, 1});
+	const Sint64 cx = Sint64(bounds.x) + bounds.w / 2 - m_world.x;
+	const Sint64 cy = Sint64(bounds.y) + bounds.h / 2 - m_world.y;
+	if (extent > side || cx < 0 || cy < 0 || cx >= side || cy >= side)
+		return 0;
+
+	int depth = 0;
+	while (depth < m_maxDepth && (side >> (depth + 1)) >= extent)
+		++depth;
+
+	const auto ix = static_cast<int>(cx >> (m_shift - depth));
+	const auto iy = static_cast<int>(cy >> (m_shift - depth));
+
+	Uint32 node = 0;
+	for (int level = 1; level <= depth; ++level) {
+		const int nx = ix >> (depth - level);
+		const int ny = iy >> (depth - level);
+		const int quadrant = (ny & 1) * 2 + (nx & 1);
+
+		Uint32 child = m_nodes[node].children[quadrant];
+		if (!child) {
+			const int size = 1 << (m_shift - level);
+			const int margin = size / 2 + 1;
+			child = static_cast<Uint32>(m_nodes.size());
+			m_nodes[node].children[quadrant] = child;
+			m_nodes.emplace_back(Rect{
+				m_world.x + nx * size - margin,
+				m_world.y + ny * size - margin,
+				size + 2 * margin,
+				size + 2 * margin,
+			});
+		}
+		node = child;
+	}
+	return node;
+}
+
+void LooseQuadtree::link(Uint32 slot, Uint32 node)
+{
+	m_nodes[node].entries.push_back(Entry{m_bounds[slot], slot});
+	m_nodeOf[slot] = node;
+}
+
+void LooseQuadtree::unlink(Uint32 slot)
+{
+	auto &entries = m_nodes[m_nodeOf[slot]].entries;
+	const auto it = std::find_if(entries.begin(), entries.end(), [&](const Entry &e) { return e.slot == slot; });
+	*it = entries.back();
+	entries.pop_back();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,219 @@
+/*
+** SDL++, 2020
+** Lz.cpp
+*/
+
+#include "SDL++/Lz.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL::Lz
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+// A block is a list of sequences: a token byte holding the literal count and
+// the match length minus 4 in its high and low nibbles (15 meaning that
+// 255-terminated extension bytes follow), the literals, then a little-endian
+// 16-bit match offset. The last sequence stops after its literals.
+namespace
+{
+	constexpr int hashBits = 14;
+	constexpr size_t minMatch = 4;
+	constexpr size_t lastLiterals = 5;
+	constexpr size_t matchLimit = 12;
+	constexpr size_t maxOffset = 65535;
+
+	Uint32 read32(const Uint8 *p)
+	{
+		Uint32 v;
+		std::memcpy(&v, p, sizeof v);
+		return v;
+	}
+
+	Uint64 read64(const Uint8 *p)
+	{
+		Uint64 v;
+		std::memcpy(&v, p, sizeof v);
+		return v;
+	}
+
+	Uint32 hash(Uint32 v)
+	{
+		return (v * 2654435761u) >> (32 - hashBits);
+	}
+
+	Uint8 *putLength(Uint8 *op, size_t length)
+	{
+		for (; length >= 255; length -= 255)
+			*op++ = 255;
+		*op++ = static_cast<Uint8>(length);
+		return op;
+	}
+
+	bool getLength(const Uint8 *&ip, const Uint8 *end, size_t &length)
+	{
+		Uint8 b;
+		do {
+			if (ip == end)
+				return false;
+			b = *ip++;
+			length += b;
+		} while (b == 255);
+		return true;
+	}
+
+	// Overlapping matches repeat the last offset bytes, so the copy doubles
+	// the span it reads from instead of going byte by byte.
+	void copyMatch(Uint8 *op, size_t offset, size_t length)
+	{
+		if (offset >= length) {
+			std::memcpy(op, op - offset, length);
+			return;
+		}
+		size_t done = 0;
+		size_t span = offset;
+		while (done < length) {
+			const size_t n = std::min(span, length - done);
+			std::memcpy(op + done, op + done - span, n);
+			done += n;
+			span = (done / offset + 1) * offset;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t bound(size_t size)
+{
+	return size + size / 255 + 16;
+}
+
+size_t compress(const void *src, size_t size, void *dst, size_t capacity)
+{
+	const Uint8 *const in = static_cast<const Uint8*>(src);
+	const Uint8 *const end = in + size;
+	const Uint8 *ip = in;
+	const Uint8 *anchor = in;
+	Uint8 *const out = static_cast<Uint8*>(dst);
+	Uint8 *op = out;
+
+	const auto emit = [&](const Uint8 *literalEnd, size_t offset, size_t matchLength) {
+		const size_t literals = static_cast<size_t>(literalEnd - anchor);
+		const size_t m = matchLength ? matchLength - minMatch : 0;
+		size_t needed = 1 + literals + (literals >= 15 ? (literals - 15) / 255 + 1 : 0);
+		if (matchLength)
+			needed += 2 + (m >= 15 ? (m - 15) / 255 + 1 : 0);
+		if (capacity - static_cast<size_t>(op - out) < needed)
+			return false;
+
+		Uint8 *token = op++;
+		*token = static_cast<Uint8>(std::min<size_t>(literals, 15) << 4);
+		if (literals >= 15)
+			op = putLength(op, literals - 15);
+		if (literals)
+			std::memcpy(op, anchor, literals);
+		op += literals;
+
+		if (matchLength) {
+			*op++ = static_cast<Uint8>(offset);
+			*op++ = static_cast<Uint8>(offset >> 8);
+			*token |= static_cast<Uint8>(std::min<size_t>(m, 15));
+			if (m >= 15)
+				op = putLength(op, m - 15);
+		}
+		return true;
+	};
+
+	if (size >= matchLimit) {
+		std::vector<Uint32> table(size_t{1} << hashBits, 0);
+		const Uint8 *const lastMatchStart = end - matchLimit;
+		const Uint8 *const matchEnd = end - lastLiterals;
+
+		while (ip <= lastMatchStart) {
+			const Uint32 v = read32(ip);
+			Uint32 &slot = table[hash(v)];
+			const Uint8 *ref = in + slot;
+			slot = static_cast<Uint32>(ip - in);
+
+			if (ref >= ip || static_cast<size_t>(ip - ref) > maxOffset || read32(ref) != v) {
+				// Skip faster through data that does not compress.
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			const Uint8 *p = ip + minMatch;
+			const Uint8 *q = ref + minMatch;
+			while (p + 8 <= matchEnd && read64(p) == read64(q)) {
+				p += 8;
+				q += 8;
+			}
+			while (p < matchEnd && *p == *q) {
+				++p;
+				++q;
+			}
+
+			if (!emit(ip, static_cast<size_t>(ip - ref), static_cast<size_t>(p - ip)))
+				return 0;
+			ip = anchor = p;
+			if (ip <= lastMatchStart)
+				table[hash(read32(ip - 2))] = static_cast<Uint32>(ip - 2 - in);
+		}
+	}
+
+	if (!emit(end, 0, 0))
+		return 0;
+	return static_cast<size_t>(op - out);
+}
+
+bool decompress(const void *src, size_t compressedSize, void *dst, size_t size)
+{
+	const Uint8 *ip = static_cast<const Uint8*>(src);
+	const Uint8 *const end = ip + compressedSize;
+	Uint8 *const out = static_cast<Uint8*>(dst);
+	Uint8 *const outEnd = out + size;
+	Uint8 *op = out;
+
+	while (ip < end) {
+		const Uint8 token = *ip++;
+
+		size_t literals = token >> 4;
+		if (literals == 15 && !getLength(ip, end, literals))
+			return false;
+		if (static_cast<size_t>(end - ip) < literals || static_cast<size_t>(outEnd - op) < literals)
+			return false;
+		if (literals)
+			std::memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+
+		if (ip == end)
+			break;
+
+		if (end - ip < 2)
+			return false;
+		const size_t offset = ip[0] | static_cast<size_t>(ip[1]) << 8;
+		ip += 2;
+		if (offset == 0 || offset > static_cast<size_t>(op - out))
+			return false;
+
+		size_t length = token & 15;
+		if (length == 15 && !getLength(ip, end, length))
+			return false;
+		length += minMatch;
+		if (static_cast<size_t>(outEnd - op) < length)
+			return false;
+
+		copyMatch(op, offset, length);
+		op += length;
+	}
+	return op == outEnd;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,151 @@
+/*
+** SDL++, 2020
+** MappedFile.cpp
+*/
+
+#include "SDL++/MappedFile.hpp"
+
+#include <SDL2/SDL_rwops.h>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#define SDLPP_HAS_MMAP
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(SDLPP_HAS_MMAP)
+
+Status MappedFile::map(const std::string &filename)
+{
+	const int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		Error::set(std::strerror(errno));
+		return Status::failure("open");
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0) {
+		Error::set(std::strerror(errno));
+		::close(fd);
+		return Status::failure("fstat");
+	}
+
+	const auto size = static_cast<size_t>(st.st_size);
+	if (size > 0) {
+		void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED) {
+			Error::set(std::strerror(errno));
+			::close(fd);
+			return Status::failure("mmap");
+		}
+		m_data = static_cast<Uint8*>(p);
+		m_mapped = true;
+	}
+	m_size = size;
+	::close(fd);
+	return {};
+}
+
+void MappedFile::unmap()
+{
+	if (m_mapped)
+		::munmap(m_data, m_size);
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+}
+
+#elif defined(_WIN32)
+
+Status MappedFile::map(const std::string &filename)
+{
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		Error::set("Could not open file");
+		return Status::failure("CreateFileA");
+	}
+
+	LARGE_INTEGER size;
+	GetFileSizeEx(file, &size);
+	if (size.QuadPart > 0) {
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (mapping)
+			m_data = static_cast<Uint8*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+		if (mapping)
+			CloseHandle(mapping);
+		if (!m_data) {
+			CloseHandle(file);
+			Error::set("Could not map file");
+			return Status::failure("MapViewOfFile");
+		}
+		m_mapped = true;
+	}
+	m_size = static_cast<size_t>(size.QuadPart);
+	CloseHandle(file);
+	return {};
+}
+
+void MappedFile::unmap()
+{
+	if (m_mapped)
+		UnmapViewOfFile(m_data);
+	m_data = nullptr;
+	m_size = 0;
+	m_mapped = false;
+}
+
+#else
+
+Status MappedFile::map(const std::string &filename)
+{
+	m_data = static_cast<Uint8*>(SDL_LoadFile(filename.c_str(), &m_size));
+	if (!m_data)
+		return Status::failure("SDL_LoadFile");
+	return {};
+}
+
+void MappedFile::unmap()
+{
+	SDL_free(m_data);
+	m_data = nullptr;
+	m_size = 0;
+}
+
+#endif
+
+MappedFile::MappedFile(const std::string &filename)
+{
+	map(filename).raise();
+}
+
+Result<MappedFile> MappedFile::open(const std::string &filename, std::nothrow_t)
+{
+	MappedFile file;
+	if (const Status status = file.map(filename); !status)
+		return status;
+	return file;
+}
+
+MappedFile::~MappedFile()
+{
+	unmap();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
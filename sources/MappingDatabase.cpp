@@ -0,0 +1,300 @@
+/*
+** SDL++, 2020
+** MappingDatabase.cpp
+*/
+
+#include "SDL++/MappingDatabase.hpp"
+#include "SDL++/GameController.hpp"
+#include "SDL++/Hash.hpp"
+
+#include <SDL2/SDL_rwops.h>
+
+#include <algorithm>
+#include <cstring>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	using Entry = MappingDatabase::Entry;
+
+	bool less(const Entry &a, const Entry &b)
+	{
+		const int c = std::memcmp(a.guid, b.guid, sizeof(a.guid));
+		return c < 0 || (c == 0 && a.platform < b.platform);
+	}
+
+	bool sameKey(const Entry &a, const Entry &b)
+	{
+		return std::memcmp(a.guid, b.guid, sizeof(a.guid)) == 0 && a.platform == b.platform;
+	}
+
+	// Case-insensitive, as SDL compares platform names.
+	Uint64 platformHash(std::string_view platform)
+	{
+		if (platform.empty())
+			return 0;
+
+		Uint64 h = Hash::fnvOffset;
+		for (char c : platform) {
+			h ^= Uint8(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+			h *= Hash::fnvPrime;
+		}
+		return h;
+	}
+
+	int hexDigit(char c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		return -1;
+	}
+
+	bool parseGuid(std::string_view text, Uint8 (&guid)[16])
+	{
+		if (text.size() != 32)
+			return false;
+		for (size_t i = 0; i < 16; ++i) {
+			const int hi = hexDigit(text[2 * i]);
+			const int lo = hexDigit(text[2 * i + 1]);
+			if (hi < 0 || lo < 0)
+				return false;
+			guid[i] = Uint8(hi << 4 | lo);
+		}
+		return true;
+	}
+
+	void writeAll(SDL_RWops *rw, const void *data, size_t size)
+	{
+		if (size > 0 && SDL_RWwrite(rw, data, 1, size) != size) {
+			SDL_RWclose(rw);
+			SDLPP_THROW(Exception{"SDL_RWwrite"});
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+MappingDatabase::MappingDatabase(const std::string &filename)
+: m_file{filename}
+{
+	if (m_file.size() < sizeof(Header) || std::memcmp(m_file.data(), magic, sizeof(magic)) != 0) {
+		Error::set("Not an SDL++ mapping index");
+		SDLPP_THROW(Exception{"MappingDatabase"});
+	}
+
+	m_header = reinterpret_cast<const Header*>(m_file.data());
+	if (m_header->version != version) {
+		Error::set("Unsupported mapping index version");
+		SDLPP_THROW(Exception{"MappingDatabase"});
+	}
+
+	const Uint64 size = m_file.size();
+	const Header &h = *m_header;
+	bool valid = h.entriesOffset <= size && Uint64{h.entryCount} * sizeof(Entry) <= size - h.entriesOffset
+	          && h.entriesOffset % alignof(Entry) == 0
+	          && h.textOffset <= size;
+
+	if (valid) {
+		m_entries = reinterpret_cast<const Entry*>(m_file.data() + h.entriesOffset);
+		m_text = reinterpret_cast<const char*>(m_file.data() + h.textOffset);
+
+		// Checked once here so mapping() needs no bounds check.
+		for (Uint32 i = 0; valid && i < h.entryCount; ++i)
+			valid = Uint64{m_entries[i].textOffset} + m_entries[i].textLength <= size - h.textOffset;
+	}
+
+	if (!valid) {
+		Error::set("Truncated or corrupted mapping index");
+		SDLPP_THROW(Exception{"MappingDatabase"});
+	}
+
+	m_added.assign(m_header->entryCount, false);
+}
+
+const MappingDatabase::Entry *MappingDatabase::lookup(const Uint8 (&guid)[16], Uint64 platform) const
+{
+	Entry key{};
+	std::memcpy(key.guid, guid, sizeof(key.guid));
+	key.platform = platform;
+
+	const Entry *it = std::lower_bound(begin(), end(), key, less);
+	return it != end() && sameKey(*it, key) ? it : nullptr;
+}
+
+const MappingDatabase::Entry *MappingDatabase::find(const SDL_JoystickGUID &guid, std::string_view platform) const
+{
+	if (!m_header)
+		return nullptr;
+
+	Uint8 bytes[16];
+	std::memcpy(bytes, guid.data, sizeof(bytes));
+	const Uint64 hash = platformHash(platform);
+
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		const Entry *specific = hash ? lookup(bytes, hash) : nullptr;
+		const Entry *generic = lookup(bytes, 0);
+		// Text is in database order: the later line wins, as in SDL.
+		if (specific && generic)
+			return specific->textOffset > generic->textOffset ? specific : generic;
+		if (specific || generic)
+			return specific ? specific : generic;
+		if (bytes[2] == 0 && bytes[3] == 0)
+			break;
+		bytes[2] = bytes[3] = 0;
+	}
+	return nullptr;
+}
+
+bool MappingDatabase::addMappingFor(int joystickIndex)
+{
+	const Entry *e = find(SDL_JoystickGetDeviceGUID(joystickIndex));
+	if (!e)
+		return false;
+
+	const size_t i = size_t(e - m_entries);
+	if (m_added[i])
+		return false;
+
+	GameController::addMapping(std::string{mapping(*e)});
+	m_added[i] = true;
+	++m_addedCount;
+	return true;
+}
+
+size_t MappingDatabase::addConnected()
+{
+	size_t added = 0;
+	for (int i = 0, n = SDL_NumJoysticks(); i < n; ++i)
+		added += addMappingFor(i);
+	return added;
+}
+
+bool MappingDatabase::handle(const Event &event)
+{
+	return event.type == SDL_JOYDEVICEADDED && addMappingFor(event.jdevice.which);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t MappingDatabaseWriter::addDatabase(std::string_view text)
+{
+	size_t kept = 0;
+	size_t start = 0;
+	while (start < text.size()) {
+		size_t end = text.find('\n', start);
+		if (end == std::string_view::npos)
+			end = text.size();
+		std::string_view line = text.substr(start, end - start);
+		start = end + 1;
+
+		while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+			line.remove_suffix(1);
+		while (!line.empty() && (line.front() == ' ' || line.front() == '\t'))
+			line.remove_prefix(1);
+		if (line.empty() || line.front() == '#')
+			continue;
+
+		// GUID,name,mapping,...,platform:name,
+		Pending p;
+		const size_t comma = line.find(',');
+		if (comma == std::string_view::npos || !parseGuid(line.substr(0, comma), p.entry.guid)
+		 || line.find(',', comma + 1) == std::string_view::npos) {
+			++m_skipped;
+			continue;
+		}
+
+		std::string_view platform;
+		if (const size_t at = line.find("platform:"); at != std::string_view::npos) {
+			platform = line.substr(at + 9);
+			platform = platform.substr(0, platform.find(','));
+		}
+		if (!m_platform.empty() && !platform.empty() && platformHash(platform) != platformHash(m_platform))
+			continue;
+
+		p.entry.platform = platformHash(platform);
+		p.order = m_order++;
+		p.text = std::string{line};
+		m_pending.push_back(std::move(p));
+		++kept;
+	}
+
+	// Sort by key, keeping only the last mapping of each.
+	std::stable_sort(m_pending.begin(), m_pending.end(), [](const Pending &a, const Pending &b) {
+		return less(a.entry, b.entry);
+	});
+	size_t out = 0;
+	for (size_t i = 0; i < m_pending.size(); ++i) {
+		if (i + 1 < m_pending.size() && sameKey(m_pending[i].entry, m_pending[i + 1].entry))
+			continue;
+		if (out != i)
+			m_pending[out] = std::move(m_pending[i]);
+		++out;
+	}
+	m_pending.resize(out);
+
+	return kept;
+}
+
+size_t MappingDatabaseWriter::addFile(const std::string &filename)
+{
+	size_t size = 0;
+	void *data = SDL_LoadFile(filename.c_str(), &size);
+	if (!data)
+		SDLPP_THROW(Exception{"SDL_LoadFile"});
+	const std::string text{static_cast<const char*>(data), size};
+	SDL_free(data);
+	return addDatabase(text);
+}
+
+void MappingDatabaseWriter::write(const std::string &filename) const
+{
+	MappingDatabase::Header header{};
+	std::memcpy(header.magic, MappingDatabase::magic, sizeof(header.magic));
+	header.version = MappingDatabase::version;
+	header.entryCount = static_cast<Uint32>(m_pending.size());
+	header.entriesOffset = sizeof(header);
+	header.textOffset = header.entriesOffset + m_pending.size() * sizeof(Entry);
+
+	// Entries in key order, text in database order so find() can tell
+	// which of two mappings came last.
+	std::vector<size_t> byOrder(m_pending.size());
+	for (size_t i = 0; i < byOrder.size(); ++i)
+		byOrder[i] = i;
+	std::sort(byOrder.begin(), byOrder.end(), [this](size_t a, size_t b) {
+		return m_pending[a].order < m_pending[b].order;
+	});
+
+	std::vector<Entry> entries(m_pending.size());
+	std::string text;
+	for (const size_t i : byOrder) {
+		entries[i] = m_pending[i].entry;
+		entries[i].textOffset = static_cast<Uint32>(text.size());
+		entries[i].textLength = static_cast<Uint32>(m_pending[i].text.size());
+		text += m_pending[i].text;
+	}
+
+	SDL_RWops *rw = SDL_RWFromFile(filename.c_str(), "wb");
+	if (!rw)
+		SDLPP_THROW(Exception{"SDL_RWFromFile"});
+
+	writeAll(rw, &header, sizeof(header));
+	writeAll(rw, entries.data(), entries.size() * sizeof(Entry));
+	writeAll(rw, text.data(), text.size());
+
+	if (SDL_RWclose(rw) != 0)
+		SDLPP_THROW(Exception{"SDL_RWclose"});
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,221 @@
+/*
+** SDL++, 2020
+** Parallel.cpp
+*/
+
+#include "SDL++/Parallel.hpp"
+#include "SDL++/Utils.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <numeric>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// Set while a thread executes chunks, so nested run() calls go inline
+	// instead of deadlocking on the pool.
+	thread_local bool t_inPool = false;
+
+	struct InPool
+	{
+		InPool() { t_inPool = true; }
+		~InPool() { t_inPool = false; }
+	};
+}
+
+struct ThreadPool::Job
+{
+	Job(const Range &fn, int count, int grain)
+	: fn{fn}, count{count}, grain{grain}
+	{}
+
+	const Range &fn;
+	const int count;
+	const int grain;
+	std::atomic<int> next{0};
+
+	std::mutex errorMutex;
+	std::exception_ptr error;
+
+	void work()
+	{
+		InPool flag;
+		for (int begin = next.fetch_add(grain); begin < count; begin = next.fetch_add(grain)) {
+			SDLPP_TRY {
+				fn(begin, std::min(begin + grain, count));
+			} SDLPP_CATCH(...) {
+				std::lock_guard lock{errorMutex};
+				if (!error)
+					error = std::current_exception();
+			}
+		}
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::ThreadPool(int threads)
+{
+	start(threads);
+}
+
+ThreadPool::~ThreadPool()
+{
+	stop();
+}
+
+void ThreadPool::run(int count, int grain, const Range &fn)
+{
+	if (count <= 0)
+		return;
+	grain = std::max(grain, 1);
+
+	std::unique_lock submit{m_submit, std::defer_lock};
+	if (m_workers.empty() || count <= grain || t_inPool || !submit.try_lock()) {
+		fn(0, count);
+		return;
+	}
+
+	Job job{fn, count, grain};
+	{
+		std::lock_guard lock{m_mutex};
+		m_job = &job;
+		m_active = m_workers.size();
+		++m_generation;
+	}
+	m_wake.notify_all();
+
+	job.work();
+
+	{
+		std::unique_lock lock{m_mutex};
+		m_done.wait(lock, [this] { return m_active == 0; });
+		m_job = nullptr;
+	}
+
+	if (job.error)
+		std::rethrow_exception(job.error);
+}
+
+void ThreadPool::resize(int threads)
+{
+	std::lock_guard submit{m_submit};
+	stop();
+	start(threads);
+}
+
+ThreadPool &ThreadPool::shared()
+{
+	static ThreadPool pool{System::CPUCount()};
+	return pool;
+}
+
+void ThreadPool::start(int threads)
+{
+	// Workers start from the current generation so that a job posted before
+	// they first take the lock is not skipped.
+	m_stopping = false;
+	const size_t generation = m_generation;
+	for (int i = 1; i < threads; ++i)
+		m_workers.emplace_back([this, generation] { workerLoop(generation); });
+}
+
+void ThreadPool::stop()
+{
+	{
+		std::lock_guard lock{m_mutex};
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+	for (auto &t : m_workers)
+		t.join();
+	m_workers.clear();
+}
+
+void ThreadPool::workerLoop(size_t seen)
+{
+	for (;;) {
+		std::unique_lock lock{m_mutex};
+		m_wake.wait(lock, [&] { return m_stopping || m_generation != seen; });
+		if (m_stopping)
+			return;
+		seen = m_generation;
+		Job *job = m_job;
+		lock.unlock();
+
+		job->work();
+
+		lock.lock();
+		if (--m_active == 0)
+			m_done.notify_one();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace Parallel
+{
+	namespace
+	{
+		// A band of 128 KiB stays in L2 on anything recent while still giving
+		// each thread several bands of an 8K image to balance the load.
+		std::atomic<size_t> s_bandBytes{128 * 1024};
+		std::atomic<size_t> s_threshold{512 * 1024};
+	}
+
+	size_t bandBytes()
+	{
+		return s_bandBytes.load(std::memory_order_relaxed);
+	}
+
+	void setBandBytes(size_t bytes)
+	{
+		s_bandBytes.store(std::max<size_t>(bytes, 1), std::memory_order_relaxed);
+	}
+
+	size_t threshold()
+	{
+		return s_threshold.load(std::memory_order_relaxed);
+	}
+
+	void setThreshold(size_t bytes)
+	{
+		s_threshold.store(bytes, std::memory_order_relaxed);
+	}
+
+	int bandRows(int height, int pitch)
+	{
+		pitch = std::max(pitch, 1);
+		const int line = std::max(System::CPUCachelineSize(), 1);
+		const int step = line / std::gcd(pitch, line);
+		const int bands = ThreadPool::shared().threadCount() * 4;
+
+		int rows = static_cast<int>(std::max<size_t>(bandBytes() / static_cast<size_t>(pitch), 1));
+		rows = std::min(rows, (height + bands - 1) / bands);
+		rows = (std::max(rows, 1) + step - 1) / step * step;
+		return std::min(rows, std::max(height, 1));
+	}
+
+	void forRows(int height, int pitch, const std::function<void(int y0, int y1)> &fn)
+	{
+		if (height <= 0)
+			return;
+		if (static_cast<size_t>(height) * static_cast<size_t>(std::max(pitch, 1)) < threshold()) {
+			fn(0, height);
+			return;
+		}
+		ThreadPool::shared().run(height, bandRows(height, pitch), fn);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
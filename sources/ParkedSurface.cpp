@@ -0,0 +1,240 @@
+/*
+** SDL++, 2020
+** ParkedSurface.cpp
+*/
+
+#include "SDL++/Error.hpp"
+#include "SDL++/Lz.hpp"
+#include "SDL++/Parallel.hpp"
+#include "SDL++/ParkedSurface.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// Large enough for matches to find their references, small enough to
+	// give every thread a few blocks of a full-screen image.
+	constexpr size_t blockBytes = 256 * 1024;
+
+	std::atomic<size_t> s_residentBytes{0};
+	std::atomic<size_t> s_parkedBytes{0};
+	std::atomic<size_t> s_parkedPixelBytes{0};
+
+	void add(std::atomic<size_t> &total, size_t bytes, int sign)
+	{
+		if (sign > 0)
+			total.fetch_add(bytes, std::memory_order_relaxed);
+		else
+			total.fetch_sub(bytes, std::memory_order_relaxed);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+ParkedSurface::ParkedSurface(Surface surface, bool parkNow)
+: m_surface{std::move(surface)}
+{
+	SDL_Surface *s = m_surface.ptr();
+	m_width = s->w;
+	m_height = s->h;
+	m_depth = s->format->BitsPerPixel;
+	m_pitch = s->pitch;
+	m_format = s->format->format;
+	m_attributes = attributesOf(m_surface);
+
+	account(1);
+	if (parkNow)
+		park();
+}
+
+ParkedSurface::ParkedSurface(ParkedSurface &&other) noexcept
+{
+	*this = std::move(other);
+}
+
+ParkedSurface::~ParkedSurface()
+{
+	account(-1);
+}
+
+void ParkedSurface::park()
+{
+	if (isParked())
+		return;
+
+	m_attributes = attributesOf(m_surface);
+	const size_t pitch = static_cast<size_t>(m_pitch);
+	const int rows = static_cast<int>(std::max<size_t>(blockBytes / std::max<size_t>(pitch, 1), 1));
+	const int count = (m_height + rows - 1) / rows;
+	std::vector<std::vector<Uint8>> blocks(static_cast<size_t>(count));
+
+	{
+		auto lock = m_surface.lock();
+		const auto pixels = static_cast<const Uint8*>(lock.rawArray());
+		ThreadPool::shared().run(count, 1, [&](int b0, int b1) {
+			for (int b = b0; b < b1; ++b) {
+				const int y0 = b * rows;
+				const size_t size = pitch * static_cast<size_t>(std::min(rows, m_height - y0));
+				auto &block = blocks[static_cast<size_t>(b)];
+				block.resize(Lz::bound(size));
+				block.resize(Lz::compress(pixels + pitch * static_cast<size_t>(y0), size, block.data(), block.size()));
+				block.shrink_to_fit();
+			}
+		});
+	}
+
+	account(-1);
+	m_blocks = std::move(blocks);
+	m_blockRows = rows;
+	m_surface = Surface{nullptr};
+	account(1);
+}
+
+void ParkedSurface::unpark()
+{
+	if (!isParked())
+		return;
+
+	Surface s = decode();
+	account(-1);
+	m_surface = std::move(s);
+	m_blocks.clear();
+	m_blocks.shrink_to_fit();
+	account(1);
+}
+
+Surface ParkedSurface::copy() const
+{
+	if (isParked())
+		return decode();
+
+	Surface s = blank(attributesOf(m_surface));
+	auto src = m_surface.lock();
+	auto dst = s.lock();
+	const size_t rowBytes = static_cast<size_t>(m_width) * SDL_BYTESPERPIXEL(m_format);
+	for (int y = 0; y < m_height; ++y)
+		std::memcpy(static_cast<Uint8*>(dst.rawArray()) + static_cast<size_t>(y) * s.ptr()->pitch, static_cast<const Uint8*>(src.rawArray()) + static_cast<size_t>(y) * m_pitch, rowBytes);
+	return s;
+}
+
+size_t ParkedSurface::parkedBytes() const
+{
+	size_t bytes = 0;
+	for (const auto &block : m_blocks)
+		bytes += block.capacity();
+	return bytes;
+}
+
+ParkedSurface::Totals ParkedSurface::totals()
+{
+	Totals t;
+	t.residentBytes = s_residentBytes.load(std::memory_order_relaxed);
+	t.parkedBytes = s_parkedBytes.load(std::memory_order_relaxed);
+	t.parkedPixelBytes = s_parkedPixelBytes.load(std::memory_order_relaxed);
+	return t;
+}
+
+ParkedSurface &ParkedSurface::operator =(ParkedSurface &&other) noexcept
+{
+	if (this != &other) {
+		account(-1);
+		other.account(-1);
+		m_surface = std::move(other.m_surface);
+		m_blocks = std::move(other.m_blocks);
+		m_blockRows = other.m_blockRows;
+		m_width = other.m_width;
+		m_height = other.m_height;
+		m_depth = other.m_depth;
+		m_pitch = other.m_pitch;
+		m_format = other.m_format;
+		m_attributes = std::move(other.m_attributes);
+		other.m_blocks.clear();
+		other.m_height = 0;
+		account(1);
+	}
+	return *this;
+}
+
+void ParkedSurface::account(int sign) const
+{
+	if (isParked()) {
+		add(s_parkedBytes, parkedBytes(), sign);
+		add(s_parkedPixelBytes, pixelBytes(), sign);
+	} else {
+		add(s_residentBytes, pixelBytes(), sign);
+	}
+}
+
+ParkedSurface::Attributes ParkedSurface::attributesOf(const Surface &surface)
+{
+	SDL_Surface *s = surface.ptr();
+	Attributes a;
+	if (s->format->palette)
+		a.palette.assign(s->format->palette->colors, s->format->palette->colors + s->format->palette->ncolors);
+	a.hasColorKey = SDL_GetColorKey(s, &a.colorKey) == 0;
+	a.blendMode = surface.blendMode();
+	a.colorAlphaMod = surface.colorAlphaMod();
+	return a;
+}
+
+Surface ParkedSurface::blank(const Attributes &attributes) const
+{
+	Surface s{m_width, m_height, m_depth, m_format};
+	if (!attributes.palette.empty() && SDL_SetPaletteColors(s.ptr()->format->palette, attributes.palette.data(), 0, static_cast<int>(attributes.palette.size())) != 0)
+		SDLPP_THROW(Exception{"SDL_SetPaletteColors"});
+	if (attributes.hasColorKey)
+		s.setColorKey(attributes.colorKey);
+	s.setBlendMode(attributes.blendMode);
+	s.setColorAlphaMod(attributes.colorAlphaMod);
+	return s;
+}
+
+Surface ParkedSurface::decode() const
+{
+	Surface s = blank(m_attributes);
+	auto lock = s.lock();
+	const auto pixels = static_cast<Uint8*>(lock.rawArray());
+	const size_t pitch = static_cast<size_t>(m_pitch);
+	const size_t dstPitch = static_cast<size_t>(s.ptr()->pitch);
+	const size_t rowBytes = std::min(pitch, dstPitch);
+
+	ThreadPool::shared().run(static_cast<int>(m_blocks.size()), 1, [&](int b0, int b1) {
+		std::vector<Uint8> scratch;
+		for (int b = b0; b < b1; ++b) {
+			const int y0 = b * m_blockRows;
+			const int n = std::min(m_blockRows, m_height - y0);
+			const size_t size = pitch * static_cast<size_t>(n);
+			const auto &block = m_blocks[static_cast<size_t>(b)];
+
+			// Surfaces created from user memory may have had a wider pitch
+			// than the one SDL picks for the restored surface.
+			Uint8 *out = pixels + dstPitch * static_cast<size_t>(y0);
+			if (pitch != dstPitch) {
+				scratch.resize(size);
+				out = scratch.data();
+			}
+			if (!Lz::decompress(block.data(), block.size(), out, size)) {
+				Error::set("Corrupted parked surface data");
+				SDLPP_THROW(Exception{"Lz::decompress"});
+			}
+			if (pitch != dstPitch)
+				for (int y = 0; y < n; ++y)
+					std::memcpy(pixels + dstPitch * static_cast<size_t>(y0 + y), out + pitch * static_cast<size_t>(y), rowBytes);
+		}
+	});
+	return s;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,1147 @@
+/*
+** SDL++, 2020
+** PixelKernels.cpp
+*/
+
+#include "SDL++/Parallel.hpp"
+#include "SDL++/PixelKernels.hpp"
+#include "Simd.hpp"
+
+#include <SDL2/SDL_cpuinfo.h>
+#include <SDL2/SDL_endian.h>
+#include <SDL2/SDL_pixels.h>
+#include <SDL2/SDL_version.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL::Kernels
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr Uint32 alphaMask = 0xFF000000u;
+
+	// Pixel layouts as seen through a native Uint32:
+	// - "Swap" exchanges bits 0-7 and 16-23 (ARGB8888 <-> ABGR8888),
+	// - "Low" packs/unpacks the three low bytes in memory order,
+	// - "Rev" does the same with the byte order reversed.
+	// Division by 255 is (t + (t >> 8)) >> 8 with t = x + 128 everywhere, so
+	// every instruction set produces bit-identical results.
+
+	////////////////////////////////////////////////////////////////////////////
+	// Scalar
+
+	template<bool Swap, bool SetAlpha>
+	void convert32Scalar(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint32*>(src);
+		auto d = static_cast<Uint32*>(dst);
+		for (int i = 0; i < n; ++i) {
+			Uint32 p = s[i];
+			if constexpr (Swap)
+				p = (p & 0xFF00FF00u) | ((p >> 16) & 0xFFu) | ((p & 0xFFu) << 16);
+			if constexpr (SetAlpha)
+				p |= alphaMask;
+			d[i] = p;
+		}
+	}
+
+	template<bool Rev>
+	void pack24Scalar(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint32*>(src);
+		auto d = static_cast<Uint8*>(dst);
+		for (int i = 0; i < n; ++i, d += 3) {
+			const Uint32 p = s[i];
+			d[Rev ? 2 : 0] = static_cast<Uint8>(p);
+			d[1] = static_cast<Uint8>(p >> 8);
+			d[Rev ? 0 : 2] = static_cast<Uint8>(p >> 16);
+		}
+	}
+
+	template<bool Rev>
+	void unpack24Scalar(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint8*>(src);
+		auto d = static_cast<Uint32*>(dst);
+		for (int i = 0; i < n; ++i, s += 3) {
+			if constexpr (Rev)
+				d[i] = alphaMask | Uint32{s[0]} << 16 | Uint32{s[1]} << 8 | s[2];
+			else
+				d[i] = alphaMask | Uint32{s[2]} << 16 | Uint32{s[1]} << 8 | s[0];
+		}
+	}
+
+	inline Uint32 div255(Uint32 x)
+	{
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+
+	void blendScalar(const Uint32 *src, Uint32 *dst, int n)
+	{
+		for (int i = 0; i < n; ++i) {
+			const Uint32 s = src[i] | alphaMask;
+			const Uint32 a = src[i] >> 24;
+			if (a == 0)
+				continue;
+			if (a == 255) {
+				dst[i] = s;
+				continue;
+			}
+
+			const Uint32 d = dst[i];
+			Uint32 out = 0;
+			for (int shift = 0; shift < 32; shift += 8) {
+				const Uint32 sc = (s >> shift) & 0xFF;
+				const Uint32 dc = (d >> shift) & 0xFF;
+				out |= div255(sc * a + dc * (255 - a)) << shift;
+			}
+			dst[i] = out;
+		}
+	}
+
+	void premultiplyScalar(const Uint32 *src, Uint32 *dst, int n)
+	{
+		for (int i = 0; i < n; ++i) {
+			const Uint32 p = src[i];
+			const Uint32 a = p >> 24;
+			Uint32 out = p & alphaMask;
+			for (int shift = 0; shift < 24; shift += 8)
+				out |= div255(((p >> shift) & 0xFF) * a) << shift;
+			dst[i] = out;
+		}
+	}
+
+	// Unpremultiplying divides in single precision (c * 255 / a, rounded to
+	// nearest even), which the SIMD versions reproduce exactly.
+	void unpremultiplyScalar(const Uint32 *src, Uint32 *dst, int n)
+	{
+		for (int i = 0; i < n; ++i) {
+			const Uint32 p = src[i];
+			const Uint32 a = p >> 24;
+			if (a == 0 || a == 255) {
+				dst[i] = a == 0 ? 0 : p;
+				continue;
+			}
+
+			Uint32 out = p & alphaMask;
+			for (int shift = 0; shift < 24; shift += 8) {
+				const float c = static_cast<float>((p >> shift) & 0xFF);
+				const long v = std::lrint(c * 255.0f / static_cast<float>(a));
+				out |= static_cast<Uint32>(std::min(v, 255L)) << shift;
+			}
+			dst[i] = out;
+		}
+	}
+
+	void blendPremultipliedScalar(const Uint32 *src, Uint32 *dst, int n)
+	{
+		for (int i = 0; i < n; ++i) {
+			const Uint32 s = src[i];
+			const Uint32 ia = 255 - (s >> 24);
+			if (s == 0)
+				continue;
+			if (ia == 0) {
+				dst[i] = s;
+				continue;
+			}
+
+			const Uint32 d = dst[i];
+			Uint32 out = 0;
+			for (int shift = 0; shift < 32; shift += 8) {
+				const Uint32 sc = (s >> shift) & 0xFF;
+				const Uint32 dc = (d >> shift) & 0xFF;
+				out |= std::min(sc + div255(dc * ia), 255u) << shift;
+			}
+			dst[i] = out;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// x86
+
+#if defined(SDLPP_KERNELS_X86)
+
+	template<bool Swap, bool SetAlpha>
+	SDLPP_TARGET("sse2") void convert32SSE2(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint32*>(src);
+		auto d = static_cast<Uint32*>(dst);
+		const __m128i keep = _mm_set1_epi32(Swap ? 0xFF00FF00 : -1);
+		const __m128i low = _mm_set1_epi32(0xFF);
+		const __m128i alpha = _mm_set1_epi32(SetAlpha ? int(alphaMask) : 0);
+
+		int i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+			if constexpr (Swap) {
+				const __m128i r = _mm_and_si128(_mm_srli_epi32(p, 16), low);
+				const __m128i b = _mm_slli_epi32(_mm_and_si128(p, low), 16);
+				p = _mm_or_si128(_mm_and_si128(p, keep), _mm_or_si128(r, b));
+			}
+			p = _mm_or_si128(p, alpha);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), p);
+		}
+		convert32Scalar<Swap, SetAlpha>(s + i, d + i, n - i);
+	}
+
+	template<bool Swap, bool SetAlpha>
+	SDLPP_TARGET("avx2") void convert32AVX2(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint32*>(src);
+		auto d = static_cast<Uint32*>(dst);
+		const __m256i keep = _mm256_set1_epi32(Swap ? 0xFF00FF00 : -1);
+		const __m256i low = _mm256_set1_epi32(0xFF);
+		const __m256i alpha = _mm256_set1_epi32(SetAlpha ? int(alphaMask) : 0);
+
+		int i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+			if constexpr (Swap) {
+				const __m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 16), low);
+				const __m256i b = _mm256_slli_epi32(_mm256_and_si256(p, low), 16);
+				p = _mm256_or_si256(_mm256_and_si256(p, keep), _mm256_or_si256(r, b));
+			}
+			p = _mm256_or_si256(p, alpha);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), p);
+		}
+		convert32SSE2<Swap, SetAlpha>(s + i, d + i, n - i);
+	}
+
+	template<bool Rev>
+	SDLPP_TARGET("ssse3") __m128i pack24Mask()
+	{
+		return Rev
+			? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+			: _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	}
+
+	template<bool Rev>
+	SDLPP_TARGET("ssse3") __m128i unpack24Mask()
+	{
+		return Rev
+			? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+			: _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	}
+
+	// The 24-bit loops move 16 bytes for 12 useful ones, so they stop while
+	// at least 6 pixels (18 bytes) remain and leave the tail to scalar code.
+
+	template<bool Rev>
+	SDLPP_TARGET("ssse3") void pack24SSSE3(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint32*>(src);
+		auto d = static_cast<Uint8*>(dst);
+		const __m128i mask = pack24Mask<Rev>();
+
+		int i = 0;
+		for (; i + 6 <= n; i += 4) {
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(d + 3 * i), _mm_shuffle_epi8(p, mask));
+		}
+		pack24Scalar<Rev>(s + i, d + 3 * i, n - i);
+	}
+
+	template<bool Rev>
+	SDLPP_TARGET("ssse3") void unpack24SSSE3(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint8*>(src);
+		auto d = static_cast<Uint32*>(dst);
+		const __m128i mask = unpack24Mask<Rev>();
+		const __m128i alpha = _mm_set1_epi32(int(alphaMask));
+
+		int i = 0;
+		for (; i + 6 <= n; i += 4) {
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 3 * i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_or_si128(_mm_shuffle_epi8(p, mask), alpha));
+		}
+		unpack24Scalar<Rev>(s + 3 * i, d + i, n - i);
+	}
+
+	// AVX2 shuffles within 128-bit lanes; a cross-lane dword permute packs the
+	// two 12-byte halves together (or spreads them apart when unpacking).
+	// 32 bytes are moved per 8 pixels, hence the 11 pixel margin.
+
+	template<bool Rev>
+	SDLPP_TARGET("avx2") void pack24AVX2(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint32*>(src);
+		auto d = static_cast<Uint8*>(dst);
+		const __m256i mask = _mm256_broadcastsi128_si256(pack24Mask<Rev>());
+		const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+		int i = 0;
+		for (; i + 11 <= n; i += 8) {
+			const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+			const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(p, mask), compact);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 3 * i), packed);
+		}
+		pack24SSSE3<Rev>(s + i, d + 3 * i, n - i);
+	}
+
+	template<bool Rev>
+	SDLPP_TARGET("avx2") void unpack24AVX2(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint8*>(src);
+		auto d = static_cast<Uint32*>(dst);
+		const __m256i mask = _mm256_broadcastsi128_si256(unpack24Mask<Rev>());
+		const __m256i spread = _mm256_setr_epi32(0, 1, 2, 2, 3, 4, 5, 5);
+		const __m256i alpha = _mm256_set1_epi32(int(alphaMask));
+
+		int i = 0;
+		for (; i + 11 <= n; i += 8) {
+			const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 3 * i));
+			const __m256i lanes = _mm256_permutevar8x32_epi32(p, spread);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_or_si256(_mm256_shuffle_epi8(lanes, mask), alpha));
+		}
+		unpack24SSSE3<Rev>(s + 3 * i, d + i, n - i);
+	}
+
+	SDLPP_TARGET("sse2") inline __m128i blend2SSE2(__m128i s, __m128i d, __m128i full, __m128i round)
+	{
+		// Two pixels as 8 x 16-bit lanes; the alpha lane is broadcast per pixel.
+		const __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		const __m128i sv = _mm_or_si128(s, _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255));
+		__m128i x = _mm_add_epi16(_mm_mullo_epi16(sv, a), _mm_mullo_epi16(d, _mm_sub_epi16(full, a)));
+		x = _mm_add_epi16(x, round);
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+
+	SDLPP_TARGET("sse2") void blendSSE2(const Uint32 *src, Uint32 *dst, int n)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i full = _mm_set1_epi16(255);
+		const __m128i round = _mm_set1_epi16(128);
+		const __m128i amask = _mm_set1_epi32(int(alphaMask));
+
+		int i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i sa = _mm_and_si128(s, amask);
+			const int opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(sa, amask));
+			if (opaque == 0xFFFF) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+				continue;
+			}
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(sa, zero)) == 0xFFFF)
+				continue;
+
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+			const __m128i lo = blend2SSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), full, round);
+			const __m128i hi = blend2SSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), full, round);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+		}
+		blendScalar(src + i, dst + i, n - i);
+	}
+
+	SDLPP_TARGET("sse2") inline __m128i div255SSE2(__m128i x, __m128i round)
+	{
+		x = _mm_add_epi16(x, round);
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+
+	SDLPP_TARGET("sse2") inline __m128i broadcastAlphaSSE2(__m128i p)
+	{
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(p, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	SDLPP_TARGET("sse2") void premultiplySSE2(const Uint32 *src, Uint32 *dst, int n)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i round = _mm_set1_epi16(128);
+		// The alpha lane is multiplied by 255, which div255 maps back exactly.
+		const __m128i keepAlpha = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+
+		int i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i lo = _mm_unpacklo_epi8(p, zero);
+			const __m128i hi = _mm_unpackhi_epi8(p, zero);
+			const __m128i alo = _mm_or_si128(broadcastAlphaSSE2(lo), keepAlpha);
+			const __m128i ahi = _mm_or_si128(broadcastAlphaSSE2(hi), keepAlpha);
+			const __m128i rlo = div255SSE2(_mm_mullo_epi16(lo, alo), round);
+			const __m128i rhi = div255SSE2(_mm_mullo_epi16(hi, ahi), round);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(rlo, rhi));
+		}
+		premultiplyScalar(src + i, dst + i, n - i);
+	}
+
+	SDLPP_TARGET("sse2") inline __m128i unpremultiplyChannelSSE2(__m128i c, __m128 scale)
+	{
+		const __m128i v = _mm_cvtps_epi32(_mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), _mm_set1_ps(255.0f)), scale));
+		const __m128i over = _mm_cmpgt_epi32(v, _mm_set1_epi32(255));
+		return _mm_or_si128(_mm_andnot_si128(over, v), _mm_and_si128(over, _mm_set1_epi32(255)));
+	}
+
+	SDLPP_TARGET("sse2") void unpremultiplySSE2(const Uint32 *src, Uint32 *dst, int n)
+	{
+		const __m128i low = _mm_set1_epi32(0xFF);
+
+		int i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			const __m128i a = _mm_srli_epi32(p, 24);
+			// Lanes with a == 0 divide by zero and are cleared afterwards.
+			const __m128 scale = _mm_cvtepi32_ps(a);
+			const __m128i c0 = unpremultiplyChannelSSE2(_mm_and_si128(p, low), scale);
+			const __m128i c1 = unpremultiplyChannelSSE2(_mm_and_si128(_mm_srli_epi32(p, 8), low), scale);
+			const __m128i c2 = unpremultiplyChannelSSE2(_mm_and_si128(_mm_srli_epi32(p, 16), low), scale);
+
+			__m128i out = _mm_or_si128(_mm_or_si128(c0, _mm_slli_epi32(c1, 8)), _mm_or_si128(_mm_slli_epi32(c2, 16), _mm_slli_epi32(a, 24)));
+			out = _mm_andnot_si128(_mm_cmpeq_epi32(a, _mm_setzero_si128()), out);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+		}
+		unpremultiplyScalar(src + i, dst + i, n - i);
+	}
+
+	SDLPP_TARGET("sse2") void blendPremultipliedSSE2(const Uint32 *src, Uint32 *dst, int n)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i full = _mm_set1_epi16(255);
+		const __m128i round = _mm_set1_epi16(128);
+		const __m128i amask = _mm_set1_epi32(int(alphaMask));
+
+		int i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, amask), amask)) == 0xFFFF) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), s);
+				continue;
+			}
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(s, zero)) == 0xFFFF)
+				continue;
+
+			const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+			const __m128i slo = _mm_unpacklo_epi8(s, zero), shi = _mm_unpackhi_epi8(s, zero);
+			const __m128i dlo = _mm_unpacklo_epi8(d, zero), dhi = _mm_unpackhi_epi8(d, zero);
+			const __m128i lo = _mm_add_epi16(slo, div255SSE2(_mm_mullo_epi16(dlo, _mm_sub_epi16(full, broadcastAlphaSSE2(slo))), round));
+			const __m128i hi = _mm_add_epi16(shi, div255SSE2(_mm_mullo_epi16(dhi, _mm_sub_epi16(full, broadcastAlphaSSE2(shi))), round));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+		}
+		blendPremultipliedScalar(src + i, dst + i, n - i);
+	}
+
+	SDLPP_TARGET("avx2") inline __m256i blend2AVX2(__m256i s, __m256i d, __m256i full, __m256i round, __m256i alphaLane)
+	{
+		const __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		const __m256i sv = _mm256_or_si256(s, alphaLane);
+		__m256i x = _mm256_add_epi16(_mm256_mullo_epi16(sv, a), _mm256_mullo_epi16(d, _mm256_sub_epi16(full, a)));
+		x = _mm256_add_epi16(x, round);
+		return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+	}
+
+	SDLPP_TARGET("avx2") void blendAVX2(const Uint32 *src, Uint32 *dst, int n)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i full = _mm256_set1_epi16(255);
+		const __m256i round = _mm256_set1_epi16(128);
+		const __m256i amask = _mm256_set1_epi32(int(alphaMask));
+		const __m256i alphaLane = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+
+		int i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			const __m256i sa = _mm256_and_si256(s, amask);
+			if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(sa, amask)) == -1) {
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+				continue;
+			}
+			if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(sa, zero)) == -1)
+				continue;
+
+			// unpack/pack work per 128-bit lane, so pixel order is preserved.
+			const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+			const __m256i lo = blend2AVX2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), full, round, alphaLane);
+			const __m256i hi = blend2AVX2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), full, round, alphaLane);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+		}
+		blendSSE2(src + i, dst + i, n - i);
+	}
+
+	SDLPP_TARGET("avx2") inline __m256i div255AVX2(__m256i x, __m256i round)
+	{
+		x = _mm256_add_epi16(x, round);
+		return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+	}
+
+	SDLPP_TARGET("avx2") inline __m256i broadcastAlphaAVX2(__m256i p)
+	{
+		return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(p, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	}
+
+	SDLPP_TARGET("avx2") void premultiplyAVX2(const Uint32 *src, Uint32 *dst, int n)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i round = _mm256_set1_epi16(128);
+		const __m256i keepAlpha = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+
+		int i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			const __m256i lo = _mm256_unpacklo_epi8(p, zero);
+			const __m256i hi = _mm256_unpackhi_epi8(p, zero);
+			const __m256i rlo = div255AVX2(_mm256_mullo_epi16(lo, _mm256_or_si256(broadcastAlphaAVX2(lo), keepAlpha)), round);
+			const __m256i rhi = div255AVX2(_mm256_mullo_epi16(hi, _mm256_or_si256(broadcastAlphaAVX2(hi), keepAlpha)), round);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(rlo, rhi));
+		}
+		premultiplySSE2(src + i, dst + i, n - i);
+	}
+
+	SDLPP_TARGET("avx2") inline __m256i unpremultiplyChannelAVX2(__m256i c, __m256 scale)
+	{
+		const __m256i v = _mm256_cvtps_epi32(_mm256_div_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(c), _mm256_set1_ps(255.0f)), scale));
+		return _mm256_min_epi32(v, _mm256_set1_epi32(255));
+	}
+
+	SDLPP_TARGET("avx2") void unpremultiplyAVX2(const Uint32 *src, Uint32 *dst, int n)
+	{
+		const __m256i low = _mm256_set1_epi32(0xFF);
+
+		int i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			const __m256i a = _mm256_srli_epi32(p, 24);
+			const __m256 scale = _mm256_cvtepi32_ps(a);
+			const __m256i c0 = unpremultiplyChannelAVX2(_mm256_and_si256(p, low), scale);
+			const __m256i c1 = unpremultiplyChannelAVX2(_mm256_and_si256(_mm256_srli_epi32(p, 8), low), scale);
+			const __m256i c2 = unpremultiplyChannelAVX2(_mm256_and_si256(_mm256_srli_epi32(p, 16), low), scale);
+
+			__m256i out = _mm256_or_si256(_mm256_or_si256(c0, _mm256_slli_epi32(c1, 8)), _mm256_or_si256(_mm256_slli_epi32(c2, 16), _mm256_slli_epi32(a, 24)));
+			out = _mm256_andnot_si256(_mm256_cmpeq_epi32(a, _mm256_setzero_si256()), out);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+		}
+		unpremultiplySSE2(src + i, dst + i, n - i);
+	}
+
+	SDLPP_TARGET("avx2") void blendPremultipliedAVX2(const Uint32 *src, Uint32 *dst, int n)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i full = _mm256_set1_epi16(255);
+		const __m256i round = _mm256_set1_epi16(128);
+		const __m256i amask = _mm256_set1_epi32(int(alphaMask));
+
+		int i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(s, amask), amask)) == -1) {
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), s);
+				continue;
+			}
+			if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(s, zero)) == -1)
+				continue;
+
+			const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+			const __m256i slo = _mm256_unpacklo_epi8(s, zero), shi = _mm256_unpackhi_epi8(s, zero);
+			const __m256i dlo = _mm256_unpacklo_epi8(d, zero), dhi = _mm256_unpackhi_epi8(d, zero);
+			const __m256i lo = _mm256_add_epi16(slo, div255AVX2(_mm256_mullo_epi16(dlo, _mm256_sub_epi16(full, broadcastAlphaAVX2(slo))), round));
+			const __m256i hi = _mm256_add_epi16(shi, div255AVX2(_mm256_mullo_epi16(dhi, _mm256_sub_epi16(full, broadcastAlphaAVX2(shi))), round));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+		}
+		blendPremultipliedSSE2(src + i, dst + i, n - i);
+	}
+
+#endif
+
+	////////////////////////////////////////////////////////////////////////////
+	// NEON
+
+#if defined(SDLPP_KERNELS_NEON)
+
+	template<bool Swap, bool SetAlpha>
+	void convert32NEON(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint8*>(src);
+		auto d = static_cast<Uint8*>(dst);
+
+		int i = 0;
+		for (; i + 16 <= n; i += 16) {
+			uint8x16x4_t p = vld4q_u8(s + 4 * i);
+			if constexpr (Swap) {
+				const uint8x16_t t = p.val[0];
+				p.val[0] = p.val[2];
+				p.val[2] = t;
+			}
+			if constexpr (SetAlpha)
+				p.val[3] = vdupq_n_u8(255);
+			vst4q_u8(d + 4 * i, p);
+		}
+		convert32Scalar<Swap, SetAlpha>(s + 4 * i, d + 4 * i, n - i);
+	}
+
+	template<bool Rev>
+	void pack24NEON(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint8*>(src);
+		auto d = static_cast<Uint8*>(dst);
+
+		int i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const uint8x16x4_t p = vld4q_u8(s + 4 * i);
+			uint8x16x3_t o;
+			o.val[0] = p.val[Rev ? 2 : 0];
+			o.val[1] = p.val[1];
+			o.val[2] = p.val[Rev ? 0 : 2];
+			vst3q_u8(d + 3 * i, o);
+		}
+		pack24Scalar<Rev>(s + 4 * i, d + 3 * i, n - i);
+	}
+
+	template<bool Rev>
+	void unpack24NEON(const void *src, void *dst, int n)
+	{
+		auto s = static_cast<const Uint8*>(src);
+		auto d = static_cast<Uint8*>(dst);
+
+		int i = 0;
+		for (; i + 16 <= n; i += 16) {
+			const uint8x16x3_t p = vld3q_u8(s + 3 * i);
+			uint8x16x4_t o;
+			o.val[0] = p.val[Rev ? 2 : 0];
+			o.val[1] = p.val[1];
+			o.val[2] = p.val[Rev ? 0 : 2];
+			o.val[3] = vdupq_n_u8(255);
+			vst4q_u8(d + 4 * i, o);
+		}
+		unpack24Scalar<Rev>(s + 3 * i, d + 4 * i, n - i);
+	}
+
+	inline uint8x8_t blendChannelNEON(uint8x8_t s, uint8x8_t d, uint8x8_t a, uint8x8_t ia)
+	{
+		const uint16x8_t x = vmlal_u8(vmull_u8(s, a), d, ia);
+		return vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8);
+	}
+
+	void blendNEON(const Uint32 *src, Uint32 *dst, int n)
+	{
+		auto s8 = reinterpret_cast<const Uint8*>(src);
+		auto d8 = reinterpret_cast<Uint8*>(dst);
+		const uint8x8_t full = vdup_n_u8(255);
+
+		int i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const uint8x8x4_t s = vld4_u8(s8 + 4 * i);
+			uint8x8x4_t d = vld4_u8(d8 + 4 * i);
+			const uint8x8_t a = s.val[3];
+			const uint8x8_t ia = vsub_u8(full, a);
+			d.val[0] = blendChannelNEON(s.val[0], d.val[0], a, ia);
+			d.val[1] = blendChannelNEON(s.val[1], d.val[1], a, ia);
+			d.val[2] = blendChannelNEON(s.val[2], d.val[2], a, ia);
+			d.val[3] = blendChannelNEON(full, d.val[3], a, ia);
+			vst4_u8(d8 + 4 * i, d);
+		}
+		blendScalar(src + i, dst + i, n - i);
+	}
+
+	inline uint8x8_t div255NEON(uint16x8_t x)
+	{
+		return vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8);
+	}
+
+	void premultiplyNEON(const Uint32 *src, Uint32 *dst, int n)
+	{
+		auto s8 = reinterpret_cast<const Uint8*>(src);
+		auto d8 = reinterpret_cast<Uint8*>(dst);
+
+		int i = 0;
+		for (; i + 8 <= n; i += 8) {
+			uint8x8x4_t p = vld4_u8(s8 + 4 * i);
+			const uint8x8_t a = p.val[3];
+			p.val[0] = div255NEON(vmull_u8(p.val[0], a));
+			p.val[1] = div255NEON(vmull_u8(p.val[1], a));
+			p.val[2] = div255NEON(vmull_u8(p.val[2], a));
+			vst4_u8(d8 + 4 * i, p);
+		}
+		premultiplyScalar(src + i, dst + i, n - i);
+	}
+
+	void blendPremultipliedNEON(const Uint32 *src, Uint32 *dst, int n)
+	{
+		auto s8 = reinterpret_cast<const Uint8*>(src);
+		auto d8 = reinterpret_cast<Uint8*>(dst);
+		const uint8x8_t full = vdup_n_u8(255);
+
+		int i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const uint8x8x4_t s = vld4_u8(s8 + 4 * i);
+			uint8x8x4_t d = vld4_u8(d8 + 4 * i);
+			const uint8x8_t ia = vsub_u8(full, s.val[3]);
+			for (int c = 0; c < 4; ++c)
+				d.val[c] = vqadd_u8(s.val[c], div255NEON(vmull_u8(d.val[c], ia)));
+			vst4_u8(d8 + 4 * i, d);
+		}
+		blendPremultipliedScalar(src + i, dst + i, n - i);
+	}
+
+#endif
+
+	////////////////////////////////////////////////////////////////////////////
+	// Dispatch
+
+	enum Kind
+	{
+		Swap,
+		SetAlpha,
+		SwapSetAlpha,
+		PackLow,
+		PackRev,
+		UnpackLow,
+		UnpackRev,
+		KindCount
+	};
+
+	struct Table
+	{
+		RowConverter convert[KindCount];
+		RowBlender blend;
+		RowBlender blendPremultiplied;
+		RowBlender premultiply;
+		RowBlender unpremultiply;
+	};
+
+	const Table scalarTable = {
+		{
+			convert32Scalar<true, false>, convert32Scalar<false, true>, convert32Scalar<true, true>,
+			pack24Scalar<false>, pack24Scalar<true>, unpack24Scalar<false>, unpack24Scalar<true>,
+		},
+		blendScalar,
+		blendPremultipliedScalar,
+		premultiplyScalar,
+		unpremultiplyScalar,
+	};
+
+#if defined(SDLPP_KERNELS_X86)
+	const Table sse2Table = {
+		{
+			convert32SSE2<true, false>, convert32SSE2<false, true>, convert32SSE2<true, true>,
+			pack24Scalar<false>, pack24Scalar<true>, unpack24Scalar<false>, unpack24Scalar<true>,
+		},
+		blendSSE2,
+		blendPremultipliedSSE2,
+		premultiplySSE2,
+		unpremultiplySSE2,
+	};
+
+	const Table sse41Table = {
+		{
+			convert32SSE2<true, false>, convert32SSE2<false, true>, convert32SSE2<true, true>,
+			pack24SSSE3<false>, pack24SSSE3<true>, unpack24SSSE3<false>, unpack24SSSE3<true>,
+		},
+		blendSSE2,
+		blendPremultipliedSSE2,
+		premultiplySSE2,
+		unpremultiplySSE2,
+	};
+
+	const Table avx2Table = {
+		{
+			convert32AVX2<true, false>, convert32AVX2<false, true>, convert32AVX2<true, true>,
+			pack24AVX2<false>, pack24AVX2<true>, unpack24AVX2<false>, unpack24AVX2<true>,
+		},
+		blendAVX2,
+		blendPremultipliedAVX2,
+		premultiplyAVX2,
+		unpremultiplyAVX2,
+	};
+#endif
+
+#if defined(SDLPP_KERNELS_NEON)
+	const Table neonTable = {
+		{
+			convert32NEON<true, false>, convert32NEON<false, true>, convert32NEON<true, true>,
+			pack24NEON<false>, pack24NEON<true>, unpack24NEON<false>, unpack24NEON<true>,
+		},
+		blendNEON,
+		blendPremultipliedNEON,
+		premultiplyNEON,
+		unpremultiplyScalar,
+	};
+#endif
+
+	const Table &tableFor(Isa isa)
+	{
+		switch (isa) {
+#if defined(SDLPP_KERNELS_X86)
+		case Isa::AVX2:  return avx2Table;
+		case Isa::SSE41: return sse41Table;
+		case Isa::SSE2:  return sse2Table;
+#endif
+#if defined(SDLPP_KERNELS_NEON)
+		case Isa::NEON:  return neonTable;
+#endif
+		default:         return scalarTable;
+		}
+	}
+
+	std::atomic<int> &selectedIsa()
+	{
+		static std::atomic<int> selected{static_cast<int>(bestIsa())};
+		return selected;
+	}
+
+	const Table &table()
+	{
+		return tableFor(static_cast<Isa>(selectedIsa().load(std::memory_order_relaxed)));
+	}
+
+	int kindFor(Uint32 from, Uint32 to)
+	{
+		const bool fromXRGB = from == SDL_PIXELFORMAT_XRGB8888;
+		if (fromXRGB)
+			from = SDL_PIXELFORMAT_ARGB8888;
+
+		switch (from) {
+		case SDL_PIXELFORMAT_ARGB8888:
+			switch (to) {
+			case SDL_PIXELFORMAT_ARGB8888: return fromXRGB ? SetAlpha : -1;
+			case SDL_PIXELFORMAT_ABGR8888: return fromXRGB ? SwapSetAlpha : Swap;
+			case SDL_PIXELFORMAT_RGB24:    return PackRev;
+			case SDL_PIXELFORMAT_BGR24:    return PackLow;
+			}
+			break;
+		case SDL_PIXELFORMAT_ABGR8888:
+			switch (to) {
+			case SDL_PIXELFORMAT_ARGB8888: return Swap;
+			case SDL_PIXELFORMAT_RGB24:    return PackLow;
+			case SDL_PIXELFORMAT_BGR24:    return PackRev;
+			}
+			break;
+		case SDL_PIXELFORMAT_RGB24:
+			switch (to) {
+			case SDL_PIXELFORMAT_ARGB8888: return UnpackRev;
+			case SDL_PIXELFORMAT_ABGR8888: return UnpackLow;
+			}
+			break;
+		case SDL_PIXELFORMAT_BGR24:
+			switch (to) {
+			case SDL_PIXELFORMAT_ARGB8888: return UnpackLow;
+			case SDL_PIXELFORMAT_ABGR8888: return UnpackRev;
+			}
+			break;
+		}
+		return -1;
+	}
+
+	bool neutralModulation(SDL_Surface *s)
+	{
+		Uint8 r = 0, g = 0, b = 0, a = 0;
+		SDL_GetSurfaceColorMod(s, &r, &g, &b);
+		SDL_GetSurfaceAlphaMod(s, &a);
+		return r == 255 && g == 255 && b == 255 && a == 255;
+	}
+
+	bool hasColorKey(SDL_Surface *s)
+	{
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+		return SDL_HasColorKey(s) == SDL_TRUE;
+#else
+		Uint32 key;
+		return SDL_GetColorKey(s, &key) == 0;
+#endif
+	}
+
+	bool alphaTopByte(Uint32 format)
+	{
+		return format == SDL_PIXELFORMAT_ARGB8888 || format == SDL_PIXELFORMAT_ABGR8888;
+	}
+
+	/// Same-format 32-bit surfaces with alpha in the top byte, no color key
+	/// and no modulation.
+	bool blendable(SDL_Surface *src, SDL_Surface *dst)
+	{
+		if (!src || !dst || src == dst)
+			return false;
+		if (src->format->format != dst->format->format || !alphaTopByte(src->format->format))
+			return false;
+		return !SDL_MUSTLOCK(src) && !SDL_MUSTLOCK(dst) && !hasColorKey(src) && neutralModulation(src);
+	}
+
+	void blendRows(SDL_Surface *src, const SDL_Rect *srcRect, SDL_Surface *dst, const SDL_Rect *dstRect, RowBlender blend)
+	{
+		// Same clipping as SDL_UpperBlit: source rect against the source bounds,
+		// then destination against the destination clip rect.
+		int sx = 0, sy = 0, w = src->w, h = src->h;
+		int dx = dstRect ? dstRect->x : 0;
+		int dy = dstRect ? dstRect->y : 0;
+
+		if (srcRect) {
+			sx = srcRect->x;
+			sy = srcRect->y;
+			w = srcRect->w;
+			h = srcRect->h;
+			if (sx < 0) {
+				w += sx;
+				dx -= sx;
+				sx = 0;
+			}
+			if (sy < 0) {
+				h += sy;
+				dy -= sy;
+				sy = 0;
+			}
+			w = SDL_min(w, src->w - sx);
+			h = SDL_min(h, src->h - sy);
+		}
+
+		const SDL_Rect &clip = dst->clip_rect;
+		if (const int d = clip.x - dx; d > 0) {
+			w -= d;
+			dx += d;
+			sx += d;
+		}
+		if (const int d = dx + w - clip.x - clip.w; d > 0)
+			w -= d;
+		if (const int d = clip.y - dy; d > 0) {
+			h -= d;
+			dy += d;
+			sy += d;
+		}
+		if (const int d = dy + h - clip.y - clip.h; d > 0)
+			h -= d;
+
+		if (w <= 0 || h <= 0)
+			return;
+
+		Parallel::forRows(h, w * 4, [&](int y0, int y1) {
+			for (int y = y0; y < y1; ++y) {
+				auto s = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(src->pixels) + static_cast<ptrdiff_t>(sy + y) * src->pitch) + sx;
+				auto d = reinterpret_cast<Uint32*>(static_cast<Uint8*>(dst->pixels) + static_cast<ptrdiff_t>(dy + y) * dst->pitch) + dx;
+				blend(s, d, w);
+			}
+		});
+	}
+
+	bool applyInPlace(SDL_Surface *surface, RowBlender fn)
+	{
+		if (!surface || !alphaTopByte(surface->format->format) || SDL_MUSTLOCK(surface))
+			return false;
+
+		Parallel::forRows(surface->h, surface->pitch, [&](int y0, int y1) {
+			for (int y = y0; y < y1; ++y) {
+				auto row = reinterpret_cast<Uint32*>(static_cast<Uint8*>(surface->pixels) + static_cast<ptrdiff_t>(y) * surface->pitch);
+				fn(row, row, surface->w);
+			}
+		});
+		return true;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Isa bestIsa()
+{
+#if defined(SDLPP_KERNELS_X86)
+	if (SDL_HasAVX2())
+		return Isa::AVX2;
+	if (SDL_HasSSE41())
+		return Isa::SSE41;
+	if (SDL_HasSSE2())
+		return Isa::SSE2;
+#elif defined(SDLPP_KERNELS_NEON)
+	if (SDL_HasNEON())
+		return Isa::NEON;
+#endif
+	return Isa::Scalar;
+}
+
+Isa isa()
+{
+	return static_cast<Isa>(selectedIsa().load(std::memory_order_relaxed));
+}
+
+void setIsa(Isa requested)
+{
+	const Isa best = bestIsa();
+	const bool supported = best == Isa::NEON
+		? requested == Isa::NEON || requested == Isa::Scalar
+		: requested != Isa::NEON && static_cast<int>(requested) <= static_cast<int>(best);
+	selectedIsa().store(static_cast<int>(supported ? requested : best), std::memory_order_relaxed);
+}
+
+const char *isaName(Isa isa)
+{
+	switch (isa) {
+	case Isa::Scalar: return "scalar";
+	case Isa::SSE2:   return "sse2";
+	case Isa::SSE41:  return "sse4.1";
+	case Isa::AVX2:   return "avx2";
+	case Isa::NEON:   return "neon";
+	}
+	return "unknown";
+}
+
+RowConverter converter(Uint32 srcFormat, Uint32 dstFormat)
+{
+	const int kind = kindFor(srcFormat, dstFormat);
+	return kind < 0 ? nullptr : table().convert[kind];
+}
+
+RowBlender blender()
+{
+	return table().blend;
+}
+
+RowBlender premultipliedBlender()
+{
+	return table().blendPremultiplied;
+}
+
+RowBlender premultiplier()
+{
+	return table().premultiply;
+}
+
+RowBlender unpremultiplier()
+{
+	return table().unpremultiply;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool convertPixels(int w, int h, Uint32 srcFormat, const void *src, int srcPitch, Uint32 dstFormat, void *dst, int dstPitch)
+{
+	const RowConverter fn = converter(srcFormat, dstFormat);
+	if (!fn)
+		return false;
+
+	Parallel::forRows(h, dstPitch, [&](int y0, int y1) {
+		for (int y = y0; y < y1; ++y)
+			fn(static_cast<const Uint8*>(src) + static_cast<ptrdiff_t>(y) * srcPitch, static_cast<Uint8*>(dst) + static_cast<ptrdiff_t>(y) * dstPitch, w);
+	});
+	return true;
+}
+
+SDL_Surface *convertSurface(SDL_Surface *src, Uint32 format)
+{
+	if (!src || !converter(src->format->format, format) || SDL_MUSTLOCK(src) || hasColorKey(src))
+		return nullptr;
+
+	SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, src->w, src->h, SDL_BITSPERPIXEL(format), format);
+	if (!dst)
+		return nullptr;
+
+	convertPixels(src->w, src->h, src->format->format, src->pixels, src->pitch, format, dst->pixels, dst->pitch);
+
+	SDL_BlendMode mode;
+	Uint8 r, g, b, a;
+	SDL_GetSurfaceBlendMode(src, &mode);
+	SDL_GetSurfaceColorMod(src, &r, &g, &b);
+	SDL_GetSurfaceAlphaMod(src, &a);
+	SDL_SetSurfaceBlendMode(dst, mode);
+	SDL_SetSurfaceColorMod(dst, r, g, b);
+	SDL_SetSurfaceAlphaMod(dst, a);
+	SDL_SetClipRect(dst, &src->clip_rect);
+	return dst;
+}
+
+bool blitSurface(SDL_Surface *src, const SDL_Rect *srcRect, SDL_Surface *dst, const SDL_Rect *dstRect)
+{
+	if (!blendable(src, dst))
+		return false;
+
+	SDL_BlendMode mode;
+	if (SDL_GetSurfaceBlendMode(src, &mode) != 0 || mode != SDL_BLENDMODE_BLEND)
+		return false;
+
+	blendRows(src, srcRect, dst, dstRect, blender());
+	return true;
+}
+
+bool blitPremultiplied(SDL_Surface *src, const SDL_Rect *srcRect, SDL_Surface *dst, const SDL_Rect *dstRect)
+{
+	if (!blendable(src, dst))
+		return false;
+
+	blendRows(src, srcRect, dst, dstRect, table().blendPremultiplied);
+	return true;
+}
+
+bool premultiplySurface(SDL_Surface *surface)
+{
+	return applyInPlace(surface, table().premultiply);
+}
+
+bool unpremultiplySurface(SDL_Surface *surface)
+{
+	return applyInPlace(surface, table().unpremultiply);
+}
+
+int fillRect(SDL_Surface *dst, const SDL_Rect *rect, Uint32 color)
+{
+	if (!dst || SDL_MUSTLOCK(dst))
+		return SDL_FillRect(dst, rect, color);
+
+	SDL_Rect area = dst->clip_rect;
+	if (rect && !SDL_IntersectRect(rect, &dst->clip_rect, &area))
+		return 0;
+
+	// SDL_FillRect only writes inside the given rect, so disjoint bands can
+	// be filled concurrently.
+	std::atomic<int> result{0};
+	Parallel::forRows(area.h, area.w * dst->format->BytesPerPixel, [&](int y0, int y1) {
+		const SDL_Rect band{area.x, area.y + y0, area.w, y1 - y0};
+		if (SDL_FillRect(dst, &band, color) != 0)
+			result = -1;
+	});
+	return result;
+}
+
+bool scaleNearest(SDL_Surface *src, SDL_Surface *dst)
+{
+	if (!src || !dst || src->format->format != dst->format->format || src->format->BytesPerPixel > 4)
+		return false;
+	// INDEX1 and INDEX4 pack several pixels per byte.
+	if (src->format->BitsPerPixel < 8)
+		return false;
+	if (SDL_MUSTLOCK(src) || SDL_MUSTLOCK(dst) || SDL_ISPIXELFORMAT_FOURCC(src->format->format))
+		return false;
+	if (dst->w <= 0 || dst->h <= 0)
+		return true;
+
+	// Pixel centers are mapped back to the source, which keeps the image
+	// centered when downscaling by non-integer factors.
+	const int bpp = src->format->BytesPerPixel;
+	std::vector<int> columns(dst->w);
+	for (int x = 0; x < dst->w; ++x)
+		columns[x] = static_cast<int>((2 * static_cast<Sint64>(x) + 1) * src->w / (2 * static_cast<Sint64>(dst->w))) * bpp;
+
+	Parallel::forRows(dst->h, dst->pitch, [&](int y0, int y1) {
+		for (int y = y0; y < y1; ++y) {
+			const int sy = static_cast<int>((2 * static_cast<Sint64>(y) + 1) * src->h / (2 * static_cast<Sint64>(dst->h)));
+			auto s = static_cast<const Uint8*>(src->pixels) + static_cast<ptrdiff_t>(sy) * src->pitch;
+			auto d = static_cast<Uint8*>(dst->pixels) + static_cast<ptrdiff_t>(y) * dst->pitch;
+
+			switch (bpp) {
+			case 4:
+				for (int x = 0; x < dst->w; ++x)
+					std::memcpy(d + 4 * x, s + columns[x], 4);
+				break;
+			case 3:
+				for (int x = 0; x < dst->w; ++x)
+					std::memcpy(d + 3 * x, s + columns[x], 3);
+				break;
+			case 2:
+				for (int x = 0; x < dst->w; ++x)
+					std::memcpy(d + 2 * x, s + columns[x], 2);
+				break;
+			default:
+				for (int x = 0; x < dst->w; ++x)
+					d[x] = s[columns[x]];
+				break;
+			}
+		}
+	});
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,505 @@
+/*
+** SDL++, 2020
+** Quantize.cpp
+*/
+
+#include "SDL++/Error.hpp"
+#include "SDL++/Parallel.hpp"
+#include "SDL++/Quantize.hpp"
+
+#include <SDL2/SDL_pixels.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr int lutSize = 32 * 64 * 32;
+
+	constexpr Uint8 bayer[64] = {
+		 0, 32,  8, 40,  2, 34, 10, 42,
+		48, 16, 56, 24, 50, 18, 58, 26,
+		12, 44,  4, 36, 14, 46,  6, 38,
+		60, 28, 52, 20, 62, 30, 54, 22,
+		 3, 35, 11, 43,  1, 33,  9, 41,
+		51, 19, 59, 27, 49, 17, 57, 25,
+		15, 47,  7, 39, 13, 45,  5, 37,
+		63, 31, 55, 23, 61, 29, 53, 21,
+	};
+
+	// Read access to a 32-bit surface with 8-bit color channels.
+	struct Pixels
+	{
+		const Uint8 *data;
+		int pitch;
+		int w;
+		int h;
+		Uint8 rshift;
+		Uint8 gshift;
+		Uint8 bshift;
+
+		const Uint32 *row(int y) const
+		{
+			return reinterpret_cast<const Uint32*>(data + static_cast<size_t>(y) * pitch);
+		}
+
+		void rgb(Uint32 p, int &r, int &g, int &b) const
+		{
+			r = (p >> rshift) & 0xff;
+			g = (p >> gshift) & 0xff;
+			b = (p >> bshift) & 0xff;
+		}
+	};
+
+	bool readable(const SDL_PixelFormat &f)
+	{
+		return f.BytesPerPixel == 4 && !f.palette && !SDL_ISPIXELFORMAT_FOURCC(f.format) && f.Rloss == 0 && f.Gloss == 0 && f.Bloss == 0;
+	}
+
+	template<typename F>
+	void withPixels(const Surface &image, F &&fn)
+	{
+		if (!readable(image.pixelFormat())) {
+			withPixels(image.withFormat(SDL_PIXELFORMAT_ARGB8888), fn);
+			return;
+		}
+
+		auto lock = image.lock();
+		const auto &f = image.pixelFormat();
+		fn(Pixels{static_cast<const Uint8*>(lock.rawArray()), image.ptr()->pitch, image.width(), image.height(), f.Rshift, f.Gshift, f.Bshift});
+	}
+
+	// Reuses target when it already has the wanted size and format.
+	void prepare(Surface &target, const Vec2i &size, int depth, Uint32 format)
+	{
+		if (!target.ptr() || target.format() != format || target.size() != size)
+			target = Surface{size.x, size.y, depth, format};
+	}
+
+	int clamp255(int v)
+	{
+		return v < 0 ? 0 : v > 255 ? 255 : v;
+	}
+
+	int distance(int r, int g, int b, const Color &c)
+	{
+		const int dr = r - c.r;
+		const int dg = g - c.g;
+		const int db = b - c.b;
+		return dr * dr + dg * dg + db * db;
+	}
+
+	int closest(int r, int g, int b, const std::vector<Color> &palette)
+	{
+		int best = 0;
+		int bestDistance = distance(r, g, b, palette[0]);
+		for (int i = 1, n = static_cast<int>(palette.size()); i < n && bestDistance > 0; ++i) {
+			const int d = distance(r, g, b, palette[i]);
+			if (d < bestDistance) {
+				best = i;
+				bestDistance = d;
+			}
+		}
+		return best;
+	}
+
+	Uint16 pack565(int r5, int g6, int b5)
+	{
+		return static_cast<Uint16>((r5 << 11) | (g6 << 5) | b5);
+	}
+
+	// Nearest 5 and 6-bit levels, and the 8-bit values they expand to.
+	int to5(int v) { return (v * 31 + 127) / 255; }
+	int to6(int v) { return (v * 63 + 127) / 255; }
+	int from5(int v) { return (v << 3) | (v >> 2); }
+	int from6(int v) { return (v << 2) | (v >> 4); }
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Serpentine Floyd-Steinberg over the whole image. map(r, g, b, out)
+	/// writes the quantized color to out and returns the stored value.
+	/// Errors are kept in 1/16 units.
+	template<typename T, typename Map>
+	void diffuse(const Pixels &src, Uint8 *dst, int dstPitch, Map &&map)
+	{
+		std::vector<int> cur((src.w + 2) * 3, 0);
+		std::vector<int> next((src.w + 2) * 3, 0);
+
+		for (int y = 0; y < src.h; ++y) {
+			const Uint32 *in = src.row(y);
+			T *out = reinterpret_cast<T*>(dst + static_cast<size_t>(y) * dstPitch);
+			const bool forward = (y & 1) == 0;
+			const int dir = forward ? 1 : -1;
+
+			for (int i = 0; i < src.w; ++i) {
+				const int x = forward ? i : src.w - 1 - i;
+				int c[3];
+				src.rgb(in[x], c[0], c[1], c[2]);
+
+				int *e = &cur[(x + 1) * 3];
+				int want[3];
+				for (int k = 0; k < 3; ++k)
+					want[k] = std::clamp(c[k] * 16 + e[k], 0, 255 * 16);
+
+				int got[3];
+				out[x] = map((want[0] + 8) >> 4, (want[1] + 8) >> 4, (want[2] + 8) >> 4, got);
+
+				int *ahead = &cur[(x + 1 + dir) * 3];
+				int *below = &next[(x + 1) * 3];
+				for (int k = 0; k < 3; ++k) {
+					const int err = want[k] - got[k] * 16;
+					ahead[k] += err * 7 / 16;
+					below[k - dir * 3] += err * 3 / 16;
+					below[k] += err * 5 / 16;
+					below[k + dir * 3] += err / 16;
+				}
+			}
+
+			std::swap(cur, next);
+			std::fill(next.begin(), next.end(), 0);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	struct Bin
+	{
+		int c[3];
+		Uint32 count;
+	};
+
+	struct Box
+	{
+		size_t begin;
+		size_t end;
+		Uint64 count;
+		int axis;
+		int range;
+	};
+
+	void measure(Box &box, const std::vector<Bin> &bins)
+	{
+		int lo[3] = {255, 255, 255};
+		int hi[3] = {0, 0, 0};
+		box.count = 0;
+		for (size_t i = box.begin; i < box.end; ++i) {
+			for (int k = 0; k < 3; ++k) {
+				lo[k] = std::min(lo[k], bins[i].c[k]);
+				hi[k] = std::max(hi[k], bins[i].c[k]);
+			}
+			box.count += bins[i].count;
+		}
+		box.axis = 0;
+		for (int k = 1; k < 3; ++k)
+			if (hi[k] - lo[k] > hi[box.axis] - lo[box.axis])
+				box.axis = k;
+		box.range = hi[box.axis] - lo[box.axis];
+	}
+
+	Color mean(const Bin *first, const Bin *last)
+	{
+		Uint64 sum[3] = {0, 0, 0};
+		Uint64 count = 0;
+		for (; first != last; ++first) {
+			for (int k = 0; k < 3; ++k)
+				sum[k] += Uint64(first->c[k]) * first->count;
+			count += first->count;
+		}
+		return Color{Uint8((sum[0] + count / 2) / count), Uint8((sum[1] + count / 2) / count), Uint8((sum[2] + count / 2) / count)};
+	}
+
+	/// Non-empty cells of a 5-bit per channel histogram, holding the mean
+	/// color of the pixels that fell in them.
+	std::vector<Bin> histogram(const Pixels &src)
+	{
+		std::vector<Uint32> counts(32 * 32 * 32, 0);
+		std::vector<Uint64> sums(32 * 32 * 32 * 3, 0);
+		for (int y = 0; y < src.h; ++y) {
+			const Uint32 *in = src.row(y);
+			for (int x = 0; x < src.w; ++x) {
+				int r, g, b;
+				src.rgb(in[x], r, g, b);
+				const int cell = ((r >> 3) << 10) | ((g >> 3) << 5) | (b >> 3);
+				++counts[cell];
+				sums[cell * 3] += r;
+				sums[cell * 3 + 1] += g;
+				sums[cell * 3 + 2] += b;
+			}
+		}
+
+		std::vector<Bin> bins;
+		for (int cell = 0; cell < 32 * 32 * 32; ++cell) {
+			if (const Uint32 n = counts[cell]) {
+				Bin bin{{0, 0, 0}, n};
+				for (int k = 0; k < 3; ++k)
+					bin.c[k] = static_cast<int>((sums[cell * 3 + k] + n / 2) / n);
+				bins.push_back(bin);
+			}
+		}
+		return bins;
+	}
+
+	std::vector<Color> splitBoxes(std::vector<Bin> &bins, int colors)
+	{
+		std::vector<Box> boxes;
+		boxes.push_back(Box{0, bins.size(), 0, 0, 0});
+		measure(boxes.back(), bins);
+
+		// Split the box with the most pixels times extent, at the pixel
+		// weighted median of its longest axis.
+		while (static_cast<int>(boxes.size()) < colors) {
+			Box *pick = nullptr;
+			for (auto &box : boxes)
+				if (box.end - box.begin > 1 && box.range > 0 && (!pick || box.count * box.range > pick->count * pick->range))
+					pick = &box;
+			if (!pick)
+				break;
+
+			const int axis = pick->axis;
+			std::sort(bins.begin() + pick->begin, bins.begin() + pick->end, [axis](const Bin &a, const Bin &b) {
+				return a.c[axis] < b.c[axis];
+			});
+
+			size_t split = pick->begin;
+			for (Uint64 seen = 0; split < pick->end - 1 && seen + bins[split].count <= pick->count / 2; ++split)
+				seen += bins[split].count;
+			split = std::clamp(split, pick->begin + 1, pick->end - 1);
+
+			Box upper{split, pick->end, 0, 0, 0};
+			pick->end = split;
+			measure(*pick, bins);
+			measure(upper, bins);
+			boxes.push_back(upper);
+		}
+
+		std::vector<Color> palette;
+		for (const auto &box : boxes)
+			palette.push_back(mean(bins.data() + box.begin, bins.data() + box.end));
+		return palette;
+	}
+
+	void refine(const std::vector<Bin> &bins, std::vector<Color> &palette, int passes)
+	{
+		for (int pass = 0; pass < passes; ++pass) {
+			std::vector<Uint64> sums(palette.size() * 4, 0);
+			for (const auto &bin : bins) {
+				const int i = closest(bin.c[0], bin.c[1], bin.c[2], palette);
+				for (int k = 0; k < 3; ++k)
+					sums[i * 4 + k] += Uint64(bin.c[k]) * bin.count;
+				sums[i * 4 + 3] += bin.count;
+			}
+			for (size_t i = 0; i < palette.size(); ++i) {
+				if (const Uint64 n = sums[i * 4 + 3])
+					palette[i] = Color{Uint8((sums[i * 4] + n / 2) / n), Uint8((sums[i * 4 + 1] + n / 2) / n), Uint8((sums[i * 4 + 2] + n / 2) / n)};
+			}
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace Quantize
+{
+	std::vector<Color> medianCut(const Surface &image, int colors, int refinePasses)
+	{
+		std::vector<Bin> bins;
+		withPixels(image, [&](const Pixels &src) { bins = histogram(src); });
+		if (bins.empty())
+			return {};
+
+		auto palette = splitBoxes(bins, std::clamp(colors, 1, 256));
+		refine(bins, palette, refinePasses);
+		return palette;
+	}
+
+	Surface toRGB565(const Surface &image, Dither dither)
+	{
+		Surface target{nullptr};
+		toRGB565(image, target, dither);
+		return target;
+	}
+
+	void toRGB565(const Surface &image, Surface &target, Dither dither)
+	{
+		prepare(target, image.size(), 16, SDL_PIXELFORMAT_RGB565);
+
+		withPixels(image, [&](const Pixels &src) {
+			auto lock = target.lock();
+			auto dst = static_cast<Uint8*>(lock.rawArray());
+			const int dstPitch = target.ptr()->pitch;
+
+			if (dither == Dither::FloydSteinberg) {
+				diffuse<Uint16>(src, dst, dstPitch, [](int r, int g, int b, int *got) {
+					const int r5 = to5(r), g6 = to6(g), b5 = to5(b);
+					got[0] = from5(r5);
+					got[1] = from6(g6);
+					got[2] = from5(b5);
+					return pack565(r5, g6, b5);
+				});
+				return;
+			}
+
+			// Ordered dithering adds a threshold below one output level before
+			// truncating, in units of the 5 and 6-bit levels so that the result
+			// averages back to the source color.
+			Parallel::forRows(src.h, src.pitch, [&](int y0, int y1) {
+				for (int y = y0; y < y1; ++y) {
+					const Uint32 *in = src.row(y);
+					Uint16 *out = reinterpret_cast<Uint16*>(dst + static_cast<size_t>(y) * dstPitch);
+					const Uint8 *threshold = bayer + (y & 7) * 8;
+					for (int x = 0; x < src.w; ++x) {
+						int r, g, b;
+						src.rgb(in[x], r, g, b);
+						if (dither == Dither::Ordered) {
+							const int t = threshold[x & 7] * 255;
+							out[x] = pack565((r * 31 * 64 + t) / (255 * 64), (g * 63 * 64 + t) / (255 * 64), (b * 31 * 64 + t) / (255 * 64));
+						} else {
+							out[x] = pack565(to5(r), to6(g), to5(b));
+						}
+					}
+				}
+			});
+		});
+	}
+
+	Surface toIndexed(const Surface &image, const std::vector<Color> &palette, Dither dither)
+	{
+		Quantizer quantizer{palette, dither};
+		return quantizer.convert(image);
+	}
+
+	Surface toIndexed(const Surface &image, int colors, Dither dither)
+	{
+		Quantizer quantizer{colors, dither};
+		return quantizer.convert(image);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Quantizer::Quantizer(std::vector<Color> palette, Dither dither)
+: m_colors{static_cast<int>(palette.size())}, m_dither{dither}
+{
+	setPalette(std::move(palette));
+}
+
+Quantizer::Quantizer(int colors, Dither dither)
+: m_lut(lutSize, 0), m_colors{std::clamp(colors, 1, 256)}, m_dither{dither}
+{}
+
+void Quantizer::setPalette(std::vector<Color> palette)
+{
+	if (palette.empty() || palette.size() > 256) {
+		Error::set("Quantizer palettes need between 1 and 256 colors");
+		SDLPP_THROW(Exception{"Quantizer::setPalette"});
+	}
+
+	m_palette = std::move(palette);
+	m_colors = static_cast<int>(m_palette.size());
+
+	// Ordered dithering spreads colors over about half the distance between
+	// neighbouring entries of a uniform palette of the same size.
+	m_spread = static_cast<int>(128.0 / std::cbrt(double(m_colors)));
+
+	buildTable();
+}
+
+void Quantizer::train(const Surface &frame, int refinePasses)
+{
+	auto palette = Quantize::medianCut(frame, m_colors, refinePasses);
+	if (palette.empty())
+		palette.push_back(Color::Black);
+	setPalette(std::move(palette));
+}
+
+void Quantizer::buildTable()
+{
+	m_lut.resize(lutSize);
+	ThreadPool::shared().run(32, 1, [this](int r0, int r1) {
+		for (int r5 = r0; r5 < r1; ++r5)
+			for (int g6 = 0; g6 < 64; ++g6)
+				for (int b5 = 0; b5 < 32; ++b5)
+					m_lut[(r5 << 11) | (g6 << 5) | b5] = static_cast<Uint8>(closest(from5(r5), from6(g6), from5(b5), m_palette));
+	});
+}
+
+Surface Quantizer::convert(const Surface &frame)
+{
+	Surface target{nullptr};
+	convert(frame, target);
+	return target;
+}
+
+void Quantizer::convert(const Surface &frame, Surface &target)
+{
+	if (m_palette.empty())
+		train(frame);
+
+	prepare(target, frame.size(), 8, SDL_PIXELFORMAT_INDEX8);
+
+	// Only touch the target palette when it changed, SDL invalidates the
+	// blit mappings of every surface using it otherwise.
+	SDL_Palette *pal = target.ptr()->format->palette;
+	const int n = static_cast<int>(m_palette.size());
+	bool same = pal->ncolors >= n;
+	for (int i = 0; same && i < n; ++i)
+		same = pal->colors[i].r == m_palette[i].r && pal->colors[i].g == m_palette[i].g && pal->colors[i].b == m_palette[i].b && pal->colors[i].a == 255;
+	if (!same) {
+		std::vector<SDL_Color> colors(m_palette.begin(), m_palette.end());
+		for (auto &c : colors)
+			c.a = 255;
+		if (SDL_SetPaletteColors(pal, colors.data(), 0, n) != 0)
+			SDLPP_THROW(Exception{"SDL_SetPaletteColors"});
+	}
+
+	withPixels(frame, [&](const Pixels &src) {
+		auto lock = target.lock();
+		auto dst = static_cast<Uint8*>(lock.rawArray());
+		const int dstPitch = target.ptr()->pitch;
+		const Uint8 *lut = m_lut.data();
+
+		if (m_dither == Dither::FloydSteinberg) {
+			diffuse<Uint8>(src, dst, dstPitch, [&](int r, int g, int b, int *got) {
+				const Uint8 i = lut[((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)];
+				got[0] = m_palette[i].r;
+				got[1] = m_palette[i].g;
+				got[2] = m_palette[i].b;
+				return i;
+			});
+			return;
+		}
+
+		int offsets[64];
+		for (int i = 0; i < 64; ++i)
+			offsets[i] = m_dither == Dither::Ordered ? (2 * bayer[i] - 63) * m_spread / 128 : 0;
+
+		Parallel::forRows(src.h, src.pitch, [&](int y0, int y1) {
+			for (int y = y0; y < y1; ++y) {
+				const Uint32 *in = src.row(y);
+				Uint8 *out = dst + static_cast<size_t>(y) * dstPitch;
+				const int *offset = offsets + (y & 7) * 8;
+				for (int x = 0; x < src.w; ++x) {
+					int r, g, b;
+					src.rgb(in[x], r, g, b);
+					const int d = offset[x & 7];
+					r = clamp255(r + d);
+					g = clamp255(g + d);
+					b = clamp255(b + d);
+					out[x] = lut[((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)];
+				}
+			}
+		});
+	});
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,434 @@
+/*
+** SDL++, 2020
+** Resample.cpp
+*/
+
+#include "SDL++/Parallel.hpp"
+#include "SDL++/PixelKernels.hpp"
+#include "Simd.hpp"
+
+#include <SDL2/SDL_pixels.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL::Kernels
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// Weights are 14-bit fixed point so that a pair of them times a pair of
+	// 8-bit samples fits the 16-bit multiply-add instructions.
+	constexpr int precision = 14;
+	constexpr int one = 1 << precision;
+
+	constexpr double pi = 3.14159265358979323846;
+
+	////////////////////////////////////////////////////////////////////////////
+	// Filters
+
+	double boxFilter(double x)
+	{
+		return x >= -0.5 && x < 0.5 ? 1.0 : 0.0;
+	}
+
+	double triangleFilter(double x)
+	{
+		x = std::abs(x);
+		return x < 1.0 ? 1.0 - x : 0.0;
+	}
+
+	double sinc(double x)
+	{
+		if (x == 0.0)
+			return 1.0;
+		x *= pi;
+		return std::sin(x) / x;
+	}
+
+	double lanczosFilter(double x)
+	{
+		return std::abs(x) < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+	}
+
+	struct Kernel
+	{
+		double (*fn)(double);
+		double radius;
+	};
+
+	Kernel kernelFor(Filter filter)
+	{
+		switch (filter) {
+		case Filter::Bilinear: return {triangleFilter, 1.0};
+		case Filter::Lanczos:  return {lanczosFilter, 3.0};
+		default:               return {boxFilter, 0.5};
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Weights
+
+	/// Every output position along one axis reads `taps` consecutive inputs
+	/// starting at first[i], weighted by weights[i * taps + k].
+	struct Taps
+	{
+		int taps = 0;
+		std::vector<int> first;
+		std::vector<Sint16> weights;
+	};
+
+	Taps computeTaps(int srcLen, int dstLen, const Kernel &kernel)
+	{
+		// When minifying, the filter is stretched to cover every input.
+		const double scale = double(dstLen) / double(srcLen);
+		const double stretch = std::max(1.0 / scale, 1.0);
+		const double support = kernel.radius * stretch;
+
+		Taps t;
+		t.taps = std::min(static_cast<int>(std::ceil(support * 2.0)) + 1, srcLen);
+		t.first.resize(dstLen);
+		t.weights.assign(static_cast<size_t>(dstLen) * t.taps, 0);
+
+		std::vector<double> w(t.taps);
+		for (int i = 0; i < dstLen; ++i) {
+			const double center = (i + 0.5) / scale;
+			const int lo = std::max(static_cast<int>(std::floor(center - support + 0.5)), 0);
+			const int hi = std::min(static_cast<int>(std::floor(center + support + 0.5)), srcLen);
+			const int first = std::max(std::min(lo, srcLen - t.taps), 0);
+
+			double total = 0.0;
+			std::fill(w.begin(), w.end(), 0.0);
+			for (int x = lo; x < hi && x - first < t.taps; ++x) {
+				w[x - first] = kernel.fn((x - center + 0.5) / stretch);
+				total += w[x - first];
+			}
+			if (total == 0.0) {
+				w[std::min(std::max(static_cast<int>(center), first), first + t.taps - 1) - first] = 1.0;
+				total = 1.0;
+			}
+
+			// Rounding may leave the sum off by a few units; the largest
+			// weight absorbs it so flat areas come out unchanged.
+			Sint16 *fixed = &t.weights[static_cast<size_t>(i) * t.taps];
+			int sum = 0, largest = 0;
+			for (int k = 0; k < t.taps; ++k) {
+				fixed[k] = static_cast<Sint16>(std::lround(w[k] / total * one));
+				sum += fixed[k];
+				if (std::abs(fixed[k]) > std::abs(fixed[largest]))
+					largest = k;
+			}
+			fixed[largest] = static_cast<Sint16>(fixed[largest] + one - sum);
+			t.first[i] = first;
+		}
+		return t;
+	}
+
+	Uint8 clampToByte(int acc)
+	{
+		return static_cast<Uint8>(std::min(std::max(acc >> precision, 0), 255));
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// Scalar
+
+	void horizontalScalar(const Uint8 *src, Uint8 *dst, int dstW, int channels, const Taps &t)
+	{
+		for (int x = 0; x < dstW; ++x) {
+			const Uint8 *s = src + channels * t.first[x];
+			const Sint16 *w = &t.weights[static_cast<size_t>(x) * t.taps];
+			for (int c = 0; c < channels; ++c) {
+				int acc = one / 2;
+				for (int k = 0; k < t.taps; ++k)
+					acc += w[k] * s[k * channels + c];
+				dst[x * channels + c] = clampToByte(acc);
+			}
+		}
+	}
+
+	void verticalScalar(const Uint8 *const *rows, Uint8 *dst, int i, int bytes, int taps, const Sint16 *w)
+	{
+		for (; i < bytes; ++i) {
+			int acc = one / 2;
+			for (int k = 0; k < taps; ++k)
+				acc += w[k] * rows[k][i];
+			dst[i] = clampToByte(acc);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	// x86
+
+#if defined(SDLPP_KERNELS_X86)
+	SDLPP_TARGET("sse2") __m128i weightPair(Sint16 a, Sint16 b)
+	{
+		return _mm_set1_epi32(static_cast<int>(Uint32(Uint16(a)) | (Uint32(Uint16(b)) << 16)));
+	}
+
+	// Four channels at once: two neighbouring pixels are interleaved per
+	// channel and multiplied by a pair of weights with pmaddwd.
+	SDLPP_TARGET("sse2") void horizontal4SSE2(const Uint8 *src, Uint8 *dst, int dstW, const Taps &t)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		for (int x = 0; x < dstW; ++x) {
+			const Uint8 *s = src + 4 * t.first[x];
+			const Sint16 *w = &t.weights[static_cast<size_t>(x) * t.taps];
+			__m128i acc = _mm_set1_epi32(one / 2);
+
+			int k = 0;
+			for (; k + 2 <= t.taps; k += 2) {
+				__m128i p = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(s + 4 * k)), zero);
+				p = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 8));
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(p, weightPair(w[k], w[k + 1])));
+			}
+			if (k < t.taps) {
+				Uint32 v;
+				std::memcpy(&v, s + 4 * k, 4);
+				const __m128i p = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(v)), zero), zero);
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(p, weightPair(w[k], 0)));
+			}
+
+			acc = _mm_srai_epi32(acc, precision);
+			acc = _mm_packs_epi32(acc, acc);
+			const Uint32 out = static_cast<Uint32>(_mm_cvtsi128_si32(_mm_packus_epi16(acc, acc)));
+			std::memcpy(dst + 4 * x, &out, 4);
+		}
+	}
+
+	SDLPP_TARGET("sse2") void verticalSSE2(const Uint8 *const *rows, Uint8 *dst, int i, int bytes, int taps, const Sint16 *w)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		for (; i + 16 <= bytes; i += 16) {
+			__m128i a0 = _mm_set1_epi32(one / 2), a1 = a0, a2 = a0, a3 = a0;
+			for (int k = 0; k < taps; k += 2) {
+				const bool pair = k + 1 < taps;
+				const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+				const __m128i r1 = pair ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k + 1] + i)) : zero;
+				const __m128i wk = weightPair(w[k], pair ? w[k + 1] : 0);
+
+				const __m128i lo0 = _mm_unpacklo_epi8(r0, zero), lo1 = _mm_unpacklo_epi8(r1, zero);
+				const __m128i hi0 = _mm_unpackhi_epi8(r0, zero), hi1 = _mm_unpackhi_epi8(r1, zero);
+				a0 = _mm_add_epi32(a0, _mm_madd_epi16(_mm_unpacklo_epi16(lo0, lo1), wk));
+				a1 = _mm_add_epi32(a1, _mm_madd_epi16(_mm_unpackhi_epi16(lo0, lo1), wk));
+				a2 = _mm_add_epi32(a2, _mm_madd_epi16(_mm_unpacklo_epi16(hi0, hi1), wk));
+				a3 = _mm_add_epi32(a3, _mm_madd_epi16(_mm_unpackhi_epi16(hi0, hi1), wk));
+			}
+			const __m128i lo = _mm_packs_epi32(_mm_srai_epi32(a0, precision), _mm_srai_epi32(a1, precision));
+			const __m128i hi = _mm_packs_epi32(_mm_srai_epi32(a2, precision), _mm_srai_epi32(a3, precision));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(lo, hi));
+		}
+
+		verticalScalar(rows, dst, i, bytes, taps, w);
+	}
+
+	// Same as SSE2 on 32 bytes: unpack and pack both work within 128-bit
+	// lanes, so the byte order is preserved without permutes.
+	SDLPP_TARGET("avx2") void verticalAVX2(const Uint8 *const *rows, Uint8 *dst, int i, int bytes, int taps, const Sint16 *w)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+
+		for (; i + 32 <= bytes; i += 32) {
+			__m256i a0 = _mm256_set1_epi32(one / 2), a1 = a0, a2 = a0, a3 = a0;
+			for (int k = 0; k < taps; k += 2) {
+				const bool pair = k + 1 < taps;
+				const __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+				const __m256i r1 = pair ? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k + 1] + i)) : zero;
+				const __m256i wk = _mm256_set1_epi32(static_cast<int>(Uint32(Uint16(w[k])) | (Uint32(Uint16(pair ? w[k + 1] : 0)) << 16)));
+
+				const __m256i lo0 = _mm256_unpacklo_epi8(r0, zero), lo1 = _mm256_unpacklo_epi8(r1, zero);
+				const __m256i hi0 = _mm256_unpackhi_epi8(r0, zero), hi1 = _mm256_unpackhi_epi8(r1, zero);
+				a0 = _mm256_add_epi32(a0, _mm256_madd_epi16(_mm256_unpacklo_epi16(lo0, lo1), wk));
+				a1 = _mm256_add_epi32(a1, _mm256_madd_epi16(_mm256_unpackhi_epi16(lo0, lo1), wk));
+				a2 = _mm256_add_epi32(a2, _mm256_madd_epi16(_mm256_unpacklo_epi16(hi0, hi1), wk));
+				a3 = _mm256_add_epi32(a3, _mm256_madd_epi16(_mm256_unpackhi_epi16(hi0, hi1), wk));
+			}
+			const __m256i lo = _mm256_packs_epi32(_mm256_srai_epi32(a0, precision), _mm256_srai_epi32(a1, precision));
+			const __m256i hi = _mm256_packs_epi32(_mm256_srai_epi32(a2, precision), _mm256_srai_epi32(a3, precision));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_packus_epi16(lo, hi));
+		}
+
+		verticalSSE2(rows, dst, i, bytes, taps, w);
+	}
+#endif
+
+	////////////////////////////////////////////////////////////////////////////
+	// NEON
+
+#if defined(SDLPP_KERNELS_NEON)
+	void horizontal4NEON(const Uint8 *src, Uint8 *dst, int dstW, const Taps &t)
+	{
+		for (int x = 0; x < dstW; ++x) {
+			const Uint8 *s = src + 4 * t.first[x];
+			const Sint16 *w = &t.weights[static_cast<size_t>(x) * t.taps];
+			int32x4_t acc = vdupq_n_s32(one / 2);
+
+			for (int k = 0; k < t.taps; ++k) {
+				Uint32 v;
+				std::memcpy(&v, s + 4 * k, 4);
+				const int16x4_t p = vget_low_s16(vreinterpretq_s16_u16(vmovl_u8(vcreate_u8(v))));
+				acc = vmlal_n_s16(acc, p, w[k]);
+			}
+
+			const int16x4_t n = vqshrn_n_s32(acc, precision);
+			const Uint32 out = vget_lane_u32(vreinterpret_u32_u8(vqmovun_s16(vcombine_s16(n, n))), 0);
+			std::memcpy(dst + 4 * x, &out, 4);
+		}
+	}
+
+	void verticalNEON(const Uint8 *const *rows, Uint8 *dst, int i, int bytes, int taps, const Sint16 *w)
+	{
+		for (; i + 8 <= bytes; i += 8) {
+			int32x4_t a0 = vdupq_n_s32(one / 2), a1 = a0;
+			for (int k = 0; k < taps; ++k) {
+				const int16x8_t r = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(rows[k] + i)));
+				a0 = vmlal_n_s16(a0, vget_low_s16(r), w[k]);
+				a1 = vmlal_n_s16(a1, vget_high_s16(r), w[k]);
+			}
+			const int16x8_t n = vcombine_s16(vqshrn_n_s32(a0, precision), vqshrn_n_s32(a1, precision));
+			vst1_u8(dst + i, vqmovun_s16(n));
+		}
+
+		verticalScalar(rows, dst, i, bytes, taps, w);
+	}
+#endif
+
+	////////////////////////////////////////////////////////////////////////////
+	// Passes
+
+	struct Image
+	{
+		Uint8 *pixels;
+		int w, h, pitch;
+	};
+
+	void horizontalPass(const Image &src, const Image &dst, int channels, const Taps &t)
+	{
+		const Isa selected = isa();
+
+		Parallel::forRows(dst.h, dst.w * channels, [&](int y0, int y1) {
+			for (int y = y0; y < y1; ++y) {
+				const Uint8 *s = src.pixels + static_cast<ptrdiff_t>(y) * src.pitch;
+				Uint8 *d = dst.pixels + static_cast<ptrdiff_t>(y) * dst.pitch;
+#if defined(SDLPP_KERNELS_X86)
+				if (channels == 4 && selected != Isa::Scalar) {
+					horizontal4SSE2(s, d, dst.w, t);
+					continue;
+				}
+#elif defined(SDLPP_KERNELS_NEON)
+				if (channels == 4 && selected == Isa::NEON) {
+					horizontal4NEON(s, d, dst.w, t);
+					continue;
+				}
+#endif
+				horizontalScalar(s, d, dst.w, channels, t);
+			}
+		});
+	}
+
+	void verticalPass(const Image &src, const Image &dst, int channels, const Taps &t)
+	{
+		using Vertical = void (*)(const Uint8 *const*, Uint8*, int, int, int, const Sint16*);
+
+		Vertical fn = verticalScalar;
+		switch (isa()) {
+#if defined(SDLPP_KERNELS_X86)
+		case Isa::AVX2:  fn = verticalAVX2; break;
+		case Isa::SSE41:
+		case Isa::SSE2:  fn = verticalSSE2; break;
+#endif
+#if defined(SDLPP_KERNELS_NEON)
+		case Isa::NEON:  fn = verticalNEON; break;
+#endif
+		default:         break;
+		}
+
+		Parallel::forRows(dst.h, dst.pitch, [&](int y0, int y1) {
+			std::vector<const Uint8*> rows(t.taps);
+			for (int y = y0; y < y1; ++y) {
+				for (int k = 0; k < t.taps; ++k)
+					rows[k] = src.pixels + static_cast<ptrdiff_t>(t.first[y] + k) * src.pitch;
+				fn(rows.data(), dst.pixels + static_cast<ptrdiff_t>(y) * dst.pitch, 0, dst.w * channels, t.taps, &t.weights[static_cast<size_t>(y) * t.taps]);
+			}
+		});
+	}
+
+	bool resamplable(const SDL_Surface *s)
+	{
+		const Uint32 f = s->format->format;
+		if (SDL_ISPIXELFORMAT_FOURCC(f) || SDL_MUSTLOCK(s))
+			return false;
+		return (SDL_PIXELTYPE(f) == SDL_PIXELTYPE_PACKED32 && SDL_PIXELLAYOUT(f) == SDL_PACKEDLAYOUT_8888)
+			|| (SDL_PIXELTYPE(f) == SDL_PIXELTYPE_ARRAYU8 && s->format->BytesPerPixel == 3);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool resample(SDL_Surface *src, SDL_Surface *dst, Filter filter)
+{
+	if (filter == Filter::Nearest)
+		return scaleNearest(src, dst);
+
+	if (!src || !dst || src->format->format != dst->format->format || !resamplable(src) || !resamplable(dst))
+		return false;
+	if (dst->w <= 0 || dst->h <= 0 || src->w <= 0 || src->h <= 0)
+		return true;
+
+	const int channels = src->format->BytesPerPixel;
+	const Kernel kernel = kernelFor(filter);
+	const Image in{static_cast<Uint8*>(src->pixels), src->w, src->h, src->pitch};
+	const Image out{static_cast<Uint8*>(dst->pixels), dst->w, dst->h, dst->pitch};
+
+	const bool scaleX = src->w != dst->w;
+	const bool scaleY = src->h != dst->h;
+
+	if (!scaleX && !scaleY) {
+		for (int y = 0; y < src->h; ++y)
+			std::memcpy(out.pixels + static_cast<ptrdiff_t>(y) * out.pitch, in.pixels + static_cast<ptrdiff_t>(y) * in.pitch, static_cast<size_t>(src->w) * channels);
+		return true;
+	}
+
+	const Taps tx = scaleX ? computeTaps(src->w, dst->w, kernel) : Taps{};
+	const Taps ty = scaleY ? computeTaps(src->h, dst->h, kernel) : Taps{};
+
+	if (!scaleY) {
+		horizontalPass(in, out, channels, tx);
+		return true;
+	}
+	if (!scaleX) {
+		verticalPass(in, out, channels, ty);
+		return true;
+	}
+
+	// Either order gives the same filter; pick the one multiplying fewer
+	// taps, which is vertical first when the height shrinks a lot.
+	const double horizontalFirst = double(src->h) * dst->w * tx.taps + double(dst->h) * dst->w * ty.taps;
+	const double verticalFirst = double(dst->h) * src->w * ty.taps + double(dst->h) * dst->w * tx.taps;
+
+	if (horizontalFirst <= verticalFirst) {
+		const int pitch = dst->w * channels;
+		std::vector<Uint8> buffer(static_cast<size_t>(pitch) * src->h);
+		const Image tmp{buffer.data(), dst->w, src->h, pitch};
+		horizontalPass(in, tmp, channels, tx);
+		verticalPass(tmp, out, channels, ty);
+	} else {
+		const int pitch = src->w * channels;
+		std::vector<Uint8> buffer(static_cast<size_t>(pitch) * dst->h);
+		const Image tmp{buffer.data(), src->w, dst->h, pitch};
+		verticalPass(in, tmp, channels, ty);
+		horizontalPass(tmp, out, channels, tx);
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
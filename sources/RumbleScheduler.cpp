@@ -0,0 +1,249 @@
+/*
+** SDL++, 2020
+** RumbleScheduler.cpp
+*/
+
+#include "SDL++/RumbleScheduler.hpp"
+#include "SDL++/Error.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	Sint64 saturatedAdd(Sint64 a, Sint64 b)
+	{
+		constexpr Sint64 max = std::numeric_limits<Sint64>::max();
+		return b > max - a ? max : a + b;
+	}
+
+	Uint16 quantize(float level)
+	{
+		return Uint16(std::lround(std::clamp(level, 0.0f, 1.0f) * 65535.0f));
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RumbleScheduler::~RumbleScheduler()
+{
+	m_targets.forEach([this](Target, Output &o) {
+		if (o.low || o.high)
+			send(o, 0, 0);
+	});
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+RumbleScheduler::Target RumbleScheduler::add(const GameController &controller)
+{
+	Output o;
+	o.controller = controller.ptr();
+	return m_targets.insert(std::move(o));
+}
+#endif
+
+RumbleScheduler::Target RumbleScheduler::add(Haptic &haptic)
+{
+	Output o;
+	o.haptic = &haptic;
+	o.leftRight = haptic.isCapableOf(SDL_HAPTIC_LEFTRIGHT);
+
+	Haptic::Effect e;
+	e.type = o.leftRight ? SDL_HAPTIC_LEFTRIGHT : SDL_HAPTIC_SINE;
+	if (!haptic.isEffectCompatible(e)) {
+		Error::set("Haptic device supports neither left/right nor sine effects");
+		SDLPP_THROW(Exception{"RumbleScheduler::add"});
+	}
+	o.effect = haptic.newEffect(e);
+	return m_targets.insert(std::move(o));
+}
+
+void RumbleScheduler::remove(Target target)
+{
+	Output *o = m_targets.find(target);
+	if (!o)
+		return;
+
+	cancelAll(target);
+	if (o->low || o->high)
+		send(*o, 0, 0);
+	m_targets.erase(target);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RumbleScheduler::Effect RumbleScheduler::play(Target target, const Rumble &rumble)
+{
+	if (!m_targets.contains(target))
+		return {};
+
+	Active a;
+	a.target = target;
+	a.low = rumble.low;
+	a.high = rumble.high;
+	a.attack = std::max<Sint64>(rumble.envelope.attack.count(), 0);
+	a.releaseAt = saturatedAdd(a.attack, std::max<Sint64>(rumble.envelope.sustain.count(), 0));
+	a.release = std::max<Sint64>(rumble.envelope.release.count(), 0);
+	a.end = saturatedAdd(a.releaseAt, a.release);
+	return m_effects.insert(a);
+}
+
+bool RumbleScheduler::stop(Effect effect)
+{
+	Active *a = m_effects.find(effect);
+	if (!a)
+		return false;
+
+	// Release from the current level rather than from full.
+	if (a->elapsed < a->releaseAt) {
+		const float level = gain(*a);
+		if (a->release == 0 || level <= 0.0f)
+			return cancel(effect);
+		a->low *= level;
+		a->high *= level;
+		a->attack = 0;
+		a->releaseAt = a->elapsed;
+		a->end = saturatedAdd(a->elapsed, a->release);
+	}
+	return true;
+}
+
+bool RumbleScheduler::cancel(Effect effect)
+{
+	return m_effects.erase(effect);
+}
+
+void RumbleScheduler::cancelAll(Target target)
+{
+	m_ended.clear();
+	m_effects.forEach([&](Effect key, Active &a) {
+		if (a.target == target)
+			m_ended.push_back(key);
+	});
+	for (const Effect key : m_ended)
+		m_effects.erase(key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void RumbleScheduler::update(std::chrono::milliseconds dt)
+{
+	const Sint64 step = std::max<Sint64>(dt.count(), 0);
+	m_now += step;
+
+	m_low.assign(m_targets.capacity(), 0.0f);
+	m_high.assign(m_targets.capacity(), 0.0f);
+	m_ended.clear();
+
+	m_effects.forEach([&](Effect key, Active &a) {
+		if (a.elapsed >= a.end || !m_targets.contains(a.target)) {
+			m_ended.push_back(key);
+			return;
+		}
+
+		const float g = gain(a);
+		float &low = m_low[a.target.index];
+		float &high = m_high[a.target.index];
+		if (m_blend == Blend::Sum) {
+			low += a.low * g;
+			high += a.high * g;
+		} else {
+			low = std::max(low, a.low * g);
+			high = std::max(high, a.high * g);
+		}
+		a.elapsed = saturatedAdd(a.elapsed, step);
+	});
+	for (const Effect key : m_ended)
+		m_effects.erase(key);
+
+	const Sint64 renewal = m_lease.count() / 2;
+	m_targets.forEach([&](Target key, Output &o) {
+		++m_stats.updates;
+		const Uint16 low = quantize(m_low[key.index]);
+		const Uint16 high = quantize(m_high[key.index]);
+
+		const bool on = low || high;
+		const bool wasOn = o.low || o.high;
+		const bool changed = std::abs(int(low) - int(o.low)) > m_threshold || std::abs(int(high) - int(o.high)) > m_threshold;
+		if (on != wasOn || (on && (changed || m_now - o.sentAt >= renewal)))
+			send(o, low, high);
+	});
+}
+
+Uint16 RumbleScheduler::lowOutput(Target target) const
+{
+	const Output *o = m_targets.find(target);
+	return o ? o->low : 0;
+}
+
+Uint16 RumbleScheduler::highOutput(Target target) const
+{
+	const Output *o = m_targets.find(target);
+	return o ? o->high : 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+float RumbleScheduler::gain(const Active &a)
+{
+	if (a.elapsed < a.attack)
+		return float(a.elapsed) / float(a.attack);
+	if (a.elapsed < a.releaseAt)
+		return 1.0f;
+	if (a.elapsed < a.end)
+		return 1.0f - float(a.elapsed - a.releaseAt) / float(a.end - a.releaseAt);
+	return 0.0f;
+}
+
+bool RumbleScheduler::send(Output &o, Uint16 low, Uint16 high)
+{
+	++m_stats.commands;
+	o.low = low;
+	o.high = high;
+	o.sentAt = m_now;
+
+	const Uint32 length = low || high ? Uint32(m_lease.count()) : 0;
+	bool ok = true;
+
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+	if (o.controller)
+		ok = SDL_GameControllerRumble(o.controller, low, high, length) == 0;
+#endif
+
+	if (o.haptic) {
+		Status status;
+		if (!length) {
+			status = o.effect.stop(std::nothrow);
+		} else {
+			Haptic::Effect e = *o.effect.effect();
+			if (o.leftRight) {
+				e.leftright.length = length;
+				e.leftright.large_magnitude = low;
+				e.leftright.small_magnitude = high;
+			} else {
+				e.periodic.length = length;
+				e.periodic.period = 20;
+				e.periodic.magnitude = Sint16(std::max(low, high) / 2);
+			}
+			status = o.effect.update(e, std::nothrow);
+			if (status)
+				status = o.effect.run(1, std::nothrow);
+		}
+		ok = ok && status.ok();
+	}
+
+	m_stats.failures += !ok;
+	return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
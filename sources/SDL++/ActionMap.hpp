@@ -0,0 +1,176 @@
+/*
+** SDL++, 2020
+** ActionMap.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ControllerState.hpp"
+
+#include <SDL2/SDL_scancode.h>
+#include <SDL2/SDL_stdinc.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Game actions bound to keys, mouse buttons and controller inputs, compiled
+/// into tables indexed by scancode and button so that update() evaluates
+/// every action in one pass over the bound inputs, with no name lookups.
+///
+/// Bindings are text, one action per line, several bindings per action:
+///
+///     # comment
+///     jump  = key:Space, pad:a
+///     fire  = mouse:left, axis:+righttrigger@0.5
+///     left  = key:Left, key:A, axis:-leftx
+///
+/// key: takes SDL scancode names, pad: and axis: the SDL game controller
+/// button and axis names; mouse: is left, middle, right, x1 or x2. Axis
+/// bindings hold while the axis is past the threshold (0.5 by default) in
+/// the given direction. Actions keep their ids across reloads; an action
+/// is down when any binding holds, on any game controller.
+class ActionMap
+{
+public:
+	using Action = Uint16;
+	static constexpr Action invalid = 0xFFFF;
+
+	/// Ids of the actions bound to one input.
+	struct Range
+	{
+		const Action *first;
+		const Action *last;
+
+		const Action *begin() const { return first; }
+		const Action *end() const { return last; }
+		size_t size() const { return size_t(last - first); }
+	};
+
+	ActionMap() = default;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Replaces every binding with those of config. Throws Exception naming
+	/// the faulty line, leaving the map unchanged.
+	void parse(std::string_view config);
+
+	/// parse() on the file, remembered for reloadIfChanged().
+	void load(const std::string &filename);
+
+	/// Loads the file again if it was modified since; returns whether it did.
+	/// A faulty file throws once and keeps the current bindings; it is not
+	/// tried again until modified again.
+	bool reloadIfChanged();
+
+	/// Registers the action if needed and adds one binding to it.
+	Action bind(std::string_view action, std::string_view binding);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	size_t actionCount() const { return m_names.size(); }
+
+	/// invalid for unknown names.
+	Action action(std::string_view name) const;
+	const std::string &name(Action a) const { return m_names[a]; }
+
+	Range actionsFor(SDL_Scancode scancode) const { return m_keys.range(size_t(scancode)); }
+	/// button is SDL_BUTTON_LEFT to SDL_BUTTON_X2; empty for anything else.
+	Range actionsForMouse(int button) const
+	{
+		return button >= 1 ? m_mouse.range(size_t(button - 1)) : Range{nullptr, nullptr};
+	}
+	Range actionsFor(SDL_GameControllerButton button) const { return m_pad.range(size_t(button)); }
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Evaluates every action: keys as returned by Keyboard::state(),
+	/// mouseButtons as by SDL_GetMouseState(). pad: and axis: bindings only
+	/// read states captured from game controllers; raw joystick states are
+	/// skipped, their indices meaning something else.
+	void update(const Uint8 *keys, Uint32 mouseButtons, const ControllerState *controllers, size_t controllerCount);
+
+	/// Same, reading the keyboard and mouse from SDL.
+	void update(const std::vector<ControllerState> &controllers = {});
+
+	bool down(Action a) const { return bit(m_down, a); }
+	bool pressed(Action a) const { return bit(m_down, a) && !bit(m_previous, a); }
+	bool released(Action a) const { return !bit(m_down, a) && bit(m_previous, a); }
+
+	/// 1 for held digital bindings, the largest axis magnitude past its
+	/// threshold otherwise, 0 when up.
+	float value(Action a) const { return a < m_values.size() ? m_values[a] : 0.0f; }
+
+private:
+	/// For every input, the actions bound to it (compressed rows); bound
+	/// lists the inputs having any, in increasing order.
+	struct Table
+	{
+		std::vector<Uint32> offsets;
+		std::vector<Action> actions;
+		std::vector<Uint16> bound;
+
+		Range range(size_t input) const
+		{
+			if (input >= offsets.size() || input + 1 >= offsets.size())
+				return Range{nullptr, nullptr};
+			return Range{actions.data() + offsets[input], actions.data() + offsets[input + 1]};
+		}
+	};
+
+	struct AxisBinding
+	{
+		Uint8 axis;
+		bool negative;
+		Sint16 threshold;
+		Action action;
+	};
+
+	struct Bindings
+	{
+		std::vector<std::pair<Uint16, Action>> keys;
+		std::vector<std::pair<Uint16, Action>> mouse;
+		std::vector<std::pair<Uint16, Action>> pad;
+		std::vector<AxisBinding> axes;
+	};
+
+	static bool bit(const std::vector<Uint64> &bits, Action a)
+	{
+		return size_t(a >> 6) < bits.size() && (bits[a >> 6] >> (a & 63) & 1);
+	}
+
+	/// Empty on success, else what is wrong with binding.
+	static std::string addBinding(Bindings &bindings, Action action, std::string_view binding);
+	void compile();
+	static Table table(std::vector<std::pair<Uint16, Action>> pairs, size_t inputs);
+
+	std::vector<std::string> m_names;
+	std::unordered_map<std::string, Action> m_ids;
+	Bindings m_bindings;
+
+	Table m_keys;
+	Table m_mouse;
+	Table m_pad;
+	std::vector<AxisBinding> m_axes;
+
+	std::vector<Uint64> m_down;
+	std::vector<Uint64> m_previous;
+	std::vector<float> m_values;
+
+	std::string m_file;
+	Sint64 m_mtime = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
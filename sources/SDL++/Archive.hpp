@@ -0,0 +1,165 @@
+/*
+** SDL++, 2020
+** Archive.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Exception.hpp"
+#include "MappedFile.hpp"
+#include "Surface.hpp"
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Read-only packed asset archive.
+///
+/// Layout: a fixed header, the blobs (each aligned on blobAlignment bytes),
+/// the entry table, the names, then an open-addressing hash index of
+/// power-of-two size mapping FNV-1a name hashes to entries.
+/// Blobs are either raw file contents or pre-decoded pixels, the latter
+/// being wrapped in a Surface directly over the mapping.
+class Archive
+{
+public:
+	static constexpr char magic[4] = {'S', 'P', 'A', 'K'};
+	static constexpr Uint32 version = 1;
+	static constexpr Uint64 blobAlignment = 64;
+
+	struct Header
+	{
+		char magic[4];
+		Uint32 version;
+		Uint32 entryCount;
+		Uint32 bucketCount;
+		Uint64 entriesOffset;
+		Uint64 namesOffset;
+		Uint64 bucketsOffset;
+	};
+
+	struct Entry
+	{
+		Uint64 hash;
+		Uint64 offset;
+		Uint64 size;
+		Uint32 nameOffset;
+		Uint32 nameLength;
+		Uint32 format; ///< SDL_PIXELFORMAT_UNKNOWN for raw file contents
+		Sint32 width;
+		Sint32 height;
+		Sint32 pitch;
+
+		bool isPixels() const { return format != SDL_PIXELFORMAT_UNKNOWN; }
+	};
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Archive() = default;
+
+	explicit Archive(const std::string &filename);
+
+	Archive(const Archive&) = delete;
+
+	Archive(Archive &&other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	const Entry *find(std::string_view name) const;
+
+	bool contains(std::string_view name) const { return find(name) != nullptr; }
+
+	const Entry &at(std::string_view name) const;
+
+	size_t entryCount() const { return m_header ? m_header->entryCount : 0; }
+	const Entry *begin() const { return m_entries; }
+	const Entry *end() const { return m_entries + entryCount(); }
+
+	std::string_view name(const Entry &e) const
+	{
+		return {m_names + e.nameOffset, e.nameLength};
+	}
+
+	Uint8 *data(const Entry &e) const
+	{
+		return m_file.data() + e.offset;
+	}
+
+	/// Pre-decoded entries are wrapped without copy, the surface must not
+	/// outlive the archive. Raw entries are decoded from memory.
+	Surface surface(std::string_view name) const;
+	Surface surface(const Entry &e) const;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Archive &operator =(const Archive&) = delete;
+
+	Archive &operator =(Archive &&other) noexcept
+	{
+		if (this != &other) {
+			m_file = std::move(other.m_file);
+			m_header = std::exchange(other.m_header, nullptr);
+			m_entries = std::exchange(other.m_entries, nullptr);
+			m_names = std::exchange(other.m_names, nullptr);
+			m_buckets = std::exchange(other.m_buckets, nullptr);
+		}
+		return *this;
+	}
+
+private:
+	MappedFile m_file;
+	const Header *m_header = nullptr;
+	const Entry *m_entries = nullptr;
+	const char *m_names = nullptr;
+	const Uint32 *m_buckets = nullptr;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class ArchiveWriter
+{
+public:
+	void addData(const std::string &name, const void *data, size_t size);
+	void addFile(const std::string &name, const std::string &filename);
+	void addSurface(const std::string &name, const Surface &surface);
+
+	size_t entryCount() const { return m_pending.size(); }
+
+	void write(const std::string &filename) const;
+
+private:
+	struct Pending
+	{
+		std::string name;
+		std::vector<Uint8> bytes;
+		Uint32 format = SDL_PIXELFORMAT_UNKNOWN;
+		int width = 0;
+		int height = 0;
+		int pitch = 0;
+	};
+
+	Pending &add(const std::string &name);
+
+	std::vector<Pending> m_pending;
+	std::unordered_set<std::string> m_names;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,158 @@
+/*
+** SDL++, 2020
+** BitmapFont.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Rect.hpp"
+#include "Render.hpp"
+#include "Surface.hpp"
+#include "Texture.hpp"
+#include "Vec2.hpp"
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Pre-rasterized font: glyph rectangles on one or more atlas textures
+/// (pages), loaded from a BMFont text descriptor or a grid of cells.
+///
+/// Text is UTF-8. Codepoints without a glyph use '?' when the font has one
+/// and are skipped otherwise. TextRenderer caches layouts and batches the
+/// glyphs for drawing.
+class BitmapFont
+{
+public:
+	struct Glyph
+	{
+		Rect source;
+		/// From the pen position, on the top of the line, to the top-left
+		/// corner of the glyph.
+		Vec2i offset{};
+		int advance = 0;
+		Uint16 page = 0;
+	};
+
+	/// A glyph placed by layout(), relative to the top-left corner of the text.
+	struct Quad
+	{
+		Rect source;
+		Rect dest;
+		Uint16 page;
+	};
+
+	struct Layout
+	{
+		std::vector<Quad> quads;
+		Vec2i size{};
+	};
+
+	using PageLoader = std::function<Surface(const std::string &file)>;
+
+	BitmapFont() = default;
+	BitmapFont(const BitmapFont&) = delete;
+
+	BitmapFont(BitmapFont &&other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	BitmapFont &operator =(const BitmapFont&) = delete;
+	BitmapFont &operator =(BitmapFont &&other) noexcept;
+
+	/// Reads a BMFont text descriptor (.fnt) and its pages, resolved relative
+	/// to the descriptor's directory.
+	static BitmapFont load(const Renderer &renderer, const std::string &filename);
+
+	/// Parses a BMFont text descriptor, getting the pages from loadPage with
+	/// the file names it lists.
+	static BitmapFont fromDescriptor(const Renderer &renderer, std::string_view descriptor, const PageLoader &loadPage);
+
+	/// Monospace font from a sheet of cell-sized glyphs, in row order from
+	/// first; count 0 takes every cell of the sheet.
+	static BitmapFont fromGrid(const Renderer &renderer, const Surface &sheet, const Vec2i &cell, Uint32 first = ' ', Uint32 count = 0);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Unique per font for its lifetime, follows the font when moved.
+	Uint32 id() const { return m_id; }
+
+	int lineHeight() const { return m_lineHeight; }
+	int base() const { return m_base; }
+
+	size_t pageCount() const { return m_pages.size(); }
+	Texture &page(size_t i) { return m_pages[i]; }
+	const Texture &page(size_t i) const { return m_pages[i]; }
+	const Vec2i &pageSize(size_t i) const { return m_pageSizes[i]; }
+
+	/// nullptr when the font has no glyph for codepoint.
+	const Glyph *glyph(Uint32 codepoint) const
+	{
+		Uint32 i = 0;
+		if (codepoint < 128) {
+			i = m_ascii[codepoint];
+		} else {
+			const auto it = m_extended.find(codepoint);
+			if (it != m_extended.end())
+				i = it->second;
+		}
+		return i ? &m_glyphs[i - 1] : nullptr;
+	}
+
+	int kerning(Uint32 first, Uint32 second) const
+	{
+		if (m_kerning.empty())
+			return 0;
+		const auto it = m_kerning.find(Uint64(first) << 32 | second);
+		return it != m_kerning.end() ? it->second : 0;
+	}
+
+	/// Places the glyphs of text, starting a new line at every '\n'.
+	void layout(std::string_view text, Layout &out) const;
+
+	Layout layout(std::string_view text) const
+	{
+		Layout l;
+		layout(text, l);
+		return l;
+	}
+
+	/// Size of the text's layout, without building it.
+	Vec2i measure(std::string_view text) const;
+
+private:
+	void addGlyph(Uint32 codepoint, const Glyph &glyph);
+	void addPage(const Renderer &renderer, const Surface &surface);
+	const Glyph *glyphOrFallback(Uint32 codepoint) const;
+
+	Uint32 m_id = 0;
+	int m_lineHeight = 0;
+	int m_base = 0;
+
+	std::vector<Texture> m_pages;
+	std::vector<Vec2i> m_pageSizes;
+	std::vector<Glyph> m_glyphs;
+	// Glyph indices plus one, 0 when missing.
+	Uint32 m_ascii[128] = {};
+	std::unordered_map<Uint32, Uint32> m_extended;
+	std::unordered_map<Uint64, int> m_kerning;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,178 @@
+/*
+** SDL++, 2020
+** CachedLayer.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Error.hpp"
+#include "Pixels.hpp"
+#include "Rect.hpp"
+#include "Render.hpp"
+#include "Texture.hpp"
+#include "Vec2.hpp"
+
+#include <SDL2/SDL_pixels.h>
+#include <SDL2/SDL_render.h>
+#include <SDL2/SDL_version.h>
+
+#include <new>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Retained rendering of something that rarely changes (a label, a panel,
+/// a minimap): draw() paints it once into a render target texture, then
+/// only composites that texture until invalidate() or a new key.
+///
+/// Painting happens in layer coordinates, from (0, 0), on a transparent
+/// target, so blended content is stored premultiplied and composited with
+/// Texture::premultipliedBlendMode(). Before SDL 2.0.6 and on renderers
+/// without custom blend modes (the software renderer) it falls back to
+/// plain blending, which darkens translucent edges of the content.
+/// Invalidate every layer on SDL_RENDER_TARGETS_RESET. With culling on,
+/// a layer entirely off screen is neither painted nor drawn.
+class CachedLayer
+{
+public:
+	struct Stats
+	{
+		/// Frames composited from the cache.
+		Uint64 hits = 0;
+		/// Frames that had to paint first.
+		Uint64 repaints = 0;
+		Uint64 invalidations = 0;
+
+		double hitRate() const
+		{
+			const Uint64 total = hits + repaints;
+			return total ? double(hits) / double(total) : 0.0;
+		}
+	};
+
+	explicit CachedLayer(const Vec2i &size, SDL_PixelFormatEnum format = SDL_PIXELFORMAT_ARGB8888)
+	: m_size{size}
+	, m_format{format}
+	{}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	const Vec2i &size() const { return m_size; }
+	bool valid() const { return m_valid; }
+
+	/// Texture memory held by the layer, 0 until painted and after release().
+	size_t memory() const
+	{
+		return m_texture.ptr() ? size_t(m_size.x) * size_t(m_size.y) * SDL_BYTESPERPIXEL(m_format) : 0;
+	}
+
+	const Stats &stats() const { return m_stats; }
+	void resetStats() { m_stats = Stats{}; }
+
+	void invalidate()
+	{
+		if (m_valid)
+			++m_stats.invalidations;
+		m_valid = false;
+	}
+
+	/// Invalidates when key differs from the previous one, e.g. a hash of
+	/// the text of a label or a version counter of a model.
+	void setKey(Uint64 key)
+	{
+		if (key != m_key || !m_hasKey)
+			invalidate();
+		m_key = key;
+		m_hasKey = true;
+	}
+
+	/// Invalidates, and drops the texture when the size changes.
+	void resize(const Vec2i &size)
+	{
+		if (size != m_size)
+			m_texture = Texture{};
+		m_size = size;
+		invalidate();
+	}
+
+	/// Frees the texture, e.g. for layers hidden for a long time.
+	void release()
+	{
+		m_texture = Texture{};
+		invalidate();
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Composites the layer at pos, first calling paint(renderer) with the
+	/// layer as render target if it is invalid.
+	template<typename F>
+	void draw(Renderer &renderer, const Vec2i &pos, F &&paint)
+	{
+		draw(renderer, Rect{pos, m_size}, std::forward<F>(paint));
+	}
+
+	/// Same, stretched to dest.
+	template<typename F>
+	void draw(Renderer &renderer, const Rect &dest, F &&paint)
+	{
+		if (renderer.culling() && !dest.intersects(renderer.visibleArea()))
+			return;
+
+		if (m_valid) {
+			++m_stats.hits;
+		} else {
+			repaint(renderer, paint);
+			++m_stats.repaints;
+		}
+		renderer.copy(m_texture, Rect{0, 0, m_size.x, m_size.y}, dest);
+	}
+
+	/// The cached content, valid only while valid().
+	Texture &texture() { return m_texture; }
+
+private:
+	template<typename F>
+	void repaint(Renderer &renderer, F &paint)
+	{
+		if (!m_texture.ptr()) {
+			m_texture = Texture{renderer.ptr(), m_size, m_format, SDL_TEXTUREACCESS_TARGET};
+			if (!setPremultipliedBlending())
+				m_texture.setBlendMode(SDL_BLENDMODE_BLEND);
+		}
+
+		Renderer::TargetScope scope{renderer, m_texture};
+		renderer.clear(Color::Transparent);
+		paint(renderer);
+		m_valid = true;
+	}
+
+	bool setPremultipliedBlending()
+	{
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+		if (m_texture.setBlendMode(Texture::premultipliedBlendMode(), std::nothrow))
+			return true;
+		Error::clear();
+#endif
+		return false;
+	}
+
+	Vec2i m_size;
+	SDL_PixelFormatEnum m_format;
+	Texture m_texture;
+	bool m_valid = false;
+	bool m_hasKey = false;
+	Uint64 m_key = 0;
+	Stats m_stats;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,181 @@
+/*
+** SDL++, 2020
+** ControllerState.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "GameController.hpp"
+#include "Joystick.hpp"
+
+#include <SDL2/SDL_gamecontroller.h>
+#include <SDL2/SDL_joystick.h>
+#include <SDL2/SDL_stdinc.h>
+
+#include <atomic>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Every input of one controller or joystick at one poll, with the button
+/// edges since the poll before.
+///
+/// A plain value that can be kept for replay; ControllerPoller::latest()
+/// hands consistent copies to another thread. Axes are dead-zoned; inputs
+/// beyond the maximums below are ignored.
+struct ControllerState
+{
+	static constexpr int maxAxes = 8;
+	static constexpr int maxButtons = 64;
+	static constexpr int maxHats = 4;
+
+	Sint16 axes[maxAxes] = {};
+	Uint64 buttons = 0;
+	Uint64 pressed = 0;
+	Uint64 released = 0;
+	Uint8 hats[maxHats] = {};
+	Uint8 axisCount = 0;
+	Uint8 buttonCount = 0;
+	Uint8 hatCount = 0;
+	bool attached = false;
+	/// Axes and buttons are in SDL_GameControllerAxis and
+	/// SDL_GameControllerButton order, else raw joystick indices.
+	bool gameController = false;
+	SDL_JoystickID id = -1;
+	/// Number of the ControllerPoller::poll() that captured the state.
+	Uint32 frame = 0;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Sint16 axis(int i) const { return i >= 0 && i < maxAxes ? axes[i] : 0; }
+
+	/// Axis in [-1, 1].
+	float axisf(int i) const { return float(axis(i)) / 32767.0f; }
+
+	bool button(int i) const { return i >= 0 && i < maxButtons && (buttons >> i & 1); }
+	bool wasPressed(int i) const { return i >= 0 && i < maxButtons && (pressed >> i & 1); }
+	bool wasReleased(int i) const { return i >= 0 && i < maxButtons && (released >> i & 1); }
+
+	Uint8 hat(int i) const { return i >= 0 && i < maxHats ? hats[i] : Uint8(SDL_HAT_CENTERED); }
+
+	Sint16 axis(SDL_GameControllerAxis a) const { return axis(int(a)); }
+	float axisf(SDL_GameControllerAxis a) const { return axisf(int(a)); }
+	bool button(SDL_GameControllerButton b) const { return button(int(b)); }
+	bool wasPressed(SDL_GameControllerButton b) const { return wasPressed(int(b)); }
+	bool wasReleased(SDL_GameControllerButton b) const { return wasReleased(int(b)); }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Captures ControllerState snapshots of a set of game controllers and
+/// joysticks in one pass per frame, under a single joystick lock, instead
+/// of one locked SDL call per input read.
+///
+/// Devices are referenced, not owned, and must stay open while added.
+/// Game controllers report their axes and buttons in SDL_GameControllerAxis
+/// and SDL_GameControllerButton order. A detached device reads as released.
+///
+/// The poller belongs to the thread calling poll(); one other thread can
+/// read the snapshots through latest(), which never blocks nor sees a
+/// half-written poll.
+class ControllerPoller
+{
+public:
+	/// Magnitudes up to the threshold read as 0, the rest is rescaled to
+	/// the full range. Sticks are dead-zoned by their distance from the
+	/// center, so diagonals are not squared off; on raw joysticks, axes 0
+	/// and 1, 2 and 3 and so on are taken as sticks unless radial is false.
+	/// Triggers, on game controllers, are dead-zoned on their own.
+	struct DeadZone
+	{
+		Sint16 stick = 8000;
+		Sint16 trigger = 3855;
+		bool radial = true;
+	};
+
+	ControllerPoller();
+	explicit ControllerPoller(const DeadZone &deadZone);
+
+	/// Not while another thread reads latest().
+	ControllerPoller(ControllerPoller &&other) noexcept;
+	ControllerPoller &operator =(ControllerPoller &&other) noexcept;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Returns the index of the device's state.
+	size_t add(const GameController &controller);
+	size_t add(const Joystick &joystick);
+
+	/// Removes the device with that instance id, moving the last state to
+	/// its index. Returns false if unknown.
+	bool remove(SDL_JoystickID id);
+	void clear();
+
+	size_t size() const { return m_devices.size(); }
+
+	const DeadZone &deadZone() const { return m_deadZone; }
+	void setDeadZone(const DeadZone &deadZone);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Captures every device, then publishes the states for latest().
+	/// Event pumping (SDL_PollEvent() or SDL_JoystickUpdate()) must have
+	/// happened before.
+	void poll();
+
+	Uint32 frame() const { return m_frame; }
+
+	const ControllerState &operator [](size_t i) const { return m_states[i]; }
+	const std::vector<ControllerState> &states() const { return m_states; }
+
+	/// nullptr if no device has that instance id.
+	const ControllerState *find(SDL_JoystickID id) const;
+
+	/// From one other thread: the states of the latest poll(), lock-free.
+	/// The vector stays unchanged until the next call.
+	const std::vector<ControllerState> &latest();
+
+private:
+	struct Device
+	{
+		SDL_GameController *controller;
+		SDL_Joystick *joystick;
+	};
+
+	size_t add(SDL_GameController *controller, SDL_Joystick *joystick);
+	void updateThresholds(size_t device);
+	void capture(size_t device);
+
+	DeadZone m_deadZone;
+	std::vector<Device> m_devices;
+	std::vector<ControllerState> m_states;
+	Uint32 m_frame = 0;
+
+	// Raw axes of every device back to back, with per axis dead zones, for
+	// one pass over all of them. paired is 1 for stick axes, dead-zoned
+	// with their neighbour (index ^ 1), 0 for axes on their own.
+	std::vector<Sint16> m_raw;
+	std::vector<float> m_threshold;
+	std::vector<float> m_scale;
+	std::vector<float> m_paired;
+
+	// Triple buffer: poll() fills the back buffer and swaps it with the
+	// shared one, marking it fresh; latest() swaps its front buffer with the
+	// shared one when fresh. Each side only ever touches its own buffer.
+	static constexpr int fresh = 4;
+	std::vector<ControllerState> m_buffers[3];
+	int m_back = 0;
+	std::atomic<int> m_shared{1};
+	int m_front = 2;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -97,25 +97,25 @@ public:
 	void wait()
 	{
 		if (!SDL_WaitEvent(ptr()))
-			throw Exception{"SDL_WaitEvent"};
+			SDLPP_THROW(Exception{"SDL_WaitEvent"});
 	}
 
 	void wait(int timeout)
 	{
 		if (!SDL_WaitEventTimeout(ptr(), timeout))
-			throw Exception{"SDL_WaitEventTimeout"};
+			SDLPP_THROW(Exception{"SDL_WaitEventTimeout"});
 	}
 
 	void push() const
 	{
 		if (!SDL_PushEvent(const_cast<SDL_Event*>(ptr())))
-			throw Exception{"SDL_PushEvent"};
+			SDLPP_THROW(Exception{"SDL_PushEvent"});
 	}
 
 	void peek()
 	{
 		if (SDL_PeepEvents(ptr(), 1, SDL_PEEKEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) < 0)
-			throw Exception{"SDL_PeepEvents"};
+			SDLPP_THROW(Exception{"SDL_PeepEvents"});
 	}
 
 
@@ -131,7 +131,7 @@ public:
 	{
 		auto array = const_cast<SDL_Event*>(reinterpret_cast<const SDL_Event*>(&events[0]));
 		if (SDL_PeepEvents(array, int(events.size()), SDL_ADDEVENT, minType, maxType) < 0)
-			throw Exception{"SDL_PeepEvents"};
+			SDLPP_THROW(Exception{"SDL_PeepEvents"});
 	}
 
 	void addEvents(const std::vector<Event> &events) { addEvents(events, SDL_FIRSTEVENT, SDL_LASTEVENT); }
@@ -142,7 +142,7 @@ public:
 		auto res = std::vector<Event>(maxEvents);
 		auto array = reinterpret_cast<SDL_Event*>(&res[0]);
 		if (SDL_PeepEvents(array, int(maxEvents), SDL_PEEKEVENT, minType, maxType) < 0)
-			throw Exception{"SDL_PeepEvents"};
+			SDLPP_THROW(Exception{"SDL_PeepEvents"});
 		return res;
 	}
 
@@ -154,7 +154,7 @@ public:
 		auto res = std::vector<Event>(maxEvents);
 		auto array = reinterpret_cast<SDL_Event*>(&res[0]);
 		if (SDL_PeepEvents(array, int(maxEvents), SDL_GETEVENT, minType, maxType) < 0)
-			throw Exception{"SDL_PeepEvents"};
+			SDLPP_THROW(Exception{"SDL_PeepEvents"});
 		return res;
 	}
 
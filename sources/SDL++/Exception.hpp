@@ -10,13 +10,38 @@
 #include "Error.hpp"
 
 #include <SDL2/SDL_error.h>
+#include <SDL2/SDL_log.h>
 
+#include <cstdlib>
 #include <stdexcept>
 #include <string>
 #include <string_view>
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// The headers compile with exceptions disabled (-fno-exceptions, /EHs-c-):
+// errors the throwing API would raise are then logged and abort. Code built
+// that way calls the std::nothrow overloads, which return a Status instead.
+//
+// SDLPP_TRY and SDLPP_CATCH guard code that must survive a throwing callback;
+// without exceptions the handler is compiled but never runs, so it must not
+// use the caught object.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define SDLPP_EXCEPTIONS 1
+#define SDLPP_THROW(exception) throw exception
+#define SDLPP_TRY try
+#define SDLPP_CATCH(declaration) catch (declaration)
+#define SDLPP_RETHROW throw
+#else
+#define SDLPP_EXCEPTIONS 0
+#define SDLPP_THROW(exception) ::SDL::Exception::abort(exception)
+#define SDLPP_TRY if (true)
+#define SDLPP_CATCH(declaration) else
+#define SDLPP_RETHROW std::abort()
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
 namespace SDL
 {
 
@@ -33,6 +58,13 @@ public:
 
 	const char *what() const noexcept override { return m_what.c_str(); }
 
+	/// SDLPP_THROW() without exception support.
+	[[noreturn]] static void abort(const Exception &e)
+	{
+		SDL_LogCritical(SDL_LOG_CATEGORY_ERROR, "%s", e.what());
+		std::abort();
+	}
+
 private:
 	std::string m_what;
 };
@@ -0,0 +1,113 @@
+/*
+** SDL++, 2020
+** FrameCapture.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Rect.hpp"
+#include "Render.hpp"
+#include "Surface.hpp"
+
+#include <SDL2/SDL_pixels.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Frame recorder reading the render target into a ring of surfaces and
+/// handing them to a writer on a worker thread.
+///
+/// capture() only does the readback (which SDL requires on the rendering
+/// thread); encoding and file output run on the worker. When every slot is
+/// still waiting for the writer the frame is dropped, or capture() waits if
+/// constructed with Overflow::Wait. The writer sees each surface until it
+/// returns; exceptions it throws are counted and the capture goes on.
+class FrameCapture
+{
+public:
+	using Writer = std::function<void(const Surface &frame, Uint64 index)>;
+
+	enum class Overflow
+	{
+		Drop,
+		Wait
+	};
+
+	struct Stats
+	{
+		Uint64 captured = 0;
+		Uint64 dropped = 0;
+		Uint64 written = 0;
+		Uint64 writeErrors = 0;
+	};
+
+	explicit FrameCapture(Writer writer, size_t slots = 4, Overflow overflow = Overflow::Drop, Uint32 format = SDL_PIXELFORMAT_ARGB8888);
+
+	FrameCapture(const FrameCapture&) = delete;
+
+	/// Writes the frames still queued, then stops the worker.
+	~FrameCapture();
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Queues the viewport of the current target. Returns false if the frame
+	/// was dropped.
+	bool capture(const Renderer &renderer);
+	bool capture(const Renderer &renderer, const Rect &area);
+
+	/// Waits until every queued frame has been written.
+	void flush();
+
+	Stats stats() const;
+
+	/// Writer saving frames as prefix + zero-padded index + ".bmp".
+	static Writer bmpWriter(const std::string &prefix);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	FrameCapture &operator =(const FrameCapture&) = delete;
+
+private:
+	struct Slot
+	{
+		Surface surface{nullptr};
+		Uint64 index = 0;
+	};
+
+	void workerLoop();
+
+	Writer m_writer;
+	Overflow m_overflow;
+	Uint32 m_format;
+
+	std::vector<Slot> m_slots;
+	std::vector<size_t> m_free;
+	std::deque<size_t> m_queue;
+	size_t m_writing = 0;
+	Uint64 m_next = 0;
+	Stats m_stats;
+	bool m_stopping = false;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_idle;
+	std::thread m_worker;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -32,7 +32,7 @@ public:
 	: m_controller(SDL_GameControllerOpen(joystickIndex))
 	{
 		if (!m_controller)
-			throw Exception("SDL_GameControllerOpen");
+			SDLPP_THROW(Exception("SDL_GameControllerOpen"));
 	}
 
 	explicit GameController(SDL_GameController *controller)
@@ -101,7 +101,7 @@ public:
 	{
 		const char *n = SDL_GameControllerNameForIndex(joystick_index);
 		if (!n)
-			throw Exception("SDL_GameControllerNameForIndex");
+			SDLPP_THROW(Exception("SDL_GameControllerNameForIndex"));
 		return {n};
 	}
 
@@ -122,12 +122,13 @@ public:
 		return loadMappingDatabase(filePath.c_str());
 	}
 
-	///Load a file database
+	///Load a file database. SDL parses every line at once; MappingDatabase
+	///only adds the mappings of connected joysticks.
 	static int loadMappingDatabase(const char *filePath)
 	{
 		const auto state = SDL_GameControllerAddMappingsFromFile(filePath);
 		if (state < 0)
-			throw Exception("SDL_GameControllerAddMappingsFromFile");
+			SDLPP_THROW(Exception("SDL_GameControllerAddMappingsFromFile"));
 		return state;
 	}
 
@@ -140,7 +141,7 @@ public:
 	{
 		const auto state = SDL_GameControllerAddMapping(mappingString);
 		if (state < 0)
-			throw Exception("SDL_GameControllerAddMapping");
+			SDLPP_THROW(Exception("SDL_GameControllerAddMapping"));
 		return state;
 	}
 
@@ -150,12 +151,8 @@ public:
 
 		for (int nb_sticks = SDL_NumJoysticks(), i = 0; i < nb_sticks; ++i) {
 			if (SDL_IsGameController(i)) {
-				try {
-					controllers.emplace_back(i);
-				}
-				catch (const SDL::Exception&) {
-					continue;
-				}
+				if (SDL_GameController *c = SDL_GameControllerOpen(i))
+					controllers.emplace_back(c);
 			}
 		}
 
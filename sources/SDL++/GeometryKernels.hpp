@@ -0,0 +1,64 @@
+/*
+** SDL++, 2020
+** GeometryKernels.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <SDL2/SDL_rect.h>
+#include <SDL2/SDL_stdinc.h>
+
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// SIMD loops over coordinates stored as separate x and y (and w and h)
+/// arrays, behind Vec2Array and RectArray.
+///
+/// Dispatch follows the instruction set selected in PixelKernels.hpp; NEON
+/// and CPUs without SSE2 take the scalar loops. Results are identical on
+/// every path. Arrays may be unaligned; in-place functions may not alias
+/// x with y.
+namespace SDL::Kernels
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+void translatePoints(float *x, float *y, size_t n, float dx, float dy);
+void translatePoints(int *x, int *y, size_t n, int dx, int dy);
+void scalePoints(float *x, float *y, size_t n, float sx, float sy);
+
+/// Zero-length vectors are left unchanged.
+void normalizePoints(float *x, float *y, size_t n);
+void pointLengths(const float *x, const float *y, float *lengths, size_t n);
+
+void clampPoints(float *x, float *y, size_t n, float minX, float minY, float maxX, float maxY);
+void clampPoints(int *x, int *y, size_t n, int minX, int minY, int maxX, int maxY);
+
+/// Componentwise minimum and maximum; n must not be 0.
+void pointBounds(const float *x, const float *y, size_t n, float &minX, float &minY, float &maxX, float &maxY);
+void pointBounds(const int *x, const int *y, size_t n, int &minX, int &minY, int &maxX, int &maxY);
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Writes 1 to mask[i] for every rectangle containing the point (with the
+/// half-open bounds of Rect::contains), 0 otherwise. Returns the number of 1s.
+size_t rectsContaining(const int *x, const int *y, const int *w, const int *h, size_t n, int px, int py, Uint8 *mask);
+
+/// Same as rectsContaining() with Rect::intersects against area.
+size_t rectsIntersecting(const int *x, const int *y, const int *w, const int *h, size_t n, const SDL_Rect &area, Uint8 *mask);
+
+/// rectsIntersecting() and a point version of rectsContaining() for arrays
+/// of SDL_Rect and SDL_Point, as submitted to the renderer.
+size_t rectsIntersecting(const SDL_Rect *rects, size_t n, const SDL_Rect &area, Uint8 *mask);
+size_t pointsInside(const SDL_Point *points, size_t n, const SDL_Rect &area, Uint8 *mask);
+
+/// Smallest rectangle enclosing every rectangle, empty ones included; n must
+/// not be 0.
+SDL_Rect rectBounds(const int *x, const int *y, const int *w, const int *h, size_t n);
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -7,9 +7,16 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "Exception.hpp"
+#include "SlotMap.hpp"
+#include "Status.hpp"
+
 #include <SDL2/SDL_haptic.h>
 
-#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -18,108 +25,153 @@ namespace SDL
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// A haptic device and the effects installed on it.
+///
+/// Installed effects live in a generational slot map, so installing,
+/// running and destroying one is O(1) and handles to destroyed effects stay
+/// harmless. Destroyed effects are kept on the device, up to
+/// idleEffectLimit(), and reinstalled with SDL_HapticUpdateEffect() when an
+/// effect of the same type is created, instead of destroying and creating
+/// device effects for every transient rumble. Handles must not outlive
+/// their Haptic, but stay valid when it is moved.
 class Haptic
 {
-	SDL_Haptic *m_haptic = nullptr;
-
+public:
 	using EffectId = int;
-	using EffectList = std::vector<EffectId>;
 
-	EffectList myEffects{};
+	union Effect
+	{
+		Uint16              type;      /// Effect type.
+		SDL_HapticConstant  constant;  /// Constant effect.
+		SDL_HapticPeriodic  periodic;  /// Periodic effect.
+		SDL_HapticCondition condition; /// Condition effect.
+		SDL_HapticRamp      ramp;      /// Ramp effect.
+		SDL_HapticLeftRight leftright; /// Left/Right effect.
+		SDL_HapticCustom    custom;    /// Custom effect.
+
+		operator SDL_HapticEffect*() const
+		{
+			return (SDL_HapticEffect*)(this);
+		}
 
-public:
-	SDL_Haptic *ptr() const { return m_haptic; }
+		/// Byte-wise, which the zeroing constructor makes reliable.
+		bool operator ==(const Effect &other) const { return SDL_memcmp(this, &other, sizeof(Effect)) == 0; }
+		bool operator !=(const Effect &other) const { return !(*this == other); }
 
-	class InstalledEffect
+		Effect()
+		{
+			static_assert(sizeof(Effect::type) == sizeof(SDL_HapticEffect::type), "Please compare the layout between SDL_HapticEffect and sdl::Haptic::Effect");
+			static_assert(sizeof(Effect) == sizeof(SDL_HapticEffect), "Please compare the layout between SDL_HapticEffect and sdl::Haptic::Effect");
+
+			SDL_memset(this, 0, sizeof(Effect));
+		}
+	};
+
+private:
+	struct InstalledSlot
 	{
-		static constexpr EffectList::size_type invalidIndex = std::numeric_limits<EffectList::size_type>::max();
-		EffectList::size_type m_index = invalidIndex;
-		Haptic *m_owner = nullptr;
-		friend class Haptic;
+		EffectId id = -1;
+		Effect effect;
+	};
 
-		void from(InstalledEffect &)
-		{}
+	// Behind a pointer so that moving the Haptic keeps handles valid.
+	struct Effects
+	{
+		SDL_Haptic *haptic = nullptr;
+		SlotMap<InstalledSlot> installed;
+		std::vector<InstalledSlot> idle;
+		size_t idleLimit = 8;
+
+		/// -1 if the device has no room left, even after freeing idle effects.
+		EffectId acquire(const Effect &e);
+		void release(SlotMap<InstalledSlot>::Key key);
+	};
 
+public:
+	class InstalledEffect
+	{
 	public:
-		InstalledEffect(EffectList::size_type index, Haptic *owner)
-		: m_index{index}
-		, m_owner{owner}
-		{}
-
 		InstalledEffect() = default;
-		InstalledEffect(const InstalledEffect&);
-		InstalledEffect &operator=(const InstalledEffect&);
+
+		InstalledEffect(const InstalledEffect&) = delete;
+		InstalledEffect &operator=(const InstalledEffect&) = delete;
 
 		InstalledEffect(InstalledEffect &&other) noexcept
-		{
-			*this = std::move(other);
-		}
+		: m_effects{std::exchange(other.m_effects, nullptr)}
+		, m_key{std::exchange(other.m_key, {})}
+		{}
 
 		InstalledEffect &operator=(InstalledEffect &&other) noexcept
 		{
-			if (m_index != other.m_index) {
-				m_index = other.m_index;
-				m_owner = other.m_owner;
-				other.m_index = invalidIndex;
-				other.m_owner = nullptr;
+			if (this != &other) {
+				reset();
+				m_effects = std::exchange(other.m_effects, nullptr);
+				m_key = std::exchange(other.m_key, {});
 			}
 			return *this;
 		}
 
-		~InstalledEffect()
-		{
-			if (m_owner && m_index != invalidIndex) {
-				const EffectId myRealId = m_owner->getEffectId(*this);
-				SDL_HapticDestroyEffect(m_owner->ptr(), myRealId);
-				m_owner->removeEffect(myRealId);
-			}
-		}
+		~InstalledEffect() { reset(); }
 
-		void run(uint32_t iterations = 1)
+		/// Whether the effect is still installed.
+		bool valid() const { return m_effects && m_effects->installed.contains(m_key); }
+		explicit operator bool() const { return valid(); }
+
+		/// Uninstalls the effect.
+		void reset()
 		{
-			m_owner->runEffect(*this, iterations);
+			if (m_effects)
+				m_effects->release(m_key);
+			m_effects = nullptr;
+			m_key = {};
 		}
-	};
 
-	union Effect
-	{
-		Uint16              type;      /// Effect type.
-		SDL_HapticConstant  constant;  /// Constant effect.
-		SDL_HapticPeriodic  periodic;  /// Periodic effect.
-		SDL_HapticCondition condition; /// Condition effect.
-		SDL_HapticRamp      ramp;      /// Ramp effect.
-		SDL_HapticLeftRight leftright; /// Left/Right effect.
-		SDL_HapticCustom    custom;    /// Custom effect.
+		void run(Uint32 iterations = 1);
+		void stop();
 
-		operator SDL_HapticEffect*() const
-		{
-			return (SDL_HapticEffect*)(this);
-		}
+		/// Changes the parameters of the effect, which may be running; the type
+		/// must stay the same. No-ops when they are unchanged.
+		void update(const Effect &e);
 
-		Effect()
-		{
-			static_assert(sizeof(Effect::type) == sizeof(SDL_HapticEffect::type), "Please compare the layout between SDL_HapticEffect and sdl::Haptic::Effect");
-			static_assert(sizeof(Effect) == sizeof(SDL_HapticEffect), "Please compare the layout between SDL_HapticEffect and sdl::Haptic::Effect");
+		Status run(Uint32 iterations, std::nothrow_t) noexcept;
+		Status stop(std::nothrow_t) noexcept;
+		Status update(const Effect &e, std::nothrow_t) noexcept;
 
-			SDL_memset(this, 0, sizeof(Effect));
-		}
+		/// The parameters last given to the device.
+		const Effect *effect() const;
+
+	private:
+		friend class Haptic;
+
+		InstalledEffect(Effects *effects, SlotMap<InstalledSlot>::Key key)
+		: m_effects{effects}
+		, m_key{key}
+		{}
+
+		Effects *m_effects = nullptr;
+		SlotMap<InstalledSlot>::Key m_key;
 	};
 
-	Haptic()
-	{}
+	////////////////////////////////////////////////////////////////////////////
+
+	Haptic() = default;
 
 	explicit Haptic(int m_hapticindex)
 	: m_haptic{SDL_HapticOpen(m_hapticindex)}
 	{
 		if (!m_haptic)
-			throw Exception("SDL_HapticOpen");
+			SDLPP_THROW(Exception("SDL_HapticOpen"));
+		m_effects = std::make_unique<Effects>();
+		m_effects->haptic = m_haptic;
 	}
 
 	explicit Haptic(SDL_Joystick *joystick)
 	: m_haptic{SDL_HapticOpenFromJoystick(joystick)}
 	{
 		if (!m_haptic)
-			throw Exception("SDL_HapticOpenFromJoystick");
+			SDLPP_THROW(Exception("SDL_HapticOpenFromJoystick"));
+		m_effects = std::make_unique<Effects>();
+		m_effects->haptic = m_haptic;
 	}
 
 	~Haptic()
@@ -134,14 +186,17 @@ public:
 	Haptic(Haptic&& other) noexcept { *this = std::move(other); }
 	Haptic& operator=(Haptic&& other) noexcept
 	{
-		if (m_haptic != other.m_haptic) {
-			m_haptic = other.m_haptic;
-			myEffects = std::move(other.myEffects);
-			other.m_haptic = nullptr;
+		if (this != &other) {
+			if (m_haptic)
+				SDL_HapticClose(m_haptic);
+			m_haptic = std::exchange(other.m_haptic, nullptr);
+			m_effects = std::move(other.m_effects);
 		}
 		return *this;
 	}
 
+	SDL_Haptic *ptr() const { return m_haptic; }
+
 	bool valid() const { return m_haptic != nullptr; }
 
 	unsigned getCapabilities() const
@@ -152,7 +207,7 @@ public:
 		const auto capabilities = SDL_HapticQuery(m_haptic);
 
 		if (!capabilities)
-			throw Exception("SDL_HapticQuery");
+			SDLPP_THROW(Exception("SDL_HapticQuery"));
 
 		return capabilities;
 	}
@@ -162,50 +217,36 @@ public:
 		return (m_hapticflag & getCapabilities()) != 0;
 	}
 
-	InstalledEffect newEffect(const Effect &e)
+	bool isEffectCompatible(const Effect &e) const
 	{
-		if (!isCapableOf(e.type))
-			return {};
+		return isCapableOf(e.type);
+	}
 
-		const EffectId rawId = SDL_HapticNewEffect(m_haptic, e);
-		if (rawId < 0)
-			throw Exception("SDL_HapticNewEffect");
+	////////////////////////////////////////////////////////////////////////////
 
-		myEffects.push_back(rawId);
-		return {myEffects.size() - 1, this};
-	}
+	/// An empty handle if the device does not support the effect type.
+	InstalledEffect newEffect(const Effect &e);
+	Result<InstalledEffect> newEffect(const Effect &e, std::nothrow_t);
 
-	EffectList::size_type registeredEffectCount() const
-	{
-		return myEffects.size();
-	}
+	void runEffect(const InstalledEffect &h, Uint32 iterations = 1) const;
+	void stopEffect(const InstalledEffect &h) const;
+	void updateEffect(const InstalledEffect &h, const Effect &e) const;
 
-	EffectId getEffectId(const InstalledEffect &h) const
-	{
-		return myEffects.at(h.m_index);
-	}
+	/// The device's id of the effect, -1 once destroyed.
+	EffectId getEffectId(const InstalledEffect &h) const;
 
-	void removeEffect(EffectId e)
-	{
-		for (size_t i = 0, nbEffects = myEffects.size(); i < nbEffects; ++i) {
-			if (myEffects[i] == e)
-				myEffects[i] = -1;
-		}
-	}
+	size_t registeredEffectCount() const { return m_effects ? m_effects->installed.size() : 0; }
 
-	void runEffect(const InstalledEffect &h, uint32_t iterations = 1) const
-	{
-		const EffectId e = getEffectId(h);
-		if (e >= 0 && SDL_HapticRunEffect(m_haptic, getEffectId(h), iterations) < 0)
-			throw Exception("SDL_HapticRunEffect");
-	}
+	/// Destroyed effects kept on the device for reuse.
+	size_t idleEffectCount() const { return m_effects ? m_effects->idle.size() : 0; }
+	size_t idleEffectLimit() const { return m_effects ? m_effects->idleLimit : 0; }
+	void setIdleEffectLimit(size_t limit);
 
-	bool isEffectCompatible(const Effect &e) const
-	{
-		return isCapableOf(e.type);
-	}
+private:
+	SDL_Haptic *m_haptic = nullptr;
+	std::unique_ptr<Effects> m_effects;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
-}
\ No newline at end of file
+}
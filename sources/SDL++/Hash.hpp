@@ -0,0 +1,49 @@
+/*
+** SDL++, 2020
+** Hash.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <cstddef>
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL::Hash
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+constexpr Uint64 fnvOffset = 0xCBF29CE484222325ULL;
+constexpr Uint64 fnvPrime  = 0x00000100000001B3ULL;
+
+/// 64-bit FNV-1a, stable across runs and platforms so it can be stored on disk.
+inline Uint64 fnv1a(const void *data, size_t size, Uint64 seed = fnvOffset)
+{
+	auto bytes = static_cast<const Uint8*>(data);
+	Uint64 h = seed;
+	for (size_t i = 0; i < size; ++i) {
+		h ^= bytes[i];
+		h *= fnvPrime;
+	}
+	return h;
+}
+
+constexpr Uint64 fnv1a(std::string_view str, Uint64 seed = fnvOffset)
+{
+	Uint64 h = seed;
+	for (char c : str) {
+		h ^= static_cast<Uint8>(c);
+		h *= fnvPrime;
+	}
+	return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,188 @@
+/*
+** SDL++, 2020
+** InputSampler.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ControllerState.hpp"
+#include "SpscRing.hpp"
+#include "Timer.hpp"
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Latencies in power-of-two microsecond buckets, from below 1 us to above
+/// 2^22 us (about 4 s).
+class LatencyHistogram
+{
+public:
+	static constexpr int bucketCount = 24;
+
+	void add(Uint64 ticks, Uint64 frequency)
+	{
+		const auto us = static_cast<Uint64>(double(ticks) * 1e6 / double(frequency));
+		int b = 0;
+		while (b < bucketCount - 1 && (Uint64(1) << b) <= us)
+			++b;
+		++m_buckets[b];
+		++m_count;
+		m_sumUs += us;
+		m_maxUs = us > m_maxUs ? us : m_maxUs;
+	}
+
+	void reset() { *this = LatencyHistogram{}; }
+
+	Uint64 count() const { return m_count; }
+	Uint64 maxUs() const { return m_maxUs; }
+	double meanUs() const { return m_count ? double(m_sumUs) / double(m_count) : 0.0; }
+
+	/// Samples under bucketLimitUs(b): b = 0 counts latencies below 1 us,
+	/// b = n those in [2^(n-1), 2^n) us, the last bucket everything above.
+	Uint64 bucket(int b) const { return m_buckets[b]; }
+	static Uint64 bucketLimitUs(int b) { return Uint64(1) << b; }
+
+	/// Upper bound of the bucket holding the p-th fraction of the samples,
+	/// p in [0, 1].
+	Uint64 percentileUs(double p) const
+	{
+		const double target = p * double(m_count);
+		Uint64 seen = 0;
+		for (int b = 0; b < bucketCount; ++b) {
+			seen += m_buckets[b];
+			if (seen > 0 && double(seen) >= target)
+				return bucketLimitUs(b);
+		}
+		return 0;
+	}
+
+private:
+	Uint64 m_buckets[bucketCount] = {};
+	Uint64 m_count = 0;
+	Uint64 m_sumUs = 0;
+	Uint64 m_maxUs = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Samples controllers more often than the game loop runs, timestamping
+/// every change with Timer::perfCounter() and handing the snapshots to the
+/// game thread through a lock-free ring.
+///
+/// Mode::Thread polls on a dedicated thread at the given interval; only
+/// joystick and controller input can be read off the main thread, and not
+/// on every platform (threadSupported()). Mode::SubFrame polls from
+/// sample(), which the main thread calls between chunks of frame work, and
+/// also pumps window events there. Either way only snapshots that differ
+/// from the previous one of their device are queued, so every press and
+/// release reaches consume() even if both happen within a frame. When the
+/// ring is full the change stays pending and is retried on the next poll;
+/// buttons pressed and released again meanwhile come back as one coalesced
+/// sample, so no edge is lost, only repeats of it.
+class InputSampler
+{
+public:
+	enum class Mode
+	{
+		Thread,
+		SubFrame,
+	};
+
+	struct Sample
+	{
+		Uint64 timestamp;
+		ControllerState state;
+	};
+
+	/// Thread mode falls back to SubFrame where threadSupported() is false.
+	/// The poller's devices must stay open while the sampler runs.
+	InputSampler(ControllerPoller poller, Mode mode, std::chrono::microseconds interval = std::chrono::microseconds{1000}, size_t capacity = 1024);
+
+	InputSampler(const InputSampler&) = delete;
+	InputSampler &operator =(const InputSampler&) = delete;
+
+	~InputSampler();
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Whether joysticks can be polled off the main thread here.
+	static bool threadSupported();
+
+	Mode mode() const { return m_mode; }
+	bool running() const { return m_thread.joinable(); }
+
+	/// Stops and restarts the sampling thread, e.g. to add or remove
+	/// devices through poller() in between. No-ops in SubFrame mode.
+	void start();
+	void stop();
+
+	/// Only while stopped in Thread mode.
+	ControllerPoller &poller() { return m_poller; }
+
+	/// SubFrame mode, main thread: pumps events and polls if the interval
+	/// has passed since the last poll. Returns the number of samples queued.
+	size_t sample();
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Game thread: calls fn(const Sample&) for every queued sample, oldest
+	/// first, recording the time each one waited into latency().
+	template<typename F>
+	size_t consume(F &&fn)
+	{
+		const Uint64 frequency = Timer::perfFrequency();
+		size_t n = 0;
+		Sample s;
+		while (m_ring.pop(s)) {
+			m_latency.add(Timer::perfCounter() - s.timestamp, frequency);
+			fn(static_cast<const Sample&>(s));
+			++n;
+		}
+		return n;
+	}
+
+	const LatencyHistogram &latency() const { return m_latency; }
+	void resetLatency() { m_latency.reset(); }
+
+	/// Pushes that found the ring full and were retried later.
+	Uint64 dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+	/// Extra samples queued to replay buttons that bounced while it was full.
+	Uint64 coalesced() const { return m_coalesced.load(std::memory_order_relaxed); }
+
+private:
+	void run();
+	size_t poll();
+
+	ControllerPoller m_poller;
+	Mode m_mode;
+	std::chrono::microseconds m_interval;
+	Uint64 m_intervalTicks;
+	Uint64 m_lastPoll = 0;
+	std::vector<ControllerState> m_published;
+	std::vector<Uint64> m_pending; ///< buttons changed since m_published, per device
+
+	SpscRing<Sample> m_ring;
+	std::atomic<Uint64> m_dropped{0};
+	std::atomic<Uint64> m_coalesced{0};
+	LatencyHistogram m_latency;
+
+	std::thread m_thread;
+	std::atomic<bool> m_stopping{false};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
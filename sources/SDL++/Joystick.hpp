@@ -43,7 +43,7 @@ public:
 	: m_joystick(SDL_JoystickOpen(index))
 	{
 		if (!m_joystick)
-			throw Exception("SDL_JoystickOpen");
+			SDLPP_THROW(Exception("SDL_JoystickOpen"));
 	}
 
 	explicit Joystick(SDL_Joystick *joystick)
@@ -64,6 +64,8 @@ public:
 
 	////////////////////////////////////////////////////////////////////////////
 
+	SDL_Joystick *ptr() const { return m_joystick; }
+
 	Haptic openHaptic() const
 	{
 		return Haptic(m_joystick);
@@ -73,7 +75,7 @@ public:
 	{
 		const auto power = SDL_JoystickCurrentPowerLevel(m_joystick);
 		if (power == SDL_JOYSTICK_POWER_UNKNOWN)
-			throw Exception("SDL_JoystickCurrentPowerLevel");
+			SDLPP_THROW(Exception("SDL_JoystickCurrentPowerLevel"));
 		return power;
 	}
 
@@ -92,7 +94,7 @@ public:
 		Vec2i d;
 		const int status = SDL_JoystickGetBall(m_joystick, ball, &d.x, &d.y);
 		if (status < 0)
-			throw Exception("SDL_JoystickGetBall");
+			SDLPP_THROW(Exception("SDL_JoystickGetBall"));
 		return d;
 	}
 
@@ -114,7 +116,7 @@ public:
 	{
 		const int value = SDL_JoystickNumHats(m_joystick);
 		if (value < 0)
-			throw Exception("SDL_JoystickNumHats");
+			SDLPP_THROW(Exception("SDL_JoystickNumHats"));
 		return value;
 	}
 
@@ -122,7 +124,7 @@ public:
 	{
 		const int value = SDL_JoystickNumButtons(m_joystick);
 		if (value < 0)
-			throw Exception("SDL_JoystickNumButtons");
+			SDLPP_THROW(Exception("SDL_JoystickNumButtons"));
 		return value;
 	}
 
@@ -130,7 +132,7 @@ public:
 	{
 		const int value = SDL_JoystickNumBalls(m_joystick);
 		if (value < 0)
-			throw Exception("SDL_JoystickNumBalls");
+			SDLPP_THROW(Exception("SDL_JoystickNumBalls"));
 		return value;
 	}
 
@@ -138,7 +140,7 @@ public:
 	{
 		const int value = SDL_JoystickNumAxes(m_joystick);
 		if (value < 0)
-			throw Exception("SDL_JoystickNumAxes");
+			SDLPP_THROW(Exception("SDL_JoystickNumAxes"));
 		return value;
 	}
 
@@ -146,7 +148,7 @@ public:
 	{
 		const auto value = SDL_JoystickInstanceID(m_joystick);
 		if (value < 0)
-			throw Exception("SDL_JoystickInstanceID");
+			SDLPP_THROW(Exception("SDL_JoystickInstanceID"));
 		return value;
 	}
 
@@ -161,7 +163,7 @@ public:
 	{
 		auto object = Joystick(SDL_JoystickFromInstanceID(id), false);
 		if (object.m_joystick == nullptr)
-			throw Exception("SDL_JoystickFromInstanceID");
+			SDLPP_THROW(Exception("SDL_JoystickFromInstanceID"));
 		return object;
 	}
 
@@ -0,0 +1,142 @@
+/*
+** SDL++, 2020
+** LooseQuadtree.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Rect.hpp"
+#include "Vec2.hpp"
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Quadtree over a square world whose nodes accept objects overflowing them
+/// by half their size, so every object lives in exactly one node, picked
+/// from its size and center without descending through the tree.
+///
+/// Handles mixed object sizes better than SpatialHash. Objects outside the
+/// world (or larger than it) are kept in the root and still found by
+/// queries. Nodes are created on demand and only reclaimed by rebuild().
+class LooseQuadtree
+{
+public:
+	using Id = Uint32;
+
+	/// The world is extended to a power-of-two square from world's corner;
+	/// maxDepth bounds the number of levels below the root.
+	explicit LooseQuadtree(const Rect &world, int maxDepth = 8);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const { return m_ids.size(); }
+	bool empty() const { return m_ids.empty(); }
+	size_t nodeCount() const { return m_nodes.size(); }
+	const Rect &world() const { return m_world; }
+
+	bool contains(Id id) const { return m_slots.count(id) != 0; }
+
+	/// Bounds of an object, nullptr if unknown.
+	const Rect *bounds(Id id) const;
+
+	/// Adds an object, or moves it if the id is already present.
+	void insert(Id id, const Rect &bounds);
+
+	/// Returns false if the id is unknown.
+	bool move(Id id, const Rect &bounds);
+	bool remove(Id id);
+
+	void clear();
+
+	/// Replaces the content, dropping empty nodes and laying out nodes and
+	/// objects in Z order for query locality. Of duplicate ids only the first
+	/// is kept.
+	void rebuild(const std::vector<std::pair<Id, Rect>> &objects);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Calls fn(id, bounds) for every object for which bounds.intersects(area).
+	template<typename F>
+	void query(const Rect &area, F &&fn) const
+	{
+		thread_local std::vector<Uint32> stack;
+		const size_t base = stack.size();
+		stack.push_back(0);
+
+		while (stack.size() > base) {
+			const Node &node = m_nodes[stack.back()];
+			stack.pop_back();
+
+			for (const auto &e : node.entries)
+				if (e.bounds.intersects(area))
+					fn(m_ids[e.slot], e.bounds);
+			for (Uint32 child : node.children)
+				if (child && m_nodes[child].loose.intersects(area))
+					stack.push_back(child);
+		}
+	}
+
+	void query(const Rect &area, std::vector<Id> &out) const
+	{
+		out.clear();
+		query(area, [&](Id id, const Rect&) { out.push_back(id); });
+	}
+
+	/// Objects for which bounds.contains(point).
+	void query(const Vec2i &point, std::vector<Id> &out) const
+	{
+		out.clear();
+		query(Rect{point.x, point.y, 1, 1}, [&](Id id, const Rect &bounds) {
+			if (bounds.contains(point))
+				out.push_back(id);
+		});
+	}
+
+private:
+	struct Entry
+	{
+		Rect bounds;
+		Uint32 slot;
+	};
+
+	struct Node
+	{
+		explicit Node(const Rect &loose)
+		: loose{loose}
+		{}
+
+		Rect loose;
+		Uint32 children[4] = {0, 0, 0, 0};
+		std::vector<Entry> entries;
+	};
+
+	Uint32 nodeFor(const Rect &bounds);
+	void link(Uint32 slot, Uint32 node);
+	void unlink(Uint32 slot);
+
+	Rect m_world;
+	int m_shift;
+	int m_maxDepth;
+
+	std::vector<Node> m_nodes;
+	std::unordered_map<Id, Uint32> m_slots;
+	std::vector<Id> m_ids;
+	std::vector<Rect> m_bounds;
+	std::vector<Uint32> m_nodeOf;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,41 @@
+/*
+** SDL++, 2020
+** Lz.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <cstddef>
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Byte-oriented LZ77 block codec in the spirit of LZ4: greedy matching on a
+/// hash of 4 bytes, 64 KiB window, no entropy coding. Compression runs at a
+/// few hundred MB/s and decompression at memory speed, which suits pixel data
+/// with long flat runs better than general-purpose compression ratios.
+///
+/// Blocks are self-contained and carry no size header; callers store the
+/// decompressed size themselves.
+namespace SDL::Lz
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Worst-case compressed size of size bytes.
+size_t bound(size_t size);
+
+/// Compresses src into dst and returns the compressed size, or 0 if the
+/// result does not fit in capacity bytes.
+size_t compress(const void *src, size_t size, void *dst, size_t capacity);
+
+/// Decompresses a block produced by compress() into exactly size bytes.
+/// Returns false on malformed or truncated input without writing outside dst.
+bool decompress(const void *src, size_t compressedSize, void *dst, size_t size);
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,83 @@
+/*
+** SDL++, 2020
+** MappedFile.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Exception.hpp"
+#include "Status.hpp"
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Read-only view of a whole file mapped in memory.
+///
+/// Pages are mapped copy-on-write: writing through data() never reaches the
+/// file, which lets surfaces be created directly over the mapping. Platforms
+/// without mmap (or MapViewOfFile) fall back to reading the file in memory.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+
+	explicit MappedFile(const std::string &filename);
+
+	/// Same, returning the failure instead of throwing.
+	static Result<MappedFile> open(const std::string &filename, std::nothrow_t);
+
+	MappedFile(const MappedFile&) = delete;
+
+	MappedFile(MappedFile &&other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	~MappedFile();
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Uint8 *data() const { return m_data; }
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+
+	////////////////////////////////////////////////////////////////////////////
+
+	MappedFile &operator =(const MappedFile&) = delete;
+
+	MappedFile &operator =(MappedFile &&other) noexcept
+	{
+		if (this != &other) {
+			unmap();
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+			m_mapped = std::exchange(other.m_mapped, false);
+		}
+		return *this;
+	}
+
+private:
+	Status map(const std::string &filename);
+	void unmap();
+
+	Uint8 *m_data = nullptr;
+	size_t m_size = 0;
+	bool m_mapped = false;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
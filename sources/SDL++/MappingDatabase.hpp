@@ -0,0 +1,176 @@
+/*
+** SDL++, 2020
+** MappingDatabase.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Events.hpp"
+#include "Exception.hpp"
+#include "MappedFile.hpp"
+
+#include <SDL2/SDL_joystick.h>
+#include <SDL2/SDL_platform.h>
+#include <SDL2/SDL_stdinc.h>
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Read-only game controller mapping index, built from SDL's text mapping
+/// database (gamecontrollerdb.txt) by MappingDatabaseWriter or the
+/// `sdlpp_mapindex` tool.
+///
+/// Opening maps the file and parses nothing; mappings are handed to SDL one
+/// at a time, only for the joysticks actually connected, instead of SDL
+/// parsing every line of the database at startup.
+///
+/// Layout: a fixed header, the entries sorted by GUID then platform hash
+/// (FNV-1a of the lowercase platform name, 0 for mappings without one),
+/// then the mapping lines, in database order.
+class MappingDatabase
+{
+public:
+	static constexpr char magic[4] = {'S', 'M', 'A', 'P'};
+	static constexpr Uint32 version = 2;
+
+	struct Header
+	{
+		char magic[4];
+		Uint32 version;
+		Uint32 entryCount;
+		Uint32 reserved;
+		Uint64 entriesOffset;
+		Uint64 textOffset;
+	};
+
+	struct Entry
+	{
+		Uint8 guid[16];
+		Uint64 platform;
+		Uint32 textOffset;
+		Uint32 textLength;
+	};
+
+	////////////////////////////////////////////////////////////////////////////
+
+	MappingDatabase() = default;
+
+	explicit MappingDatabase(const std::string &filename);
+
+	MappingDatabase(const MappingDatabase&) = delete;
+
+	MappingDatabase(MappingDatabase &&other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Of the mappings for that platform and without platform, the one that
+	/// came last in the database, as SDL keeps the last line it accepts.
+	/// Like SDL, retries with the GUID's CRC bytes cleared.
+	const Entry *find(const SDL_JoystickGUID &guid, std::string_view platform = SDL_GetPlatform()) const;
+
+	size_t entryCount() const { return m_header ? m_header->entryCount : 0; }
+	const Entry *begin() const { return m_entries; }
+	const Entry *end() const { return m_entries + entryCount(); }
+
+	std::string_view mapping(const Entry &e) const
+	{
+		return {m_text + e.textOffset, e.textLength};
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Adds the mapping of the joystick at that device index, if any and not
+	/// added yet; returns whether it did.
+	bool addMappingFor(int joystickIndex);
+
+	/// addMappingFor() on every connected joystick; returns how many.
+	size_t addConnected();
+
+	/// addMappingFor() on SDL_JOYDEVICEADDED; SDL then sends
+	/// SDL_CONTROLLERDEVICEADDED if the joystick became a game controller.
+	bool handle(const Event &event);
+
+	size_t addedCount() const { return m_addedCount; }
+
+	////////////////////////////////////////////////////////////////////////////
+
+	MappingDatabase &operator =(const MappingDatabase&) = delete;
+
+	MappingDatabase &operator =(MappingDatabase &&other) noexcept
+	{
+		if (this != &other) {
+			m_file = std::move(other.m_file);
+			m_header = std::exchange(other.m_header, nullptr);
+			m_entries = std::exchange(other.m_entries, nullptr);
+			m_text = std::exchange(other.m_text, nullptr);
+			m_added = std::move(other.m_added);
+			m_addedCount = std::exchange(other.m_addedCount, 0);
+		}
+		return *this;
+	}
+
+private:
+	const Entry *lookup(const Uint8 (&guid)[16], Uint64 platform) const;
+
+	MappedFile m_file;
+	const Header *m_header = nullptr;
+	const Entry *m_entries = nullptr;
+	const char *m_text = nullptr;
+	std::vector<bool> m_added;
+	size_t m_addedCount = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+class MappingDatabaseWriter
+{
+public:
+	/// Only keeps mappings for that platform and those without platform;
+	/// empty keeps everything.
+	explicit MappingDatabaseWriter(std::string platform = {})
+	: m_platform{std::move(platform)}
+	{}
+
+	/// Parses database text. Later mappings replace earlier ones for the
+	/// same GUID and platform, as in SDL. Returns the number of lines kept.
+	size_t addDatabase(std::string_view text);
+	size_t addFile(const std::string &filename);
+
+	size_t entryCount() const { return m_pending.size(); }
+
+	/// Lines that were neither blank, comments nor valid mappings.
+	size_t skippedCount() const { return m_skipped; }
+
+	void write(const std::string &filename) const;
+
+private:
+	struct Pending
+	{
+		MappingDatabase::Entry entry{};
+		Uint64 order = 0;
+		std::string text;
+	};
+
+	std::string m_platform;
+	std::vector<Pending> m_pending;
+	size_t m_skipped = 0;
+	Uint64 m_order = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,106 @@
+/*
+** SDL++, 2020
+** Mipmap.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Rect.hpp"
+#include "Render.hpp"
+#include "Surface.hpp"
+#include "Texture.hpp"
+#include "Vec2.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Successively halved copies of a surface, built once at load time so that
+/// minified sprites are drawn from a level at most twice their drawn size.
+class MipChain
+{
+public:
+	/// Halves until both sides are at most minSize, itself at least 1.
+	explicit MipChain(Surface base, Surface::Filter filter = Surface::Filter::Box, int minSize = 1)
+	{
+		minSize = std::max(minSize, 1);
+		m_levels.push_back(std::move(base));
+		for (;;) {
+			const Surface &last = m_levels.back();
+			if (last.width() <= minSize && last.height() <= minSize)
+				break;
+			const Vec2i half{std::max(last.width() / 2, 1), std::max(last.height() / 2, 1)};
+			m_levels.push_back(last.scaled(half, filter));
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	size_t levelCount() const { return m_levels.size(); }
+	const Surface &level(size_t i) const { return m_levels[i]; }
+	const Surface &base() const { return m_levels.front(); }
+
+	/// Index of the smallest level still covering drawn on both axes.
+	size_t levelIndexFor(const Vec2i &drawn) const
+	{
+		size_t i = 0;
+		while (i + 1 < m_levels.size() && m_levels[i + 1].width() >= drawn.x && m_levels[i + 1].height() >= drawn.y)
+			++i;
+		return i;
+	}
+
+	const Surface &levelFor(const Vec2i &drawn) const
+	{
+		return m_levels[levelIndexFor(drawn)];
+	}
+
+private:
+	std::vector<Surface> m_levels;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// One texture per level of a MipChain; copy() picks the level matching the
+/// destination size.
+class MipTextures
+{
+public:
+	MipTextures(const Renderer &renderer, const MipChain &chain)
+	{
+		m_textures.reserve(chain.levelCount());
+		for (size_t i = 0; i < chain.levelCount(); ++i) {
+			m_textures.push_back(renderer.makeTexture(chain.level(i)));
+			m_sizes.push_back(chain.level(i).size());
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	size_t levelCount() const { return m_textures.size(); }
+	Texture &level(size_t i) { return m_textures[i]; }
+
+	void copy(const Renderer &renderer, const Rect &dest)
+	{
+		size_t i = 0;
+		while (i + 1 < m_sizes.size() && m_sizes[i + 1].x >= dest.w && m_sizes[i + 1].y >= dest.h)
+			++i;
+		renderer.copy(m_textures[i], Rect{0, 0, m_sizes[i].x, m_sizes[i].y}, dest);
+	}
+
+private:
+	std::vector<Texture> m_textures;
+	std::vector<Vec2i> m_sizes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
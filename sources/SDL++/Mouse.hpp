@@ -26,7 +26,7 @@ public:
 	static void setRelative(bool enabled)
 	{
 		if (SDL_SetRelativeMouseMode(enabled ? SDL_TRUE : SDL_FALSE) < 0)
-			throw Exception("SDL_SetRelativeMouseMode");
+			SDLPP_THROW(Exception("SDL_SetRelativeMouseMode"));
 	}
 
 	static bool isRelative()
@@ -57,21 +57,21 @@ public:
 	: m_cursor(SDL_CreateSystemCursor(id))
 	{
 		if (!m_cursor)
-			throw Exception("SDL_CreateSystemCursor");
+			SDLPP_THROW(Exception("SDL_CreateSystemCursor"));
 	}
 
 	Cursor(const uint8_t *data, const uint8_t *mask, const Vec2i &size, const Vec2i &hot)
 	: m_cursor(SDL_CreateCursor(data, mask, size.x, size.y, hot.x, hot.y))
 	{
 		if (!m_cursor)
-			throw Exception("SDL_CreateCursor");
+			SDLPP_THROW(Exception("SDL_CreateCursor"));
 	}
 
 	Cursor(const Surface &surface, const Vec2i &hot)
 	: m_cursor(SDL_CreateColorCursor(surface.ptr(), hot.x, hot.y))
 	{
 		if (!m_cursor)
-			throw Exception("SDL_CreateColorCursor");
+			SDLPP_THROW(Exception("SDL_CreateColorCursor"));
 	}
 
 	~Cursor()
@@ -99,21 +99,21 @@ public:
 	{
 		const auto value = SDL_ShowCursor(SDL_ENABLE);
 		if (value != SDL_ENABLE)
-			throw Exception("SDL_ShowCursor");
+			SDLPP_THROW(Exception("SDL_ShowCursor"));
 	}
 
 	static void hide()
 	{
 		const auto value = SDL_ShowCursor(SDL_DISABLE);
 		if (value != SDL_DISABLE)
-			throw Exception("SDL_ShowCursor");
+			SDLPP_THROW(Exception("SDL_ShowCursor"));
 	}
 
 	static bool visible()
 	{
 		const auto value = SDL_ShowCursor(SDL_QUERY);
 		if (value < 0)
-			throw Exception("SDL_ShowCursor");
+			SDLPP_THROW(Exception("SDL_ShowCursor"));
 		return value == SDL_ENABLE;
 	}
 
@@ -0,0 +1,102 @@
+/*
+** SDL++, 2020
+** Parallel.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Fixed set of worker threads running index ranges in parallel.
+///
+/// run() blocks until the whole range is done and the calling thread takes
+/// chunks too. Calls made from inside a running job, or while another thread
+/// owns the pool, are executed inline instead of waiting.
+class ThreadPool
+{
+public:
+	using Range = std::function<void(int begin, int end)>;
+
+	/// threads counts the calling thread, so 1 means no workers.
+	explicit ThreadPool(int threads);
+
+	ThreadPool(const ThreadPool&) = delete;
+
+	~ThreadPool();
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Calls fn on [0, count) split into chunks of at most grain indices.
+	/// The first exception thrown by fn is rethrown once all chunks are done.
+	void run(int count, int grain, const Range &fn);
+
+	/// Stops the workers and starts new ones. Waits for a running job.
+	void resize(int threads);
+
+	int threadCount() const { return static_cast<int>(m_workers.size()) + 1; }
+
+	/// Pool sized by System::CPUCount(), used by the surface operations.
+	static ThreadPool &shared();
+
+	////////////////////////////////////////////////////////////////////////////
+
+	ThreadPool &operator =(const ThreadPool&) = delete;
+
+private:
+	struct Job;
+
+	void start(int threads);
+	void stop();
+	void workerLoop(size_t seen);
+
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_submit;
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	Job *m_job = nullptr;
+	size_t m_generation = 0;
+	size_t m_active = 0;
+	bool m_stopping = false;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Row band splitting for surface operations on the shared pool.
+///
+/// Bands cover about bandBytes() of destination rows, rounded so that a band
+/// boundary never splits a cache line (System::CPUCachelineSize()) when the
+/// pitch allows it. Images smaller than threshold() are processed inline.
+namespace Parallel
+{
+	size_t bandBytes();
+	void setBandBytes(size_t bytes);
+
+	size_t threshold();
+	void setThreshold(size_t bytes);
+
+	int bandRows(int height, int pitch);
+
+	/// Calls fn(y0, y1) over the rows [0, height) of an image with the given
+	/// destination pitch.
+	void forRows(int height, int pitch, const std::function<void(int y0, int y1)> &fn);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
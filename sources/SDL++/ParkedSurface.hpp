@@ -0,0 +1,153 @@
+/*
+** SDL++, 2020
+** ParkedSurface.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Render.hpp"
+#include "ResourceCache.hpp"
+#include "Surface.hpp"
+#include "Texture.hpp"
+#include "Vec2.hpp"
+
+#include <SDL2/SDL_pixels.h>
+
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Surface whose pixels can be parked: compressed in memory with Lz and
+/// freed, then restored the next time they are needed.
+///
+/// surface() and lock() restore parked pixels transparently and keep them
+/// resident until the next park(). The surface itself cannot be replaced, so
+/// its size and format stay fixed; attributes set through surface() are
+/// kept when it is parked. copy() and makeTexture() decode into a
+/// temporary and leave the surface parked. Flat UI images typically shrink
+/// 3 to 10 times; noisy photographs barely compress.
+///
+/// Pixels are split in blocks of rows compressed independently, so parking
+/// and restoring large surfaces run on the shared thread pool. Palette, color
+/// key, blend mode and modulation survive parking.
+class ParkedSurface
+{
+public:
+	/// Memory held by all live ParkedSurface objects.
+	struct Totals
+	{
+		size_t residentBytes = 0; ///< pixels of resident surfaces
+		size_t parkedBytes = 0; ///< compressed pixels of parked surfaces
+		size_t parkedPixelBytes = 0; ///< size the parked surfaces decompress to
+
+		size_t bytes() const { return residentBytes + parkedBytes; }
+		double ratio() const { return parkedBytes ? double(parkedPixelBytes) / double(parkedBytes) : 1.0; }
+	};
+
+	explicit ParkedSurface(Surface surface, bool parkNow = true);
+
+	ParkedSurface(ParkedSurface &&other) noexcept;
+
+	ParkedSurface(const ParkedSurface&) = delete;
+
+	~ParkedSurface();
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Compresses the pixels and frees the surface. Does nothing if parked.
+	void park();
+
+	/// Restores the surface and drops the compressed copy.
+	void unpark();
+
+	bool isParked() const { return !m_surface.ptr(); }
+
+	const Surface &surface()
+	{
+		unpark();
+		return m_surface;
+	}
+
+	Surface::Lock lock()
+	{
+		return surface().lock();
+	}
+
+	/// Decoded copy of the pixels and attributes, parked or not.
+	Surface copy() const;
+
+	Texture makeTexture(const Renderer &renderer) const
+	{
+		if (!isParked())
+			return renderer.makeTexture(m_surface);
+		return renderer.makeTexture(copy());
+	}
+
+	Vec2i size() const { return Vec2i{m_width, m_height}; }
+	Uint32 format() const { return m_format; }
+
+	/// Uncompressed size of the pixels.
+	size_t pixelBytes() const { return static_cast<size_t>(m_pitch) * static_cast<size_t>(m_height); }
+
+	size_t residentBytes() const { return isParked() ? 0 : pixelBytes(); }
+	size_t parkedBytes() const;
+
+	static Totals totals();
+
+	////////////////////////////////////////////////////////////////////////////
+
+	ParkedSurface &operator =(ParkedSurface &&other) noexcept;
+	ParkedSurface &operator =(const ParkedSurface&) = delete;
+
+private:
+	struct Attributes
+	{
+		std::vector<SDL_Color> palette;
+		bool hasColorKey = false;
+		Uint32 colorKey = 0;
+		SDL_BlendMode blendMode = SDL_BLENDMODE_NONE;
+		Color colorAlphaMod;
+	};
+
+	static Attributes attributesOf(const Surface &surface);
+
+	void account(int sign) const;
+	Surface blank(const Attributes &attributes) const;
+	Surface decode() const;
+
+	Surface m_surface{nullptr};
+	std::vector<std::vector<Uint8>> m_blocks;
+	int m_blockRows = 0;
+
+	int m_width = 0;
+	int m_height = 0;
+	int m_depth = 0;
+	int m_pitch = 0;
+	Uint32 m_format = SDL_PIXELFORMAT_UNKNOWN;
+	Attributes m_attributes;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Measured when the entry is inserted, so insert surfaces already parked.
+template<>
+struct ResourceFootprint<ParkedSurface>
+{
+	static size_t cpuBytes(const ParkedSurface &s)
+	{
+		return sizeof(SDL_Surface) + s.residentBytes() + s.parkedBytes();
+	}
+
+	static size_t gpuBytes(const ParkedSurface&) { return 0; }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,110 @@
+/*
+** SDL++, 2020
+** PixelKernels.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <SDL2/SDL_rect.h>
+#include <SDL2/SDL_surface.h>
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// SIMD fast paths for the pixel conversions and blends SDL handles through
+/// its generic blitters.
+///
+/// The instruction set is picked once at runtime (SDL_HasAVX2, SDL_HasSSE41,
+/// SDL_HasSSE2, SDL_HasNEON) and every kernel has a scalar fallback. Callers
+/// get nullptr/false for anything not covered and are expected to go through
+/// SDL instead. Large images are split in row bands (see Parallel.hpp).
+namespace SDL::Kernels
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+enum class Isa
+{
+	Scalar,
+	SSE2,
+	SSE41,
+	AVX2,
+	NEON
+};
+
+Isa isa();
+Isa bestIsa();
+const char *isaName(Isa isa);
+
+/// Restricts dispatch to the given instruction set (clamped to what the CPU
+/// supports). Meant for benchmarks and for comparing against the scalar path.
+void setIsa(Isa isa);
+
+////////////////////////////////////////////////////////////////////////////////
+
+using RowConverter = void (*)(const void *src, void *dst, int width);
+using RowBlender = void (*)(const Uint32 *src, Uint32 *dst, int width);
+
+/// Converts one row between ARGB8888, ABGR8888, XRGB8888 (source only),
+/// RGB24 and BGR24. Returns nullptr for unsupported pairs.
+RowConverter converter(Uint32 srcFormat, Uint32 dstFormat);
+
+/// Straight-alpha source-over blend of 32-bit pixels with alpha in the top
+/// byte (ARGB8888 or ABGR8888, identical on both sides).
+RowBlender blender();
+
+/// Premultiplied-alpha variants, same layouts as blender(). The blend is
+/// dst = src + dst * (1 - srcAlpha) on every channel including alpha.
+/// premultiplier() and unpremultiplier() may run in place (src == dst).
+RowBlender premultipliedBlender();
+RowBlender premultiplier();
+RowBlender unpremultiplier();
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool convertPixels(int w, int h, Uint32 srcFormat, const void *src, int srcPitch, Uint32 dstFormat, void *dst, int dstPitch);
+
+/// SDL_ConvertSurfaceFormat equivalent, keeping blend mode, modulation and
+/// clip rect. Returns nullptr when there is no fast path for the surface.
+SDL_Surface *convertSurface(SDL_Surface *src, Uint32 format);
+
+/// SDL_BlitSurface equivalent for alpha-blended 32-bit surfaces of the same
+/// format without modulation or color key, with SDL's clipping rules.
+/// Returns false when SDL must handle the blit.
+bool blitSurface(SDL_Surface *src, const SDL_Rect *srcRect, SDL_Surface *dst, const SDL_Rect *dstRect);
+
+/// blitSurface() for premultiplied sources, whatever their blend mode.
+bool blitPremultiplied(SDL_Surface *src, const SDL_Rect *srcRect, SDL_Surface *dst, const SDL_Rect *dstRect);
+
+/// In-place conversion between straight and premultiplied alpha for
+/// ARGB8888 and ABGR8888 surfaces. Returns false for other formats.
+bool premultiplySurface(SDL_Surface *surface);
+bool unpremultiplySurface(SDL_Surface *surface);
+
+/// SDL_FillRect split in row bands across the shared thread pool.
+int fillRect(SDL_Surface *dst, const SDL_Rect *rect, Uint32 color);
+
+/// Nearest-neighbour resize of src into the whole of dst. Both surfaces must
+/// share a pixel format of at least 8 bits per pixel. Returns false when SDL
+/// must handle it.
+bool scaleNearest(SDL_Surface *src, SDL_Surface *dst);
+
+enum class Filter
+{
+	Nearest,
+	Box,
+	Bilinear,
+	Lanczos
+};
+
+/// Separable resize of src into the whole of dst. Box averages the covered
+/// pixels, Bilinear is a tent and Lanczos a 3-lobe windowed sinc; all are
+/// widened when minifying. Filtering needs both surfaces in the same 8888 or
+/// 24-bit RGB format (channels are filtered as stored, so straight alpha
+/// bleeds the color of transparent pixels). Returns false otherwise.
+bool resample(SDL_Surface *src, SDL_Surface *dst, Filter filter);
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
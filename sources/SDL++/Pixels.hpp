@@ -46,7 +46,7 @@ public:
 	{
 		auto f = SDL_AllocFormat(format);
 		if (!f)
-			throw Exception{"SDL_AllocFormat"};
+			SDLPP_THROW(Exception{"SDL_AllocFormat"});
 		SDL_GetRGBA(raw, f, &r, &g, &b, &a);
 		SDL_FreeFormat(f);
 	}
@@ -65,7 +65,7 @@ public:
 	{
 		auto f = SDL_AllocFormat(format);
 		if (!f)
-			throw Exception{"SDL_AllocFormat"};
+			SDLPP_THROW(Exception{"SDL_AllocFormat"});
 		auto raw = asUint(*f);
 		SDL_FreeFormat(f);
 		return raw;
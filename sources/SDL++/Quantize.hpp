@@ -0,0 +1,111 @@
+/*
+** SDL++, 2020
+** Quantize.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Pixels.hpp"
+#include "Surface.hpp"
+
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+enum class Dither
+{
+	None,
+	/// 8x8 Bayer matrix. Position based, so frames do not shimmer where the
+	/// image is static and rows can be processed in parallel.
+	Ordered,
+	/// Serpentine Floyd-Steinberg error diffusion. Best still images, single
+	/// threaded.
+	FloydSteinberg
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Reduction of 32-bit surfaces to RGB565 and INDEX8 framebuffers.
+///
+/// Sources are read as RGB, alpha is dropped. Any 32-bit format with 8-bit
+/// color channels is read directly, other formats go through ARGB8888.
+namespace Quantize
+{
+	/// Median-cut palette of at most colors entries (fewer when the image
+	/// has fewer distinct colors) over a 5-bit per channel histogram,
+	/// followed by refinePasses k-means iterations on the histogram.
+	std::vector<Color> medianCut(const Surface &image, int colors = 256, int refinePasses = 2);
+
+	Surface toRGB565(const Surface &image, Dither dither = Dither::Ordered);
+
+	/// Writes into target, reallocated only if it is not an RGB565 surface of
+	/// the image size.
+	void toRGB565(const Surface &image, Surface &target, Dither dither = Dither::Ordered);
+
+	/// INDEX8 surface mapped to palette (at most 256 colors).
+	Surface toIndexed(const Surface &image, const std::vector<Color> &palette, Dither dither = Dither::FloydSteinberg);
+
+	/// toIndexed() with the medianCut() palette of the image.
+	Surface toIndexed(const Surface &image, int colors = 256, Dither dither = Dither::FloydSteinberg);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Palette mapping for a stream of frames.
+///
+/// The nearest palette entry of every RGB565 color is computed once when the
+/// palette is set, so that mapping a frame is one table lookup per pixel.
+/// The palette stays the same until setPalette() or train() is called, which
+/// keeps colors stable from one frame to the next.
+class Quantizer
+{
+public:
+	explicit Quantizer(std::vector<Color> palette, Dither dither = Dither::Ordered);
+
+	/// Learns a palette of the given size from the first converted frame.
+	explicit Quantizer(int colors = 256, Dither dither = Dither::Ordered);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void setPalette(std::vector<Color> palette);
+	const std::vector<Color> &palette() const { return m_palette; }
+
+	/// Replaces the palette by the medianCut() of frame.
+	void train(const Surface &frame, int refinePasses = 2);
+
+	void setDither(Dither dither) { m_dither = dither; }
+	Dither dither() const { return m_dither; }
+
+	/// Index of the palette entry closest to the RGB565 cell of color; 0 until
+	/// a palette is set or learned.
+	Uint8 nearest(const Color &color) const
+	{
+		return m_lut[((color.r >> 3) << 11) | ((color.g >> 2) << 5) | (color.b >> 3)];
+	}
+
+	Surface convert(const Surface &frame);
+
+	/// Writes into target, reallocated only if it is not an INDEX8 surface of
+	/// the frame size.
+	void convert(const Surface &frame, Surface &target);
+
+private:
+	void buildTable();
+
+	std::vector<Color> m_palette;
+	std::vector<Uint8> m_lut;
+	int m_colors;
+	int m_spread = 0;
+	Dither m_dither;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
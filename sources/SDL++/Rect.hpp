@@ -10,8 +10,10 @@
 #include "Vec2.hpp"
 
 #include <SDL2/SDL_rect.h>
+#include <SDL2/SDL_version.h>
 
 #include <algorithm>
+#include <cmath>
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -139,4 +141,131 @@ public:
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+
+/// Rect with float coordinates for sub-pixel positioning, taken as is by the
+/// float rendering functions (SDL_RenderFillRectF and friends).
+class FRect : public SDL_FRect
+{
+public:
+	constexpr FRect()
+	: SDL_FRect{0.0f, 0.0f, 0.0f, 0.0f}
+	{}
+
+	constexpr FRect(float x, float y, float w, float h)
+	: SDL_FRect{x, y, w, h}
+	{}
+
+	constexpr FRect(const Vec2f &corner, const Vec2f &size)
+	: SDL_FRect{corner.x, corner.y, size.x, size.y}
+	{}
+
+	constexpr explicit FRect(const SDL_FRect &r)
+	: SDL_FRect{r}
+	{}
+
+	constexpr explicit FRect(const SDL_Rect &r)
+	: SDL_FRect{float(r.x), float(r.y), float(r.w), float(r.h)}
+	{}
+
+	FRect(const FRect &) noexcept = default;
+	FRect(FRect&&) noexcept = default;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	constexpr float x1() const { return x; }
+	constexpr float x2() const { return x + w; }
+	constexpr float y1() const { return y; }
+	constexpr float y2() const { return y + h; }
+
+	Vec2f size() const { return Vec2f{w, h}; }
+	Vec2f center() const { return Vec2f{x + w / 2.0f, y + h / 2.0f}; }
+
+	/// Smallest Rect covering every pixel the rectangle touches.
+	Rect bounds() const
+	{
+		const int left = static_cast<int>(std::floor(x1()));
+		const int top = static_cast<int>(std::floor(y1()));
+		return Rect::fromCorners(left, top, static_cast<int>(std::ceil(x2())), static_cast<int>(std::ceil(y2())));
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	bool empty() const
+	{
+		return !(w > 0.0f && h > 0.0f);
+	}
+
+	bool contains(float px, float py) const
+	{
+		return px >= x1() && px < x2() && py >= y1() && py < y2();
+	}
+
+	bool contains(const Vec2f &point) const
+	{
+		return contains(point.x, point.y);
+	}
+
+	bool intersects(const FRect &r) const
+	{
+		return x1() < r.x2() && x2() > r.x1() && y1() < r.y2() && y2() > r.y1();
+	}
+
+	/// Empty rect when they do not intersect.
+	FRect inter(const FRect &r) const
+	{
+		if (!intersects(r))
+			return FRect{};
+		return fromCorners(std::max(x1(), r.x1()), std::max(y1(), r.y1()), std::min(x2(), r.x2()), std::min(y2(), r.y2()));
+	}
+
+	FRect getUnion(const FRect &r) const
+	{
+		if (empty())
+			return r;
+		if (r.empty())
+			return *this;
+		return fromCorners(std::min(x1(), r.x1()), std::min(y1(), r.y1()), std::max(x2(), r.x2()), std::max(y2(), r.y2()));
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	static constexpr FRect fromCenter(float cx, float cy, float w, float h)
+	{
+		return FRect{cx - w / 2.0f, cy - h / 2.0f, w, h};
+	}
+
+	static constexpr FRect fromCenter(const Vec2f &center, const Vec2f &size)
+	{
+		return fromCenter(center.x, center.y, size.x, size.y);
+	}
+
+	static constexpr FRect fromCorners(float x1, float y1, float x2, float y2)
+	{
+		return FRect(x1, y1, x2 - x1, y2 - y1);
+	}
+
+	static constexpr FRect fromCorners(const Vec2f &corner1, const Vec2f &corner2)
+	{
+		return fromCorners(corner1.x, corner1.y, corner2.x, corner2.y);
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	FRect &operator =(const FRect &) noexcept = default;
+	FRect &operator =(FRect&&) noexcept = default;
+
+	bool operator ==(const FRect &other) const {
+		return x == other.x && y == other.y && w == other.w && h == other.h;
+	}
+
+	bool operator !=(const FRect &other) const {
+		return !(*this == other);
+	}
+};
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+/*
+** SDL++, 2020
+** RectArray.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "GeometryKernels.hpp"
+#include "Rect.hpp"
+#include "Vec2.hpp"
+
+#include <SDL2/SDL_rect.h>
+#include <SDL2/SDL_version.h>
+
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Rectangles stored as four arrays (x, y, w, h), tested against a point or
+/// an area in bulk with the SIMD loops of GeometryKernels.hpp.
+///
+/// Tests fill a mask of 0/1 bytes, one per rectangle, that the export
+/// functions accept to keep only the selected rectangles.
+class RectArray
+{
+public:
+	using Mask = std::vector<Uint8>;
+
+	RectArray() = default;
+
+	template<class Container>
+	static RectArray from(const Container &rects)
+	{
+		RectArray r;
+		r.reserve(rects.size());
+		for (const auto &rect : rects)
+			r.push_back(rect);
+		return r;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const { return m_x.size(); }
+	bool empty() const { return m_x.empty(); }
+
+	void reserve(size_t size)
+	{
+		m_x.reserve(size);
+		m_y.reserve(size);
+		m_w.reserve(size);
+		m_h.reserve(size);
+	}
+
+	void clear()
+	{
+		m_x.clear();
+		m_y.clear();
+		m_w.clear();
+		m_h.clear();
+	}
+
+	void push_back(const SDL_Rect &r)
+	{
+		m_x.push_back(r.x);
+		m_y.push_back(r.y);
+		m_w.push_back(r.w);
+		m_h.push_back(r.h);
+	}
+
+	Rect operator [](size_t i) const { return Rect{m_x[i], m_y[i], m_w[i], m_h[i]}; }
+
+	void set(size_t i, const SDL_Rect &r)
+	{
+		m_x[i] = r.x;
+		m_y[i] = r.y;
+		m_w[i] = r.w;
+		m_h[i] = r.h;
+	}
+
+	const int *x() const { return m_x.data(); }
+	const int *y() const { return m_y.data(); }
+	const int *w() const { return m_w.data(); }
+	const int *h() const { return m_h.data(); }
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void translate(const Vec2i &d)
+	{
+		Kernels::translatePoints(m_x.data(), m_y.data(), size(), d.x, d.y);
+	}
+
+	/// Marks the rectangles for which Rect::contains(point) holds, returns
+	/// how many there are.
+	size_t contains(const Vec2i &point, Mask &mask) const
+	{
+		mask.resize(size());
+		return Kernels::rectsContaining(x(), y(), w(), h(), size(), point.x, point.y, mask.data());
+	}
+
+	/// Marks the rectangles for which Rect::intersects(area) holds, returns
+	/// how many there are.
+	size_t intersects(const SDL_Rect &area, Mask &mask) const
+	{
+		mask.resize(size());
+		return Kernels::rectsIntersecting(x(), y(), w(), h(), size(), area, mask.data());
+	}
+
+	/// Union of every rectangle, empty ones included; an empty Rect when
+	/// there are none.
+	Rect boundingBox() const
+	{
+		return empty() ? Rect{} : Rect{Kernels::rectBounds(x(), y(), w(), h(), size())};
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void toRects(std::vector<SDL_Rect> &out) const
+	{
+		out.resize(size());
+		for (size_t i = 0; i < size(); ++i)
+			out[i] = SDL_Rect{m_x[i], m_y[i], m_w[i], m_h[i]};
+	}
+
+	/// Exports the rectangles whose mask byte is set, in order.
+	void toRects(const Mask &mask, std::vector<SDL_Rect> &out) const
+	{
+		out.clear();
+		for (size_t i = 0; i < size(); ++i)
+			if (mask[i])
+				out.push_back(SDL_Rect{m_x[i], m_y[i], m_w[i], m_h[i]});
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+	void toRects(std::vector<SDL_FRect> &out) const
+	{
+		out.resize(size());
+		for (size_t i = 0; i < size(); ++i)
+			out[i] = SDL_FRect{float(m_x[i]), float(m_y[i]), float(m_w[i]), float(m_h[i])};
+	}
+
+	void toRects(const Mask &mask, std::vector<SDL_FRect> &out) const
+	{
+		out.clear();
+		for (size_t i = 0; i < size(); ++i)
+			if (mask[i])
+				out.push_back(SDL_FRect{float(m_x[i]), float(m_y[i]), float(m_w[i]), float(m_h[i])});
+	}
+#endif
+
+private:
+	std::vector<int> m_x;
+	std::vector<int> m_y;
+	std::vector<int> m_w;
+	std::vector<int> m_h;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -7,14 +7,21 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "Error.hpp"
 #include "Exception.hpp"
+#include "GeometryKernels.hpp"
 #include "Pixels.hpp"
 #include "Rect.hpp"
+#include "Status.hpp"
 #include "Surface.hpp"
 #include "Texture.hpp"
 
 #include <SDL2/SDL_render.h>
 
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -25,9 +32,59 @@ namespace SDL
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Owning wrapper around SDL_Renderer.
+///
+/// With culling enabled (setCulling()), rectangles, points, lines and
+/// texture copies entirely outside the visible area (the viewport, narrowed
+/// by the clip rect when enabled) are dropped before reaching SDL. The batch
+/// functions filter their arrays with the SIMD loops of GeometryKernels.hpp.
+/// Culling never changes what is drawn; cullStats() tells how much it saved.
+/// The visible area is cached until present() or a viewport, clip, scale or
+/// target change made through the wrapper; call invalidateVisibleArea() after
+/// changing those directly on ptr().
+///
+/// The per-frame calls have std::nothrow overloads returning a Status
+/// instead of throwing, for hot loops and builds without exceptions.
 class Renderer
 {
 public:
+	struct CullStats
+	{
+		Uint64 submitted = 0;
+		Uint64 culled = 0;
+	};
+
+	/// Redirects rendering to a target texture until destroyed, then restores
+	/// whatever target was active before, so scopes nest.
+	class TargetScope
+	{
+	public:
+		TargetScope(const Renderer &renderer, Texture &target)
+		: m_renderer{renderer}
+		, m_previous{SDL_GetRenderTarget(m_renderer.ptr())}
+		{
+			m_renderer.invalidateVisibleArea();
+			if (SDL_SetRenderTarget(m_renderer.ptr(), target.ptr()) != 0)
+				SDLPP_THROW(Exception{"SDL_SetRenderTarget"});
+		}
+
+		TargetScope(const TargetScope&) = delete;
+
+		~TargetScope()
+		{
+			SDL_SetRenderTarget(m_renderer.ptr(), m_previous);
+			m_renderer.invalidateVisibleArea();
+		}
+
+		TargetScope &operator =(const TargetScope&) = delete;
+
+	private:
+		const Renderer &m_renderer;
+		SDL_Texture *m_previous;
+	};
+
+	////////////////////////////////////////////////////////////////////////////
+
 	Renderer() = default;
 
 	explicit Renderer(SDL_Renderer *renderer)
@@ -53,7 +110,7 @@ public:
 	void info(SDL_RendererInfo &info) const
 	{
 		if (SDL_GetRendererInfo(m_renderer, &info) != 0)
-			throw Exception{"SDL_GetRendererInfo"};
+			SDLPP_THROW(Exception{"SDL_GetRendererInfo"});
 	}
 
 	SDL_RendererInfo info() const
@@ -67,7 +124,7 @@ public:
 	{
 		Vec2i s;
 		if (SDL_GetRendererOutputSize(m_renderer, &s.x, &s.y) != 0)
-			throw Exception{"SDL_GetRendererOutputSize"};
+			SDLPP_THROW(Exception{"SDL_GetRendererOutputSize"});
 		return s;
 	}
 
@@ -75,19 +132,23 @@ public:
 	{
 		Color c;
 		if (SDL_GetRenderDrawColor(m_renderer, &c.r, &c.g, &c.b, &c.a) != 0)
-			throw Exception{"SDL_GetRenderDrawColor"};
+			SDLPP_THROW(Exception{"SDL_GetRenderDrawColor"});
 		return c;
 	}
 
 	void setDrawColor(Uint8 r, Uint8 g, Uint8 b, Uint8 a = SDL_ALPHA_OPAQUE) const
 	{
-		if (SDL_SetRenderDrawColor(m_renderer, r, g, b, a) != 0)
-			throw Exception{"SDL_SetRenderDrawColor"};
+		setDrawColor(Color{r, g, b, a}, std::nothrow).raise();
 	}
 
 	void setDrawColor(const Color &c) const
 	{
-		setDrawColor(c.r, c.g, c.b, c.a);
+		setDrawColor(c, std::nothrow).raise();
+	}
+
+	Status setDrawColor(const Color &c, std::nothrow_t) const noexcept
+	{
+		return Status::check(SDL_SetRenderDrawColor(m_renderer, c.r, c.g, c.b, c.a), "SDL_SetRenderDrawColor");
 	}
 
 	Rect clipRect() const
@@ -99,8 +160,9 @@ public:
 
 	void setClipRect(const Rect &r) const
 	{
+		invalidateVisibleArea();
 		if (SDL_RenderSetClipRect(m_renderer, &r) != 0)
-			throw Exception{"SDL_RenderSetClipRect"};
+			SDLPP_THROW(Exception{"SDL_RenderSetClipRect"});
 	}
 
 	bool isClipEnabled() const
@@ -110,8 +172,9 @@ public:
 
 	void disableClip() const
 	{
+		invalidateVisibleArea();
 		if (SDL_RenderSetClipRect(m_renderer, nullptr) != 0)
-			throw Exception{"SDL_RenderSetClipRect"};
+			SDLPP_THROW(Exception{"SDL_RenderSetClipRect"});
 	}
 
 	bool intScale() const
@@ -121,14 +184,108 @@ public:
 
 	void setIntScale(bool intscale) const
 	{
+		invalidateVisibleArea();
 		if (SDL_RenderSetIntegerScale(m_renderer, SDL_bool(intscale)) != 0)
-			throw Exception{"SDL_RenderSetIntegerScale"};
+			SDLPP_THROW(Exception{"SDL_RenderSetIntegerScale"});
 	}
 
 	void setBlendMode(SDL_BlendMode mode) const
 	{
 		if (SDL_SetRenderDrawBlendMode(m_renderer, mode) != 0)
-			throw Exception{"SDL_RenderSetIntegerScale"};
+			SDLPP_THROW(Exception{"SDL_RenderSetIntegerScale"});
+	}
+
+	Rect viewport() const
+	{
+		Rect r;
+		SDL_RenderGetViewport(m_renderer, &r);
+		return r;
+	}
+
+	void setViewport(const Rect &r) const
+	{
+		invalidateVisibleArea();
+		if (SDL_RenderSetViewport(m_renderer, &r) != 0)
+			SDLPP_THROW(Exception{"SDL_RenderSetViewport"});
+	}
+
+	/// Area that can be drawn to, in drawing coordinates.
+	Rect visibleArea() const
+	{
+		if (!m_visibleAreaValid) {
+			const auto v = viewport();
+			const Rect area{0, 0, v.w, v.h};
+			m_visibleArea = isClipEnabled() ? area.inter(clipRect()) : area;
+			m_visibleAreaValid = true;
+		}
+		return m_visibleArea;
+	}
+
+	void invalidateVisibleArea() const { m_visibleAreaValid = false; }
+
+	bool culling() const { return m_culling; }
+	void setCulling(bool enabled) { m_culling = enabled; }
+
+	const CullStats &cullStats() const { return m_cullStats; }
+	void resetCullStats() { m_cullStats = CullStats{}; }
+
+	bool targetSupported() const
+	{
+		return SDL_RenderTargetSupported(m_renderer) == SDL_TRUE;
+	}
+
+	/// The texture must have been created with SDL_TEXTUREACCESS_TARGET.
+	void setTarget(Texture &target) const
+	{
+		invalidateVisibleArea();
+		if (SDL_SetRenderTarget(m_renderer, target.ptr()) != 0)
+			SDLPP_THROW(Exception{"SDL_SetRenderTarget"});
+	}
+
+	void resetTarget() const
+	{
+		invalidateVisibleArea();
+		if (SDL_SetRenderTarget(m_renderer, nullptr) != 0)
+			SDLPP_THROW(Exception{"SDL_SetRenderTarget"});
+	}
+
+	/// Current target texture, nullptr when rendering to the window.
+	SDL_Texture *target() const
+	{
+		return SDL_GetRenderTarget(m_renderer);
+	}
+
+	[[nodiscard]] TargetScope targetScope(Texture &target) const
+	{
+		return TargetScope{*this, target};
+	}
+
+	/// Reads back area of the current target into the top-left corner of
+	/// into, converting to its format. This waits for the GPU, so it should
+	/// not be called every frame on a latency-sensitive path.
+	void readPixels(const Rect &area, Surface &into) const
+	{
+		if (area.w > into.width() || area.h > into.height()) {
+			Error::set("Renderer::readPixels: the surface is smaller than the area");
+			SDLPP_THROW(Exception{"SDL_RenderReadPixels"});
+		}
+		auto lock = into.lock();
+		if (SDL_RenderReadPixels(m_renderer, &area, into.format(), lock.rawArray(), into.ptr()->pitch) != 0)
+			SDLPP_THROW(Exception{"SDL_RenderReadPixels"});
+	}
+
+	Surface readPixels(const Rect &area, Uint32 format = SDL_PIXELFORMAT_ARGB8888) const
+	{
+		Surface s{area.w, area.h, static_cast<int>(SDL_BITSPERPIXEL(format)), format};
+		readPixels(area, s);
+		return s;
+	}
+
+	/// Whole viewport of the current target.
+	Surface readPixels(Uint32 format = SDL_PIXELFORMAT_ARGB8888) const
+	{
+		const auto v = viewport();
+		return readPixels(Rect{0, 0, v.w, v.h}, format);
 	}
 
 
@@ -152,6 +309,13 @@ public:
 		return Texture{m_renderer, filename};
 	}
 
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+	Texture makePremultipliedTexture(const Surface &surface, bool alreadyPremultiplied = false) const
+	{
+		return Texture::premultiplied(m_renderer, surface, alreadyPremultiplied);
+	}
+#endif
+
 	void copy(Texture &tex) const
 	{
 		SDL_RenderCopy(m_renderer, tex.ptr(), nullptr, nullptr);
@@ -159,19 +323,66 @@ public:
 
 	void copy(Texture &tex, const Rect &source, const Rect &dest) const
 	{
+		if (!visible(dest))
+			return;
 		SDL_RenderCopy(m_renderer, tex.ptr(), &source, &dest);
 	}
 
+	/// Rotates clockwise by angle degrees around the center of dest.
+	void copyEx(Texture &tex, const Rect &source, const Rect &dest, double angle, SDL_RendererFlip flip = SDL_FLIP_NONE) const
+	{
+		if (m_culling && !visible(rotatedBounds(dest.x, dest.y, dest.w, dest.h, angle, dest.x + dest.w / 2.0, dest.y + dest.h / 2.0)))
+			return;
+		SDL_RenderCopyEx(m_renderer, tex.ptr(), &source, &dest, angle, nullptr, flip);
+	}
+
+	/// Same with the rotation center relative to dest's corner.
+	void copyEx(Texture &tex, const Rect &source, const Rect &dest, double angle, const Vec2i &center, SDL_RendererFlip flip = SDL_FLIP_NONE) const
+	{
+		if (m_culling && !visible(rotatedBounds(dest.x, dest.y, dest.w, dest.h, angle, dest.x + center.x, dest.y + center.y)))
+			return;
+		SDL_RenderCopyEx(m_renderer, tex.ptr(), &source, &dest, angle, &center, flip);
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+	void copy(Texture &tex, const Rect &source, const FRect &dest) const
+	{
+		if (!visible(dest.bounds()))
+			return;
+		SDL_RenderCopyF(m_renderer, tex.ptr(), &source, &dest);
+	}
+
+	void copyEx(Texture &tex, const Rect &source, const FRect &dest, double angle, SDL_RendererFlip flip = SDL_FLIP_NONE) const
+	{
+		if (m_culling && !visible(rotatedBounds(dest.x, dest.y, dest.w, dest.h, angle, dest.x + dest.w / 2.0, dest.y + dest.h / 2.0)))
+			return;
+		SDL_RenderCopyExF(m_renderer, tex.ptr(), &source, &dest, angle, nullptr, flip);
+	}
+
+	void copyEx(Texture &tex, const Rect &source, const FRect &dest, double angle, const Vec2f &center, SDL_RendererFlip flip = SDL_FLIP_NONE) const
+	{
+		if (m_culling && !visible(rotatedBounds(dest.x, dest.y, dest.w, dest.h, angle, dest.x + center.x, dest.y + center.y)))
+			return;
+		SDL_RenderCopyExF(m_renderer, tex.ptr(), &source, &dest, angle, &center, flip);
+	}
+#endif
 
+
+	/// Also forgets the visible area, which a window resize may change.
 	void present() const
 	{
 		SDL_RenderPresent(m_renderer);
+		invalidateVisibleArea();
 	}
 
 	void clear() const
 	{
-		if (SDL_RenderClear(m_renderer) != 0)
-			throw Exception{"SDL_RenderClear"};
+		clear(std::nothrow).raise();
+	}
+
+	Status clear(std::nothrow_t) const noexcept
+	{
+		return Status::check(SDL_RenderClear(m_renderer), "SDL_RenderClear");
 	}
 
 	void clear(const Color &c) const
@@ -185,8 +396,7 @@ public:
 
 	void drawLine(const Vec2i &pos1, const Vec2i &pos2) const
 	{
-		if (SDL_RenderDrawLine(m_renderer, pos1.x, pos1.y, pos2.x, pos2.y) != 0)
-			throw Exception{"SDL_RenderDrawLine"};
+		drawLine(pos1, pos2, std::nothrow).raise();
 	}
 
 	void drawLine(const Vec2i &pos1, const Vec2i &pos2, const Color &c) const
@@ -195,10 +405,25 @@ public:
 		drawLine(pos1, pos2);
 	}
 
+	Status drawLine(const Vec2i &pos1, const Vec2i &pos2, std::nothrow_t) const noexcept
+	{
+		const Vec2i low{std::min(pos1.x, pos2.x), std::min(pos1.y, pos2.y)};
+		const Vec2i high{std::max(pos1.x, pos2.x), std::max(pos1.y, pos2.y)};
+		if (!visible(Rect::fromCorners(low, high + Vec2i{1, 1})))
+			return {};
+		return Status::check(SDL_RenderDrawLine(m_renderer, pos1.x, pos1.y, pos2.x, pos2.y), "SDL_RenderDrawLine");
+	}
+
+	Status drawLine(const Vec2i &pos1, const Vec2i &pos2, const Color &c, std::nothrow_t) const noexcept
+	{
+		const Status s = setDrawColor(c, std::nothrow);
+		return s ? drawLine(pos1, pos2, std::nothrow) : s;
+	}
+
 	void drawLines(const std::vector<Vec2i> &points) const
 	{
 		if (SDL_RenderDrawLines(m_renderer, &points[0], (int)points.size()) != 0)
-			throw Exception{"SDL_RenderDrawLines"};
+			SDLPP_THROW(Exception{"SDL_RenderDrawLines"});
 	}
 
 	void drawLines(const std::vector<Vec2i> &points, const Color &c) const
@@ -209,8 +434,7 @@ public:
 
 	void drawPoint(const Vec2i &point) const
 	{
-		if (SDL_RenderDrawPoint(m_renderer, point.x, point.y) != 0)
-			throw Exception{"SDL_RenderDrawPoint"};
+		drawPoint(point, std::nothrow).raise();
 	}
 
 	void drawPoint(const Vec2i &point, const Color &c) const
@@ -219,10 +443,32 @@ public:
 		drawPoint(point);
 	}
 
+	Status drawPoint(const Vec2i &point, std::nothrow_t) const noexcept
+	{
+		if (!visible(Rect{point, Vec2i{1, 1}}))
+			return {};
+		return Status::check(SDL_RenderDrawPoint(m_renderer, point.x, point.y), "SDL_RenderDrawPoint");
+	}
+
+	Status drawPoint(const Vec2i &point, const Color &c, std::nothrow_t) const noexcept
+	{
+		const Status s = setDrawColor(c, std::nothrow);
+		return s ? drawPoint(point, std::nothrow) : s;
+	}
+
 	void drawPoints(const std::vector<Vec2i> &points) const
 	{
-		if (SDL_RenderDrawPoints(m_renderer, &points[0], (int)points.size()) != 0)
-			throw Exception{"SDL_RenderDrawPoints"};
+		drawPoints(points, std::nothrow).raise();
+	}
+
+	/// Not noexcept: culling may allocate.
+	Status drawPoints(const std::vector<Vec2i> &points, std::nothrow_t) const
+	{
+		if (m_culling) {
+			const auto &kept = cull(points);
+			return kept.empty() ? Status{} : Status::check(SDL_RenderDrawPoints(m_renderer, kept.data(), (int)kept.size()), "SDL_RenderDrawPoints");
+		}
+		return Status::check(SDL_RenderDrawPoints(m_renderer, points.data(), (int)points.size()), "SDL_RenderDrawPoints");
 	}
 
 	void drawPoints(const std::vector<Vec2i> &points, const Color &c) const
@@ -243,8 +489,7 @@ public:
 
 	void drawRect(const Rect &rect) const
 	{
-		if (SDL_RenderDrawRect(m_renderer, &rect) != 0)
-			throw Exception{"SDL_RenderDrawRect"};
+		drawRect(rect, std::nothrow).raise();
 	}
 
 	void drawRect(const Rect &rect, const Color &c) const
@@ -253,10 +498,31 @@ public:
 		drawRect(rect);
 	}
 
+	Status drawRect(const Rect &rect, std::nothrow_t) const noexcept
+	{
+		if (!visible(rect))
+			return {};
+		return Status::check(SDL_RenderDrawRect(m_renderer, &rect), "SDL_RenderDrawRect");
+	}
+
+	Status drawRect(const Rect &rect, const Color &c, std::nothrow_t) const noexcept
+	{
+		const Status s = setDrawColor(c, std::nothrow);
+		return s ? drawRect(rect, std::nothrow) : s;
+	}
+
 	void drawRects(const std::vector<Rect> &rects) const
 	{
-		if (SDL_RenderDrawRects(m_renderer, &rects[0], (int)rects.size()) != 0)
-			throw Exception{"SDL_RenderDrawRects"};
+		drawRects(rects, std::nothrow).raise();
+	}
+
+	Status drawRects(const std::vector<Rect> &rects, std::nothrow_t) const
+	{
+		if (m_culling) {
+			const auto &kept = cull(rects);
+			return kept.empty() ? Status{} : Status::check(SDL_RenderDrawRects(m_renderer, kept.data(), (int)kept.size()), "SDL_RenderDrawRects");
+		}
+		return Status::check(SDL_RenderDrawRects(m_renderer, rects.data(), (int)rects.size()), "SDL_RenderDrawRects");
 	}
 
 	void drawRects(const std::vector<Rect> &rects, const Color& c) const
@@ -268,20 +534,19 @@ public:
 	void fill() const
 	{
 		if (SDL_RenderFillRect(m_renderer, NULL) != 0)
-			throw Exception{"SDL_RenderFillRect"};
+			SDLPP_THROW(Exception{"SDL_RenderFillRect"});
 	}
 
 	void fill(const Color &c) const
 	{
 		setDrawColor(c);
 		if (SDL_RenderFillRect(m_renderer, NULL) != 0)
-			throw Exception{"SDL_RenderFillRect"};
+			SDLPP_THROW(Exception{"SDL_RenderFillRect"});
 	}
 
 	void fillRect(const Rect &rect) const
 	{
-		if (SDL_RenderFillRect(m_renderer, &rect) != 0)
-			throw Exception{"SDL_RenderFillRect"};
+		fillRect(rect, std::nothrow).raise();
 	}
 
 	void fillRect(const Rect &rect, const Color &c) const
@@ -290,10 +555,31 @@ public:
 		fillRect(rect);
 	}
 
+	Status fillRect(const Rect &rect, std::nothrow_t) const noexcept
+	{
+		if (!visible(rect))
+			return {};
+		return Status::check(SDL_RenderFillRect(m_renderer, &rect), "SDL_RenderFillRect");
+	}
+
+	Status fillRect(const Rect &rect, const Color &c, std::nothrow_t) const noexcept
+	{
+		const Status s = setDrawColor(c, std::nothrow);
+		return s ? fillRect(rect, std::nothrow) : s;
+	}
+
 	void fillRects(const std::vector<Rect> &rects) const
 	{
-		if (SDL_RenderFillRects(m_renderer, &rects[0], (int)rects.size()) != 0)
-			throw Exception{"SDL_RenderDrawRects"};
+		fillRects(rects, std::nothrow).raise();
+	}
+
+	Status fillRects(const std::vector<Rect> &rects, std::nothrow_t) const
+	{
+		if (m_culling) {
+			const auto &kept = cull(rects);
+			return kept.empty() ? Status{} : Status::check(SDL_RenderFillRects(m_renderer, kept.data(), (int)kept.size()), "SDL_RenderFillRects");
+		}
+		return Status::check(SDL_RenderFillRects(m_renderer, rects.data(), (int)rects.size()), "SDL_RenderFillRects");
 	}
 
 	void fillRects(const std::vector<Rect> &rects, const Color &c)
@@ -302,6 +588,151 @@ public:
 		fillRects(rects);
 	}
 
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+	////////////////////////////////////////////////////////////////////////////
+	// Float coordinates. Vec2f and FRect share the layout of SDL_FPoint and
+	// SDL_FRect, so arrays are passed to SDL without conversion. Only single
+	// items are culled; float batches always go to SDL.
+
+	void drawLine(const Vec2f &pos1, const Vec2f &pos2) const
+	{
+		const Vec2f low{std::min(pos1.x, pos2.x), std::min(pos1.y, pos2.y)};
+		const Vec2f high{std::max(pos1.x, pos2.x), std::max(pos1.y, pos2.y)};
+		if (!visible(FRect::fromCorners(low, high + Vec2f{1.0f, 1.0f}).bounds()))
+			return;
+		if (SDL_RenderDrawLineF(m_renderer, pos1.x, pos1.y, pos2.x, pos2.y) != 0)
+			SDLPP_THROW(Exception{"SDL_RenderDrawLineF"});
+	}
+
+	void drawLine(const Vec2f &pos1, const Vec2f &pos2, const Color &c) const
+	{
+		setDrawColor(c);
+		drawLine(pos1, pos2);
+	}
+
+	void drawLines(const SDL_FPoint *points, int count) const
+	{
+		if (SDL_RenderDrawLinesF(m_renderer, points, count) != 0)
+			SDLPP_THROW(Exception{"SDL_RenderDrawLinesF"});
+	}
+
+	void drawLines(const std::vector<Vec2f> &points) const
+	{
+		drawLines(points.data(), (int)points.size());
+	}
+
+	void drawLines(const std::vector<Vec2f> &points, const Color &c) const
+	{
+		setDrawColor(c);
+		drawLines(points);
+	}
+
+	void drawPoint(const Vec2f &point) const
+	{
+		drawPoint(point, std::nothrow).raise();
+	}
+
+	Status drawPoint(const Vec2f &point, std::nothrow_t) const noexcept
+	{
+		if (!visible(FRect{point, Vec2f{1.0f, 1.0f}}.bounds()))
+			return {};
+		return Status::check(SDL_RenderDrawPointF(m_renderer, point.x, point.y), "SDL_RenderDrawPointF");
+	}
+
+	void drawPoint(const Vec2f &point, const Color &c) const
+	{
+		setDrawColor(c);
+		drawPoint(point);
+	}
+
+	void drawPoints(const SDL_FPoint *points, int count) const
+	{
+		if (SDL_RenderDrawPointsF(m_renderer, points, count) != 0)
+			SDLPP_THROW(Exception{"SDL_RenderDrawPointsF"});
+	}
+
+	void drawPoints(const std::vector<Vec2f> &points) const
+	{
+		drawPoints(points.data(), (int)points.size());
+	}
+
+	void drawPoints(const std::vector<Vec2f> &points, const Color &c) const
+	{
+		setDrawColor(c);
+		drawPoints(points);
+	}
+
+	void drawRect(const FRect &rect) const
+	{
+		drawRect(rect, std::nothrow).raise();
+	}
+
+	Status drawRect(const FRect &rect, std::nothrow_t) const noexcept
+	{
+		if (!visible(rect.bounds()))
+			return {};
+		return Status::check(SDL_RenderDrawRectF(m_renderer, &rect), "SDL_RenderDrawRectF");
+	}
+
+	void drawRect(const FRect &rect, const Color &c) const
+	{
+		setDrawColor(c);
+		drawRect(rect);
+	}
+
+	void drawRects(const SDL_FRect *rects, int count) const
+	{
+		if (SDL_RenderDrawRectsF(m_renderer, rects, count) != 0)
+			SDLPP_THROW(Exception{"SDL_RenderDrawRectsF"});
+	}
+
+	void drawRects(const std::vector<FRect> &rects) const
+	{
+		drawRects(rects.data(), (int)rects.size());
+	}
+
+	void drawRects(const std::vector<FRect> &rects, const Color &c) const
+	{
+		setDrawColor(c);
+		drawRects(rects);
+	}
+
+	void fillRect(const FRect &rect) const
+	{
+		fillRect(rect, std::nothrow).raise();
+	}
+
+	Status fillRect(const FRect &rect, std::nothrow_t) const noexcept
+	{
+		if (!visible(rect.bounds()))
+			return {};
+		return Status::check(SDL_RenderFillRectF(m_renderer, &rect), "SDL_RenderFillRectF");
+	}
+
+	void fillRect(const FRect &rect, const Color &c) const
+	{
+		setDrawColor(c);
+		fillRect(rect);
+	}
+
+	void fillRects(const SDL_FRect *rects, int count) const
+	{
+		if (SDL_RenderFillRectsF(m_renderer, rects, count) != 0)
+			SDLPP_THROW(Exception{"SDL_RenderFillRectsF"});
+	}
+
+	void fillRects(const std::vector<FRect> &rects) const
+	{
+		fillRects(rects.data(), (int)rects.size());
+	}
+
+	void fillRects(const std::vector<FRect> &rects, const Color &c) const
+	{
+		setDrawColor(c);
+		fillRects(rects);
+	}
+#endif
+
 	////////////////////////////////////////////////////////////////////////////
 
 	Renderer &operator=(const Renderer&) = delete;
@@ -312,12 +743,93 @@ public:
 			SDL_DestroyRenderer(m_renderer);
 			m_renderer = other.m_renderer;
 			other.m_renderer = nullptr;
+			m_culling = other.m_culling;
+			m_cullStats = other.m_cullStats;
+			m_visibleAreaValid = false;
 		}
 		return *this;
 	}
 
 private:
+	bool visible(const Rect &bounds) const
+	{
+		if (!m_culling)
+			return true;
+
+		++m_cullStats.submitted;
+		if (bounds.intersects(visibleArea()))
+			return true;
+		++m_cullStats.culled;
+		return false;
+	}
+
+	/// Pixels covered by the rectangle rotated clockwise by angle degrees
+	/// around (cx, cy), with a pixel of margin for SDL's rounding.
+	static Rect rotatedBounds(double x, double y, double w, double h, double angle, double cx, double cy)
+	{
+		const double radians = angle * 3.14159265358979323846 / 180.0;
+		const double c = std::cos(radians), s = std::sin(radians);
+		const double xs[] = {x, x + w, x, x + w};
+		const double ys[] = {y, y, y + h, y + h};
+
+		double x1 = cx, y1 = cy, x2 = cx, y2 = cy;
+		for (int i = 0; i < 4; ++i) {
+			const double dx = xs[i] - cx, dy = ys[i] - cy;
+			const double px = cx + dx * c - dy * s, py = cy + dx * s + dy * c;
+			x1 = std::min(x1, px);
+			y1 = std::min(y1, py);
+			x2 = std::max(x2, px);
+			y2 = std::max(y2, py);
+		}
+		return Rect::fromCorners(int(std::floor(x1)) - 1, int(std::floor(y1)) - 1, int(std::ceil(x2)) + 1, int(std::ceil(y2)) + 1);
+	}
+
+	/// The items of a batch that may be visible, returning the batch itself
+	/// when nothing can be dropped.
+	template<typename T>
+	const std::vector<T> &cull(const std::vector<T> &items) const
+	{
+		const Rect area = visibleArea();
+		m_cullMask.resize(items.size());
+
+		size_t kept;
+		if constexpr (std::is_base_of_v<SDL_Rect, T>)
+			kept = Kernels::rectsIntersecting(items.data(), items.size(), area, m_cullMask.data());
+		else
+			kept = Kernels::pointsInside(items.data(), items.size(), area, m_cullMask.data());
+
+		m_cullStats.submitted += items.size();
+		m_cullStats.culled += items.size() - kept;
+		if (kept == items.size())
+			return items;
+
+		auto &out = scratch<T>();
+		out.clear();
+		out.reserve(kept);
+		for (size_t i = 0; i < items.size(); ++i)
+			if (m_cullMask[i])
+				out.push_back(items[i]);
+		return out;
+	}
+
+	template<typename T>
+	std::vector<T> &scratch() const
+	{
+		if constexpr (std::is_base_of_v<SDL_Rect, T>)
+			return m_cullRects;
+		else
+			return m_cullPoints;
+	}
+
 	SDL_Renderer *m_renderer = nullptr;
+
+	bool m_culling = false;
+	mutable CullStats m_cullStats;
+	mutable Rect m_visibleArea;
+	mutable bool m_visibleAreaValid = false;
+	mutable std::vector<Uint8> m_cullMask;
+	mutable std::vector<Rect> m_cullRects;
+	mutable std::vector<Vec2i> m_cullPoints;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,158 @@
+/*
+** SDL++, 2020
+** RenderTargetPool.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Render.hpp"
+#include "Texture.hpp"
+#include "Vec2.hpp"
+
+#include <SDL2/SDL_render.h>
+
+#include <list>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Reusable SDL_TEXTUREACCESS_TARGET textures keyed by size and format.
+///
+/// acquire() hands out a Lease that gives its texture back when destroyed.
+/// Textures left idle are kept, up to maxIdle, most recently released first;
+/// the oldest idle texture is destroyed beyond that. The pool must outlive
+/// its leases and belongs to the thread that renders.
+class RenderTargetPool
+{
+public:
+	struct Stats
+	{
+		Uint64 created = 0;
+		Uint64 reused = 0;
+		Uint64 destroyed = 0;
+	};
+
+	class Lease
+	{
+	public:
+		Lease(Lease &&other) noexcept
+		: m_pool{std::exchange(other.m_pool, nullptr)}
+		, m_size{other.m_size}
+		, m_format{other.m_format}
+		, m_texture{std::move(other.m_texture)}
+		{}
+
+		Lease(const Lease&) = delete;
+
+		~Lease()
+		{
+			if (m_pool)
+				m_pool->release(m_size, m_format, std::move(m_texture));
+		}
+
+		Texture &texture() { return m_texture; }
+		Texture *operator ->() { return &m_texture; }
+
+		Lease &operator =(const Lease&) = delete;
+		Lease &operator =(Lease&&) = delete;
+
+	private:
+		friend class RenderTargetPool;
+
+		Lease(RenderTargetPool &pool, const Vec2i &size, Uint32 format, Texture texture)
+		: m_pool{&pool}
+		, m_size{size}
+		, m_format{format}
+		, m_texture{std::move(texture)}
+		{}
+
+		RenderTargetPool *m_pool;
+		Vec2i m_size;
+		Uint32 m_format;
+		Texture m_texture;
+	};
+
+	explicit RenderTargetPool(const Renderer &renderer, size_t maxIdle = 8)
+	: m_renderer{renderer.ptr()}
+	, m_maxIdle{maxIdle}
+	{}
+
+	RenderTargetPool(const RenderTargetPool&) = delete;
+	RenderTargetPool &operator =(const RenderTargetPool&) = delete;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// The texture keeps the content, blend mode and modulation it was
+	/// released with; clear it before use if that matters.
+	Lease acquire(const Vec2i &size, SDL_PixelFormatEnum format = SDL_PIXELFORMAT_ARGB8888)
+	{
+		for (auto it = m_idle.rbegin(); it != m_idle.rend(); ++it) {
+			if (it->size == size && it->format == format) {
+				Texture t = std::move(it->texture);
+				m_idle.erase(std::next(it).base());
+				++m_stats.reused;
+				return Lease{*this, size, format, std::move(t)};
+			}
+		}
+
+		++m_stats.created;
+		return Lease{*this, size, format, Texture{m_renderer, size, format, SDL_TEXTUREACCESS_TARGET}};
+	}
+
+	size_t idleCount() const { return m_idle.size(); }
+	size_t maxIdle() const { return m_maxIdle; }
+
+	void setMaxIdle(size_t maxIdle)
+	{
+		m_maxIdle = maxIdle;
+		trim();
+	}
+
+	/// Destroys every idle texture, e.g. when the renderer loses its targets
+	/// (SDL_RENDER_TARGETS_RESET).
+	void clear()
+	{
+		m_stats.destroyed += m_idle.size();
+		m_idle.clear();
+	}
+
+	const Stats &stats() const { return m_stats; }
+
+private:
+	struct Idle
+	{
+		Vec2i size;
+		Uint32 format;
+		Texture texture;
+	};
+
+	void release(const Vec2i &size, Uint32 format, Texture texture)
+	{
+		m_idle.push_back(Idle{size, format, std::move(texture)});
+		trim();
+	}
+
+	void trim()
+	{
+		while (m_idle.size() > m_maxIdle) {
+			m_idle.pop_front();
+			++m_stats.destroyed;
+		}
+	}
+
+	SDL_Renderer *m_renderer;
+	size_t m_maxIdle;
+	std::list<Idle> m_idle;
+	Stats m_stats;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
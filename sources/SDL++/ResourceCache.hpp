@@ -0,0 +1,226 @@
+/*
+** SDL++, 2020
+** ResourceCache.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Surface.hpp"
+#include "Texture.hpp"
+
+#include <SDL2/SDL_pixels.h>
+
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Estimated memory footprint of a cached resource, split between main
+/// memory and video memory.
+template<typename T>
+struct ResourceFootprint;
+
+template<>
+struct ResourceFootprint<Surface>
+{
+	static size_t cpuBytes(const Surface &s)
+	{
+		return sizeof(SDL_Surface) + static_cast<size_t>(s.ptr()->pitch) * static_cast<size_t>(s.height());
+	}
+
+	static size_t gpuBytes(const Surface&) { return 0; }
+};
+
+template<>
+struct ResourceFootprint<Texture>
+{
+	static size_t cpuBytes(const Texture&) { return 0; }
+
+	static size_t gpuBytes(const Texture &t)
+	{
+		const Uint32 format = t.format();
+		const auto size = t.size();
+		const size_t pixels = static_cast<size_t>(size.x) * static_cast<size_t>(size.y);
+
+		// Planar YUV formats average 12 bits per pixel (packed ones 16).
+		if (SDL_ISPIXELFORMAT_FOURCC(format))
+			return format == SDL_PIXELFORMAT_YUY2 || format == SDL_PIXELFORMAT_UYVY || format == SDL_PIXELFORMAT_YVYU
+				? pixels * 2
+				: pixels * 3 / 2;
+		return pixels * SDL_BYTESPERPIXEL(format);
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Deduplicating cache of shared resources keyed by path (or any string).
+///
+/// get() hands out shared handles and loads at most once per key. Entries no
+/// longer referenced outside the cache stay resident until the estimated
+/// footprint exceeds the budget, then the least recently used are evicted.
+/// Referenced entries are never evicted, so the budget can be exceeded while
+/// handles are held.
+template<typename T, typename Footprint = ResourceFootprint<T>>
+class ResourceCache
+{
+public:
+	using Handle = std::shared_ptr<T>;
+	using Loader = std::function<T(const std::string&)>;
+
+	struct Stats
+	{
+		Uint64 hits = 0;
+		Uint64 misses = 0;
+		Uint64 evictions = 0;
+		size_t cpuBytes = 0;
+		size_t gpuBytes = 0;
+
+		size_t bytes() const { return cpuBytes + gpuBytes; }
+		double hitRate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+	};
+
+	explicit ResourceCache(Loader loader, size_t budget = 256 << 20)
+	: m_loader{std::move(loader)}
+	, m_budget{budget}
+	{}
+
+	ResourceCache(const ResourceCache&) = delete;
+	ResourceCache &operator =(const ResourceCache&) = delete;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Handle get(const std::string &key)
+	{
+		if (auto h = find(key)) {
+			++m_stats.hits;
+			return h;
+		}
+
+		++m_stats.misses;
+		return insert(key, m_loader(key));
+	}
+
+	/// Returns the cached resource without loading it, touching its LRU rank.
+	Handle find(const std::string &key)
+	{
+		const auto it = m_index.find(key);
+		if (it == m_index.end())
+			return nullptr;
+
+		m_entries.splice(m_entries.begin(), m_entries, it->second);
+		return it->second->handle;
+	}
+
+	Handle insert(const std::string &key, T &&value)
+	{
+		erase(key);
+
+		Entry e;
+		e.key = key;
+		e.handle = std::make_shared<T>(std::move(value));
+		e.cpuBytes = Footprint::cpuBytes(*e.handle);
+		e.gpuBytes = Footprint::gpuBytes(*e.handle);
+
+		m_stats.cpuBytes += e.cpuBytes;
+		m_stats.gpuBytes += e.gpuBytes;
+		m_entries.push_front(std::move(e));
+		m_index.emplace(key, m_entries.begin());
+
+		auto handle = m_entries.front().handle;
+		trim();
+		return handle;
+	}
+
+	bool contains(const std::string &key) const { return m_index.count(key) != 0; }
+
+	/// Drops the entry; outstanding handles keep the resource alive.
+	bool erase(const std::string &key)
+	{
+		const auto it = m_index.find(key);
+		if (it == m_index.end())
+			return false;
+
+		release(it->second);
+		m_index.erase(it);
+		return true;
+	}
+
+	/// Evicts unreferenced entries, oldest first, until the footprint fits in
+	/// the budget. Returns the number of bytes released.
+	size_t trim() { return trimTo(m_budget); }
+
+	/// Evicts every unreferenced entry.
+	size_t purge() { return trimTo(0); }
+
+	void setBudget(size_t budget)
+	{
+		m_budget = budget;
+		trim();
+	}
+
+	size_t budget() const { return m_budget; }
+	size_t size() const { return m_entries.size(); }
+	const Stats &stats() const { return m_stats; }
+
+private:
+	struct Entry
+	{
+		std::string key;
+		Handle handle;
+		size_t cpuBytes = 0;
+		size_t gpuBytes = 0;
+	};
+
+	using EntryList = std::list<Entry>;
+
+	void release(typename EntryList::iterator it)
+	{
+		m_stats.cpuBytes -= it->cpuBytes;
+		m_stats.gpuBytes -= it->gpuBytes;
+		m_entries.erase(it);
+	}
+
+	size_t trimTo(size_t budget)
+	{
+		size_t released = 0;
+		auto it = m_entries.end();
+		while (m_stats.bytes() > budget && it != m_entries.begin()) {
+			--it;
+			if (it->handle.use_count() > 1)
+				continue;
+
+			released += it->cpuBytes + it->gpuBytes;
+			m_index.erase(it->key);
+			auto victim = it++;
+			release(victim);
+			++m_stats.evictions;
+		}
+		return released;
+	}
+
+	Loader m_loader;
+	size_t m_budget;
+	EntryList m_entries; ///< most recently used first
+	std::unordered_map<std::string, typename EntryList::iterator> m_index;
+	Stats m_stats;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+using SurfaceCache = ResourceCache<Surface>;
+using TextureCache = ResourceCache<Texture>;
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,189 @@
+/*
+** SDL++, 2020
+** RumbleScheduler.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "GameController.hpp"
+#include "Haptic.hpp"
+#include "SlotMap.hpp"
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <chrono>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Blends overlapping rumble effects into one low and high frequency output
+/// per controller, instead of every rumble call replacing the last one.
+///
+/// Each update() advances the effects' envelopes by the given time step,
+/// sums (or takes the maximum of) their levels per target and sends the
+/// result to the device only when it moved by more than the threshold,
+/// reached or left zero, or the previous command is about to run out.
+/// Commands last a lease of a few hundred milliseconds, so a stalled game
+/// stops rumbling. Time only advances through update(), and effects blend
+/// in slot order, where cancelled and finished effects free slots that later
+/// play() calls reuse. The same sequence of calls therefore always gives the
+/// same output.
+///
+/// Targets are referenced, not owned, and must stay open while added.
+class RumbleScheduler
+{
+	struct Active;
+	struct Output;
+
+public:
+	enum class Blend
+	{
+		Sum,
+		Max,
+	};
+
+	/// Linear ramp up over attack, full level for sustain, linear ramp down
+	/// over release. A forever sustain lasts until stop().
+	struct Envelope
+	{
+		static constexpr std::chrono::milliseconds forever = std::chrono::milliseconds::max();
+
+		std::chrono::milliseconds attack{0};
+		std::chrono::milliseconds sustain{100};
+		std::chrono::milliseconds release{0};
+	};
+
+	/// Motor levels in [0, 1].
+	struct Rumble
+	{
+		float low = 0.0f;
+		float high = 0.0f;
+		Envelope envelope;
+	};
+
+	struct Stats
+	{
+		/// Target outputs computed, one per target and update().
+		Uint64 updates = 0;
+		/// Of which sent to the device.
+		Uint64 commands = 0;
+		Uint64 failures = 0;
+	};
+
+	using Target = SlotMap<Output>::Key;
+	using Effect = SlotMap<Active>::Key;
+
+	explicit RumbleScheduler(Blend blend = Blend::Sum)
+	: m_blend{blend}
+	{}
+
+	RumbleScheduler(const RumbleScheduler&) = delete;
+	RumbleScheduler &operator =(const RumbleScheduler&) = delete;
+
+	/// Stops every target.
+	~RumbleScheduler();
+
+	////////////////////////////////////////////////////////////////////////////
+
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+	/// Drives the controller through SDL_GameControllerRumble().
+	Target add(const GameController &controller);
+#endif
+
+	/// Drives a left/right effect, or a sine effect of the stronger level on
+	/// devices without one. Throws if the device supports neither.
+	Target add(Haptic &haptic);
+
+	/// Stops the target's output and its effects.
+	void remove(Target target);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// An invalid key if target is unknown.
+	Effect play(Target target, const Rumble &rumble);
+
+	/// Moves the effect to its release; returns false once it ended.
+	bool stop(Effect effect);
+
+	/// Removes the effect at once, without release.
+	bool cancel(Effect effect);
+
+	/// Cancels every effect of the target.
+	void cancelAll(Target target);
+
+	size_t activeEffects() const { return m_effects.size(); }
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void update(std::chrono::milliseconds dt);
+
+	/// Smallest output change, in 1/65535 of the motor range, worth sending.
+	void setThreshold(Uint16 threshold) { m_threshold = threshold; }
+	Uint16 threshold() const { return m_threshold; }
+
+	/// Duration of each command; they are renewed halfway through.
+	void setLease(std::chrono::milliseconds lease) { m_lease = lease; }
+	std::chrono::milliseconds lease() const { return m_lease; }
+
+	/// Levels last sent to the target, low then high frequency.
+	Uint16 lowOutput(Target target) const;
+	Uint16 highOutput(Target target) const;
+
+	const Stats &stats() const { return m_stats; }
+	void resetStats() { m_stats = Stats{}; }
+
+private:
+	struct Active
+	{
+		Target target;
+		float low = 0.0f;
+		float high = 0.0f;
+		// Milliseconds since play(), the phase boundaries (saturated for
+		// forever sustains) and the release length.
+		Sint64 elapsed = 0;
+		Sint64 attack = 0;
+		Sint64 releaseAt = 0;
+		Sint64 end = 0;
+		Sint64 release = 0;
+	};
+
+	struct Output
+	{
+		SDL_GameController *controller = nullptr;
+		Haptic *haptic = nullptr;
+		Haptic::InstalledEffect effect;
+		bool leftRight = false;
+
+		Uint16 low = 0;
+		Uint16 high = 0;
+		Sint64 sentAt = 0;
+	};
+
+	static float gain(const Active &a);
+	bool send(Output &output, Uint16 low, Uint16 high);
+
+	Blend m_blend;
+	Uint16 m_threshold = 2048;
+	std::chrono::milliseconds m_lease{250};
+	Sint64 m_now = 0;
+
+	SlotMap<Output> m_targets;
+	SlotMap<Active> m_effects;
+	Stats m_stats;
+
+	// Per target slot, reused across updates.
+	std::vector<float> m_low;
+	std::vector<float> m_high;
+	std::vector<Effect> m_ended;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
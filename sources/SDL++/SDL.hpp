@@ -7,25 +7,55 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "ActionMap.hpp"
+#include "Archive.hpp"
 #include "Audio.hpp"
+#include "BitmapFont.hpp"
+#include "CachedLayer.hpp"
 #include "Clipboard.hpp"
+#include "ControllerState.hpp"
 #include "Error.hpp"
 #include "Events.hpp"
 #include "Exception.hpp"
+#include "FrameCapture.hpp"
 #include "GameController.hpp"
+#include "GeometryKernels.hpp"
 #include "Haptic.hpp"
+#include "Hash.hpp"
+#include "InputSampler.hpp"
 #include "Joystick.hpp"
 #include "Keyboard.hpp"
+#include "LooseQuadtree.hpp"
+#include "Lz.hpp"
+#include "MappedFile.hpp"
+#include "MappingDatabase.hpp"
+#include "Mipmap.hpp"
 #include "Mouse.hpp"
+#include "Parallel.hpp"
+#include "ParkedSurface.hpp"
 #include "Rect.hpp"
+#include "RectArray.hpp"
 #include "Render.hpp"
+#include "RenderTargetPool.hpp"
+#include "ResourceCache.hpp"
+#include "RumbleScheduler.hpp"
+#include "PixelKernels.hpp"
 #include "Pixels.hpp"
+#include "Quantize.hpp"
 #include "SharedObject.hpp"
+#include "SlotMap.hpp"
+#include "SpatialHash.hpp"
+#include "SpscRing.hpp"
+#include "Status.hpp"
 #include "Surface.hpp"
+#include "SurfaceDiskCache.hpp"
+#include "TextRenderer.hpp"
 #include "Texture.hpp"
 #include "Timer.hpp"
+#include "UploadScheduler.hpp"
 #include "Utils.hpp"
 #include "Vec2.hpp"
+#include "Vec2Array.hpp"
 #include "Video.hpp"
 
 #include <SDL2/SDL.h>
@@ -53,12 +83,12 @@ public:
 	Root()
 	{
 		if (!init())
-			throw Exception{"SDL_Init"};
+			SDLPP_THROW(Exception{"SDL_Init"});
 
 #ifdef SDLPP_USE_SDL_IMAGE
 		const int img_flags = IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF;
 		if (IMG_Init(img_flags) != img_flags)
-			throw Exception{"IMG_Init"};
+			SDLPP_THROW(Exception{"IMG_Init"});
 		atexit(IMG_Quit);
 #endif
 	}
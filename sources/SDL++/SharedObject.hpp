@@ -34,7 +34,7 @@ public:
 	: m_handle{SDL_LoadObject(filename.c_str())}
 	{
 		if (!m_handle)
-			throw Exception("SDL_LoadObject");
+			SDLPP_THROW(Exception("SDL_LoadObject"));
 	}
 
 	SharedObject(const SharedObject&) = delete;
@@ -56,7 +56,7 @@ public:
 	{
 		const auto address = SDL_LoadFunction(m_handle, fn.c_str());
 		if (!address)
-			throw Exception("SDL_LoadFunction");
+			SDLPP_THROW(Exception("SDL_LoadFunction"));
 		return address;
 	}
 
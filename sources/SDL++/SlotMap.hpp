@@ -0,0 +1,136 @@
+/*
+** SDL++, 2020
+** SlotMap.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Values addressed by generational keys: insert, find and erase are O(1),
+/// erased slots are reused, and a key to an erased value stays invalid even
+/// once its slot holds another value.
+///
+/// A slot's generation is odd while it is occupied and bumped on insert and
+/// erase. Erased values are reset to T{}.
+template<typename T>
+class SlotMap
+{
+public:
+	struct Key
+	{
+		Uint32 index = 0;
+		Uint32 generation = 0;
+
+		/// Default keys never match a value.
+		explicit operator bool() const { return generation & 1; }
+
+		bool operator ==(const Key &other) const { return index == other.index && generation == other.generation; }
+		bool operator !=(const Key &other) const { return !(*this == other); }
+	};
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Key insert(T value)
+	{
+		Uint32 index;
+		if (m_free != none) {
+			index = m_free;
+			m_free = m_slots[index].next;
+		} else {
+			index = Uint32(m_slots.size());
+			m_slots.emplace_back();
+		}
+
+		Slot &slot = m_slots[index];
+		slot.value = std::move(value);
+		++slot.generation;
+		++m_size;
+		return Key{index, slot.generation};
+	}
+
+	/// Returns false for stale keys.
+	bool erase(Key key)
+	{
+		if (!contains(key))
+			return false;
+
+		Slot &slot = m_slots[key.index];
+		slot.value = T{};
+		++slot.generation;
+		slot.next = m_free;
+		m_free = key.index;
+		--m_size;
+		return true;
+	}
+
+	void clear()
+	{
+		for (Uint32 i = 0; i < m_slots.size(); ++i) {
+			Slot &slot = m_slots[i];
+			if (slot.generation & 1) {
+				slot.value = T{};
+				++slot.generation;
+				slot.next = m_free;
+				m_free = i;
+			}
+		}
+		m_size = 0;
+	}
+
+	bool contains(Key key) const
+	{
+		return (key.generation & 1) && key.index < m_slots.size() && m_slots[key.index].generation == key.generation;
+	}
+
+	/// nullptr for stale keys.
+	T *find(Key key) { return contains(key) ? &m_slots[key.index].value : nullptr; }
+	const T *find(Key key) const { return contains(key) ? &m_slots[key.index].value : nullptr; }
+
+	size_t size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+
+	/// Slots allocated so far, occupied or free.
+	size_t capacity() const { return m_slots.size(); }
+
+	void reserve(size_t n) { m_slots.reserve(n); }
+
+	/// Calls fn(Key, T&) for every value, in slot order.
+	template<typename F>
+	void forEach(F &&fn)
+	{
+		for (Uint32 i = 0; i < m_slots.size(); ++i)
+			if (m_slots[i].generation & 1)
+				fn(Key{i, m_slots[i].generation}, m_slots[i].value);
+	}
+
+private:
+	static constexpr Uint32 none = ~Uint32(0);
+
+	struct Slot
+	{
+		T value{};
+		Uint32 generation = 0;
+		Uint32 next = none;
+	};
+
+	std::vector<Slot> m_slots;
+	Uint32 m_free = none;
+	size_t m_size = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
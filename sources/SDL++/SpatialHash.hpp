@@ -0,0 +1,160 @@
+/*
+** SDL++, 2020
+** SpatialHash.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Rect.hpp"
+#include "Vec2.hpp"
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Uniform grid of square cells over an unbounded plane, each cell listing
+/// the objects whose bounds overlap it.
+///
+/// Suits many objects of similar size, with cellSize around their typical
+/// extent: an object spanning many cells is stored in each of them. Cells
+/// keep a copy of the bounds, so queries never leave the cell lists, and
+/// report every object once. Objects are identified by caller-chosen ids.
+class SpatialHash
+{
+public:
+	using Id = Uint32;
+
+	explicit SpatialHash(int cellSize = 128);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const { return m_ids.size(); }
+	bool empty() const { return m_ids.empty(); }
+	int cellSize() const { return m_cellSize; }
+	size_t cellCount() const { return m_cells.size(); }
+
+	bool contains(Id id) const { return m_slots.count(id) != 0; }
+
+	/// Bounds of an object, nullptr if unknown.
+	const Rect *bounds(Id id) const;
+
+	/// Adds an object, or moves it if the id is already present.
+	void insert(Id id, const Rect &bounds);
+
+	/// Returns false if the id is unknown.
+	bool move(Id id, const Rect &bounds);
+	bool remove(Id id);
+
+	void clear();
+
+	/// Replaces the content, ordering the objects by cell; faster than
+	/// repeated insert() and better for query locality. Of duplicate ids only
+	/// the first is kept.
+	void rebuild(const std::vector<std::pair<Id, Rect>> &objects);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Calls fn(id, bounds) for every object for which bounds.intersects(area).
+	template<typename F>
+	void query(const Rect &area, F &&fn) const
+	{
+		const int x0 = cellOf(area.x), y0 = cellOf(area.y);
+		const int x1 = lastCellOf(area.x, area.w), y1 = lastCellOf(area.y, area.h);
+
+		// An object spanning several cells is reported from the first of
+		// them inside the queried range.
+		auto visit = [&](int cx, int cy, const std::vector<Entry> &entries) {
+			for (const auto &e : entries) {
+				if (std::max(cellOf(e.bounds.x), x0) != cx || std::max(cellOf(e.bounds.y), y0) != cy)
+					continue;
+				if (e.bounds.intersects(area))
+					fn(m_ids[e.slot], e.bounds);
+			}
+		};
+
+		const Uint64 span = Uint64(Sint64(x1) - x0 + 1) * Uint64(Sint64(y1) - y0 + 1);
+		if (span > m_cells.size()) {
+			for (const auto &[key, entries] : m_cells) {
+				const int cx = keyX(key), cy = keyY(key);
+				if (cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1)
+					visit(cx, cy, entries);
+			}
+			return;
+		}
+
+		for (int cy = y0; cy <= y1; ++cy) {
+			for (int cx = x0; cx <= x1; ++cx) {
+				const auto it = m_cells.find(key(cx, cy));
+				if (it != m_cells.end())
+					visit(cx, cy, it->second);
+			}
+		}
+	}
+
+	void query(const Rect &area, std::vector<Id> &out) const
+	{
+		out.clear();
+		query(area, [&](Id id, const Rect&) { out.push_back(id); });
+	}
+
+	/// Objects for which bounds.contains(point).
+	void query(const Vec2i &point, std::vector<Id> &out) const
+	{
+		out.clear();
+		const auto it = m_cells.find(key(cellOf(point.x), cellOf(point.y)));
+		if (it == m_cells.end())
+			return;
+		for (const auto &e : it->second)
+			if (e.bounds.contains(point))
+				out.push_back(m_ids[e.slot]);
+	}
+
+private:
+	struct Entry
+	{
+		Rect bounds;
+		Uint32 slot;
+	};
+
+	static Uint64 key(int cx, int cy) { return Uint64(Uint32(cx)) << 32 | Uint32(cy); }
+	static int keyX(Uint64 key) { return int(Uint32(key >> 32)); }
+	static int keyY(Uint64 key) { return int(Uint32(key)); }
+
+	int cellOf(int v) const { return v >= 0 ? v / m_cellSize : -((-v - 1) / m_cellSize) - 1; }
+	int lastCellOf(int v, int extent) const { return cellOf(extent > 0 ? v + extent - 1 : v); }
+
+	template<typename F>
+	void forEachCell(const Rect &bounds, F &&fn)
+	{
+		const int x1 = lastCellOf(bounds.x, bounds.w), y1 = lastCellOf(bounds.y, bounds.h);
+		for (int cy = cellOf(bounds.y); cy <= y1; ++cy)
+			for (int cx = cellOf(bounds.x); cx <= x1; ++cx)
+				fn(key(cx, cy));
+	}
+
+	void link(Uint32 slot);
+	void unlink(Uint32 slot);
+	void relink(Uint32 slot, Uint32 from);
+
+	int m_cellSize;
+	std::unordered_map<Uint64, std::vector<Entry>> m_cells;
+	std::unordered_map<Id, Uint32> m_slots;
+	std::vector<Id> m_ids;
+	std::vector<Rect> m_bounds;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,106 @@
+/*
+** SDL++, 2020
+** SpscRing.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Bounded lock-free queue between exactly one producer thread and one
+/// consumer thread.
+///
+/// Capacity is rounded up to a power of two. push() fails instead of
+/// blocking when the queue is full. Neither side ever waits for the other.
+template<typename T>
+class SpscRing
+{
+	static_assert(std::is_trivially_copyable_v<T>, "SpscRing copies elements without constructing them");
+
+public:
+	explicit SpscRing(size_t capacity)
+	: m_mask{roundUp(capacity) - 1}
+	, m_slots{new T[m_mask + 1]}
+	{}
+
+	SpscRing(const SpscRing&) = delete;
+	SpscRing &operator =(const SpscRing&) = delete;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	size_t capacity() const { return m_mask + 1; }
+
+	/// Approximate unless called from one of the two threads.
+	size_t size() const
+	{
+		return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+	}
+
+	bool empty() const { return size() == 0; }
+
+	/// Producer side; false when full.
+	bool push(const T &value)
+	{
+		const size_t head = m_head.load(std::memory_order_relaxed);
+		if (head - m_cachedTail > m_mask) {
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+			if (head - m_cachedTail > m_mask)
+				return false;
+		}
+
+		m_slots[head & m_mask] = value;
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// Consumer side; false when empty.
+	bool pop(T &value)
+	{
+		const size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail == m_cachedHead) {
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+			if (tail == m_cachedHead)
+				return false;
+		}
+
+		value = m_slots[tail & m_mask];
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	static size_t roundUp(size_t n)
+	{
+		size_t p = 2;
+		while (p < n)
+			p <<= 1;
+		return p;
+	}
+
+	// Producer and consumer indices on their own cache lines, each with the
+	// side's cached copy of the other index.
+	const size_t m_mask;
+	std::unique_ptr<T[]> m_slots;
+
+	alignas(64) std::atomic<size_t> m_head{0};
+	size_t m_cachedTail = 0;
+
+	alignas(64) std::atomic<size_t> m_tail{0};
+	size_t m_cachedHead = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,134 @@
+/*
+** SDL++, 2020
+** Status.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Error.hpp"
+#include "Exception.hpp"
+
+#include <cassert>
+#include <optional>
+#include <string>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Outcome of a wrapper called with std::nothrow: success, or the name of
+/// the SDL function that failed. No string is built on failure; message()
+/// reads SDL's error when asked, so it must be called before the next
+/// failing SDL call on the same thread.
+class Status
+{
+public:
+	constexpr Status() noexcept = default;
+
+	static constexpr Status failure(const char *function) noexcept { return Status{function}; }
+
+	/// From an SDL return code, negative on failure.
+	static constexpr Status check(int result, const char *function) noexcept
+	{
+		return result < 0 ? Status{function} : Status{};
+	}
+
+	constexpr bool ok() const noexcept { return m_function == nullptr; }
+	constexpr explicit operator bool() const noexcept { return ok(); }
+
+	/// nullptr on success.
+	constexpr const char *function() const noexcept { return m_function; }
+
+	/// Same text as Exception::what(), empty on success.
+	std::string message() const
+	{
+		if (ok())
+			return {};
+		return "Function: '" + std::string{m_function} + "', SDL error: " + Error::get();
+	}
+
+	/// Raises the Exception the throwing overload would have.
+	void raise() const
+	{
+		if (!ok())
+			SDLPP_THROW(Exception{m_function});
+	}
+
+private:
+	constexpr explicit Status(const char *function) noexcept
+	: m_function{function}
+	{}
+
+	const char *m_function = nullptr;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// A value, or the Status of the call that failed to produce it.
+template<typename T>
+class Result
+{
+public:
+	Result(T value)
+	: m_value{std::move(value)}
+	{}
+
+	/// status must be a failure. An ok one, which would leave no value,
+	/// asserts; release builds record a failure of "Result" instead, so
+	/// value() raises rather than reading nothing.
+	Result(Status status) noexcept
+	: m_status{status.ok() ? Status::failure("Result") : status}
+	{
+		assert(!status.ok());
+	}
+
+	bool ok() const noexcept { return m_value.has_value(); }
+	explicit operator bool() const noexcept { return ok(); }
+
+	const Status &status() const noexcept { return m_status; }
+
+	/// Raises status() on failure.
+	T &value() &
+	{
+		m_status.raise();
+		return *m_value;
+	}
+
+	const T &value() const &
+	{
+		m_status.raise();
+		return *m_value;
+	}
+
+	T &&value() &&
+	{
+		m_status.raise();
+		return std::move(*m_value);
+	}
+
+	template<typename U>
+	T valueOr(U &&fallback) const &
+	{
+		return ok() ? *m_value : static_cast<T>(std::forward<U>(fallback));
+	}
+
+	/// Unchecked.
+	T &operator *() noexcept { return *m_value; }
+	const T &operator *() const noexcept { return *m_value; }
+	T *operator ->() noexcept { return &*m_value; }
+	const T *operator ->() const noexcept { return &*m_value; }
+
+private:
+	Status m_status;
+	std::optional<T> m_value;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
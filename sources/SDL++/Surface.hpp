@@ -11,7 +11,9 @@
 
 #include "Exception.hpp"
 #include "Pixels.hpp"
+#include "PixelKernels.hpp"
 #include "Rect.hpp"
+#include "Status.hpp"
 #include "Vec2.hpp"
 
 #include <SDL2/SDL_surface.h>
@@ -19,6 +21,8 @@
 	#include <SDL2/SDL_image.h>
 #endif
 
+#include <atomic>
+#include <new>
 #include <string>
 #include <utility>
 
@@ -40,10 +44,20 @@ public:
 		{}
 
 	public:
+		Lock(const Lock&) = delete;
+
+		Lock(Lock &&other) noexcept
+		: m_surface{std::exchange(other.m_surface, nullptr)}
+		{}
+
 		~Lock() {
-			SDL_UnlockSurface(m_surface);
+			if (m_surface)
+				SDL_UnlockSurface(m_surface);
 		}
 
+		Lock &operator =(const Lock&) = delete;
+		Lock &operator =(Lock&&) = delete;
+
 		Pixel at(const Vec2i &pos) const {
 			return at(pos.x, pos.y);
 		}
@@ -68,6 +82,23 @@ public:
 
 	////////////////////////////////////////////////////////////////////////////
 
+	/// Opt-in replacement for IMG_Load in the filename constructors.
+	/// load() returns a new surface, or nullptr after setting the SDL error.
+	class Loader
+	{
+	public:
+		virtual ~Loader() = default;
+
+		virtual SDL_Surface *load(const std::string &filename) = 0;
+	};
+
+	/// Safe to call while other threads construct surfaces; each constructor
+	/// reads the loader once.
+	static void setLoader(Loader *loader) { s_loader.store(loader, std::memory_order_release); }
+	static Loader *loader() { return s_loader.load(std::memory_order_acquire); }
+
+	////////////////////////////////////////////////////////////////////////////
+
 	explicit Surface(SDL_Surface *surface)
 	: m_surface{surface}
 	{}
@@ -76,7 +107,7 @@ public:
 	: m_surface{SDL_CreateRGBSurfaceWithFormat(0, w, h, depth, format)}
 	{
 		if (!m_surface)
-			throw Exception{"SDL_CreateRGBSurfaceWithFormat"};
+			SDLPP_THROW(Exception{"SDL_CreateRGBSurfaceWithFormat"});
 	}
 
 	explicit Surface(const Vec2i &size, int depth = 32, Uint32 format = SDL_PIXELFORMAT_ARGB32)
@@ -87,33 +118,35 @@ public:
 	: m_surface{SDL_CreateRGBSurfaceWithFormatFrom(pixels, w, h, depth, depth / 8 * w, format)}
 	{
 		if (!m_surface)
-			throw Exception{"SDL_CreateRGBSurfaceWithFormatFrom"};
+			SDLPP_THROW(Exception{"SDL_CreateRGBSurfaceWithFormatFrom"});
 	}
 
 	explicit Surface(void *pixels, const Vec2i &size, int depth = 32, Uint32 format = SDL_PIXELFORMAT_ARGB32)
 	: Surface(pixels, size.x, size.y, depth, format)
 	{}
 
+	explicit Surface(void *pixels, int w, int h, int depth, int pitch, Uint32 format)
+	: m_surface{SDL_CreateRGBSurfaceWithFormatFrom(pixels, w, h, depth, pitch, format)}
+	{
+		if (!m_surface)
+			SDLPP_THROW(Exception{"SDL_CreateRGBSurfaceWithFormatFrom"});
+	}
+
 	Surface(Surface &&other) noexcept
 	{
 		*this = std::move(other);
 	}
 
-#ifdef SDLPP_USE_SDL_IMAGE
 	explicit Surface(const std::string &filename)
-	: m_surface{IMG_Load(filename.c_str())}
+	: Surface(filename, loader())
+	{}
+
+	explicit Surface(const std::string &filename, Loader &loader)
+	: m_surface{loader.load(filename)}
 	{
 		if (!m_surface)
-			throw Exception{"IMG_Load"};
-	}
-#else
-	explicit Surface(const std::string&)
-	: m_surface{nullptr}
-	{
-		SDL_SetError("Tried to call SDL::Surface(const std::string &filename) ctor. This function should call IMG_Load() from SDL_Image.\nThis program was built without SDL_Image.\nPlease Install SDL_Image and #define SDLPP_USE_SDL_IMAGE before including SDL.hpp to use this functionality");
-		throw Exception("IMG_Load");
+			SDLPP_THROW(Exception{"Surface::Loader::load"});
 	}
-#endif
 
 	~Surface()
 	{
@@ -124,17 +157,25 @@ public:
 
 	Surface withFormat(const SDL_PixelFormat &format) const
 	{
+		if (!format.palette) {
+			if (auto s = Kernels::convertSurface(m_surface, format.format))
+				return Surface{s};
+		}
+
 		auto s = SDL_ConvertSurface(m_surface, &format, 0);
 		if (!s)
-			throw Exception{"SDL_ConvertSurface"};
+			SDLPP_THROW(Exception{"SDL_ConvertSurface"});
 		return Surface{s};
 	}
 
 	Surface withFormat(Uint32 format) const
 	{
+		if (auto s = Kernels::convertSurface(m_surface, format))
+			return Surface{s};
+
 		auto s = SDL_ConvertSurfaceFormat(m_surface, format, 0);
 		if (!s)
-			throw Exception{"SDL_ConvertSurfaceFormat"};
+			SDLPP_THROW(Exception{"SDL_ConvertSurfaceFormat"});
 		return Surface{s};
 	}
 
@@ -157,16 +198,101 @@ public:
 
 	void blitOn(const Rect &src, Surface &surf, const Rect &dst) const
 	{
+		if (Kernels::blitSurface(m_surface, &src, surf.m_surface, &dst))
+			return;
+
 		auto dstmut = const_cast<Rect&>(dst);
 		if (SDL_BlitSurface(m_surface, &src, surf.m_surface, &dstmut) != 0)
-			throw Exception{"SDL_BlitSurface"};
+			SDLPP_THROW(Exception{"SDL_BlitSurface"});
 	}
 
 	void blitOn(Surface &surf, const Rect &dst) const
 	{
+		if (Kernels::blitSurface(m_surface, nullptr, surf.m_surface, &dst))
+			return;
+
 		auto dstmut = const_cast<Rect&>(dst);
 		if (SDL_BlitSurface(m_surface, nullptr, surf.m_surface, &dstmut) != 0)
-			throw Exception{"SDL_BlitSurface"};
+			SDLPP_THROW(Exception{"SDL_BlitSurface"});
+	}
+
+	/// Source-over blit where both surfaces hold premultiplied alpha, in the
+	/// same ARGB8888 or ABGR8888 format. The blend mode is ignored.
+	void blitPremultipliedOn(const Rect &src, Surface &surf, const Rect &dst) const
+	{
+		if (!Kernels::blitPremultiplied(m_surface, &src, surf.m_surface, &dst)) {
+			Error::set("Premultiplied blits need two unmodulated surfaces of the same ARGB8888 or ABGR8888 format");
+			SDLPP_THROW(Exception{"Kernels::blitPremultiplied"});
+		}
+	}
+
+	void blitPremultipliedOn(Surface &surf, const Rect &dst) const
+	{
+		if (!Kernels::blitPremultiplied(m_surface, nullptr, surf.m_surface, &dst)) {
+			Error::set("Premultiplied blits need two unmodulated surfaces of the same ARGB8888 or ABGR8888 format");
+			SDLPP_THROW(Exception{"Kernels::blitPremultiplied"});
+		}
+	}
+
+	/// Multiplies color by alpha in place. Surfaces without an 8-bit alpha
+	/// in the top byte are converted to ARGB8888 first.
+	void premultiplyAlpha()
+	{
+		if (!Kernels::premultiplySurface(m_surface) && !Kernels::premultiplySurface(convertTo(SDL_PIXELFORMAT_ARGB8888).m_surface))
+			SDLPP_THROW(Exception{"Kernels::premultiplySurface"});
+	}
+
+	void unpremultiplyAlpha()
+	{
+		if (!Kernels::unpremultiplySurface(m_surface) && !Kernels::unpremultiplySurface(convertTo(SDL_PIXELFORMAT_ARGB8888).m_surface))
+			SDLPP_THROW(Exception{"Kernels::unpremultiplySurface"});
+	}
+
+	void fill(Uint32 color)
+	{
+		if (Kernels::fillRect(m_surface, nullptr, color) != 0)
+			SDLPP_THROW(Exception{"SDL_FillRect"});
+	}
+
+	void fill(const Color &color)
+	{
+		fill(color.asUint(pixelFormat()));
+	}
+
+	void fillRect(const Rect &rect, Uint32 color)
+	{
+		if (Kernels::fillRect(m_surface, &rect, color) != 0)
+			SDLPP_THROW(Exception{"SDL_FillRect"});
+	}
+
+	void fillRect(const Rect &rect, const Color &color)
+	{
+		fillRect(rect, color.asUint(pixelFormat()));
+	}
+
+	using Filter = Kernels::Filter;
+
+	/// Resized copy keeping the pixel format, palette, color key, blend mode
+	/// and modulation. Filtered scaling of formats the kernels do not handle
+	/// goes through ARGB8888; paletted surfaces always use Nearest.
+	Surface scaled(const Vec2i &size, Filter filter = Filter::Nearest) const
+	{
+		if (m_surface->format->palette)
+			filter = Filter::Nearest;
+
+		Surface s{size.x, size.y, m_surface->format->BitsPerPixel, format()};
+		if (m_surface->format->palette && SDL_SetSurfacePalette(s.m_surface, m_surface->format->palette) != 0)
+			SDLPP_THROW(Exception{"SDL_SetSurfacePalette"});
+
+		if (!Kernels::resample(m_surface, s.m_surface, filter)) {
+			if (filter != Filter::Nearest && format() != SDL_PIXELFORMAT_ARGB8888)
+				return withFormat(SDL_PIXELFORMAT_ARGB8888).scaled(size, filter).withFormat(format());
+			if (SDL_SoftStretch(m_surface, nullptr, s.m_surface, nullptr) != 0)
+				SDLPP_THROW(Exception{"SDL_SoftStretch"});
+		}
+
+		s.copyAttributes(*this);
+		return s;
 	}
 
 	Vec2i size() const { return Vec2i{width(), height()}; }
@@ -187,40 +313,40 @@ public:
 	void disableColorKey() const
 	{
 		if (SDL_SetColorKey(m_surface, SDL_FALSE, 0) != 0)
-			throw Exception{"SDL_SetColorKey"};
+			SDLPP_THROW(Exception{"SDL_SetColorKey"});
 	}
 
 	void setColorKey(Uint32 key) const
 	{
 		if (SDL_SetColorKey(m_surface, SDL_TRUE, key) != 0)
-			throw Exception{"SDL_SetColorKey"};
+			SDLPP_THROW(Exception{"SDL_SetColorKey"});
 	}
 
 	void setColorKey(const Color &color) const
 	{
 		if (SDL_SetColorKey(m_surface, SDL_TRUE, color.asUint(pixelFormat())) != 0)
-			throw Exception{"SDL_SetColorKey"};
+			SDLPP_THROW(Exception{"SDL_SetColorKey"});
 	}
 
 	Color colorKey() const
 	{
 		Uint32 k;
 		if (SDL_GetColorKey(m_surface, &k) != 0)
-			throw Exception{"SDL_GetColorKey"};
+			SDLPP_THROW(Exception{"SDL_GetColorKey"});
 		return Color{k, pixelFormat()};
 	}
 
 	void setBlendMode(const SDL_BlendMode &bm) const
 	{
 		if (SDL_SetSurfaceBlendMode(m_surface, bm) != 0)
-			throw Exception{"SDL_SetSurfaceBlendMode"};
+			SDLPP_THROW(Exception{"SDL_SetSurfaceBlendMode"});
 	}
 
 	SDL_BlendMode blendMode() const
 	{
 		SDL_BlendMode bm;
 		if (SDL_GetSurfaceBlendMode(m_surface, &bm) != 0)
-			throw Exception{"SDL_GetSurfaceBlendMode"};
+			SDLPP_THROW(Exception{"SDL_GetSurfaceBlendMode"});
 		return bm;
 	}
 
@@ -232,28 +358,28 @@ public:
 	void setColorMod(Uint8 r, Uint8 g, Uint8 b) const
 	{
 		if (SDL_SetSurfaceColorMod(m_surface, r, g, b))
-			throw Exception{"SDL_SetSurfaceColorMod"};
+			SDLPP_THROW(Exception{"SDL_SetSurfaceColorMod"});
 	}
 
 	Color colorMod() const
 	{
 		Color c;
 		if (SDL_GetSurfaceColorMod(m_surface, &c.r, &c.g, &c.b) != 0)
-			throw Exception{"SDL_SetSurfaceColorMod"};
+			SDLPP_THROW(Exception{"SDL_SetSurfaceColorMod"});
 		return c;
 	}
 
 	void setAlphaMod(Uint8 alpha) const
 	{
 		if (SDL_SetSurfaceAlphaMod(m_surface, alpha) != 0)
-			throw Exception{"SDL_SetSurfaceAlphaMod"};
+			SDLPP_THROW(Exception{"SDL_SetSurfaceAlphaMod"});
 	}
 
 	Uint8 alphaMod() const
 	{
 		Uint8 alpha;
 		if (SDL_GetSurfaceAlphaMod(m_surface, &alpha) != 0)
-			throw Exception{"SDL_GetSurfaceAlphaMod"};
+			SDLPP_THROW(Exception{"SDL_GetSurfaceAlphaMod"});
 		return alpha;
 	}
 
@@ -279,7 +405,14 @@ public:
 	Lock lock() const
 	{
 		if (SDL_LockSurface(m_surface) != 0)
-			throw Exception{"SDL_LockSurface"};
+			SDLPP_THROW(Exception{"SDL_LockSurface"});
+		return Lock{*m_surface};
+	}
+
+	Result<Lock> lock(std::nothrow_t) const
+	{
+		if (SDL_LockSurface(m_surface) != 0)
+			return Status::failure("SDL_LockSurface");
 		return Lock{*m_surface};
 	}
 
@@ -298,6 +431,34 @@ public:
 	}
 
 private:
+#ifdef SDLPP_USE_SDL_IMAGE
+	Surface(const std::string &filename, Loader *loader)
+	: m_surface{loader ? loader->load(filename) : IMG_Load(filename.c_str())}
+	{
+		if (!m_surface)
+			SDLPP_THROW(Exception{loader ? "Surface::Loader::load" : "IMG_Load"});
+	}
+#else
+	Surface(const std::string &filename, Loader *loader)
+	: m_surface{loader ? loader->load(filename) : nullptr}
+	{
+		if (!loader)
+			SDL_SetError("Tried to call SDL::Surface(const std::string &filename) ctor. This function should call IMG_Load() from SDL_Image.\nThis program was built without SDL_Image.\nPlease Install SDL_Image and #define SDLPP_USE_SDL_IMAGE before including SDL.hpp to use this functionality");
+		if (!m_surface)
+			SDLPP_THROW(Exception(loader ? "Surface::Loader::load" : "IMG_Load"));
+	}
+#endif
+
+	void copyAttributes(const Surface &other) const
+	{
+		if (Uint32 key; SDL_GetColorKey(other.m_surface, &key) == 0)
+			setColorKey(key);
+		setBlendMode(other.blendMode());
+		setColorAlphaMod(other.colorAlphaMod());
+	}
+
+	static inline std::atomic<Loader*> s_loader{nullptr};
+
 	SDL_Surface *m_surface = nullptr;
 };
 
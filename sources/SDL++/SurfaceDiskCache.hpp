@@ -0,0 +1,80 @@
+/*
+** SDL++, 2020
+** SurfaceDiskCache.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Exception.hpp"
+#include "Surface.hpp"
+
+#include <SDL2/SDL_pixels.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// On-disk cache of decoded images, stored in the requested pixel format.
+///
+/// Each source path owns one cache file recording the source size, mtime and
+/// content hash. An unchanged size and mtime is a hit without reading the
+/// source; otherwise the source is hashed and the entry is reused only if the
+/// content hash still matches. Everything else decodes and rewrites the entry.
+///
+/// Install it with Surface::setLoader() to make Surface(filename) go through
+/// the cache, or pass it explicitly as Surface(filename, cache). load() may run
+/// on several threads at once.
+class SurfaceDiskCache : public Surface::Loader
+{
+public:
+	struct Stats
+	{
+		Uint64 hits = 0;
+		Uint64 rehashedHits = 0; ///< hits validated by content hash after an mtime change
+		Uint64 misses = 0;
+		Uint64 writeErrors = 0;
+
+		Uint64 lookups() const { return hits + misses; }
+		double hitRate() const { return lookups() ? double(hits) / double(lookups()) : 0.0; }
+	};
+
+	explicit SurfaceDiskCache(const std::string &directory, Uint32 format = SDL_PIXELFORMAT_ARGB8888);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	SDL_Surface *load(const std::string &filename) override;
+
+	Surface get(const std::string &filename) { return Surface{filename, *this}; }
+
+	const std::string &directory() const { return m_directory; }
+	Uint32 format() const { return m_format; }
+
+	Stats stats() const;
+	void resetStats();
+
+private:
+	std::string cachePath(const std::string &filename) const;
+	SDL_Surface *decode(const std::string &filename) const;
+	void store(const std::string &path, SDL_Surface *surface, Uint64 contentHash, Sint64 mtime, Uint64 sourceSize);
+	void count(Uint64 Stats::*counter);
+
+	std::string m_directory;
+	Uint32 m_format;
+	Stats m_stats;
+	mutable std::mutex m_mutex;
+	Uint64 m_token;
+	std::atomic<Uint32> m_writes{0};
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
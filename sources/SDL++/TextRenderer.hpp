@@ -0,0 +1,116 @@
+/*
+** SDL++, 2020
+** TextRenderer.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "BitmapFont.hpp"
+#include "Pixels.hpp"
+#include "Render.hpp"
+#include "Vec2.hpp"
+
+#include <SDL2/SDL_render.h>
+#include <SDL2/SDL_stdinc.h>
+#include <SDL2/SDL_version.h>
+
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Queues BitmapFont text and draws it with one SDL_RenderGeometry() call
+/// per atlas page, instead of one copy per glyph.
+///
+/// Layouts are cached by font and string (least recently used first out),
+/// so labels that do not change are laid out once; draw() then only offsets
+/// and tints the cached vertices. Each page is drawn in one piece, in the
+/// order pages were first queued, so text overlapping across pages may not
+/// stack in draw() order.
+class TextRenderer
+{
+public:
+	struct Stats
+	{
+		Uint64 layoutHits = 0;
+		Uint64 layoutMisses = 0;
+		/// Of the last flush().
+		size_t glyphs = 0;
+		size_t batches = 0;
+	};
+
+	explicit TextRenderer(size_t cacheCapacity = 1024);
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Queues text with the top-left corner of its first line at pos.
+	void draw(const BitmapFont &font, std::string_view text, const Vec2f &pos, const Color &color = Color::White);
+
+	/// Size of the text's layout, through the cache.
+	Vec2i measure(const BitmapFont &font, std::string_view text);
+
+	/// Draws and clears everything queued.
+	void flush(const Renderer &renderer);
+
+	/// Drops everything queued without drawing it.
+	void discard();
+
+	////////////////////////////////////////////////////////////////////////////
+
+	size_t cacheSize() const { return m_lru.size(); }
+	size_t cacheCapacity() const { return m_capacity; }
+	void setCacheCapacity(size_t capacity);
+	void clearCache();
+
+	const Stats &stats() const { return m_stats; }
+	void resetStats() { m_stats = Stats{}; }
+
+private:
+	/// A laid out string: four vertices per glyph relative to the text's
+	/// corner, untinted, with the page of every glyph.
+	struct Entry
+	{
+		Uint64 hash;
+		Uint32 font;
+		std::string text;
+		std::vector<SDL_Vertex> vertices;
+		std::vector<Uint16> pages;
+		Vec2i size;
+	};
+
+	struct Batch
+	{
+		SDL_Texture *texture;
+		std::vector<SDL_Vertex> vertices;
+		std::vector<int> indices;
+	};
+
+	const Entry &lookup(const BitmapFont &font, std::string_view text);
+	Batch &batchFor(SDL_Texture *texture);
+
+	size_t m_capacity;
+	std::list<Entry> m_lru;
+	std::unordered_map<Uint64, std::list<Entry>::iterator> m_entries;
+	BitmapFont::Layout m_layout;
+
+	std::vector<Batch> m_batches;
+	Stats m_stats;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif
@@ -7,14 +7,18 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "Error.hpp"
 #include "Exception.hpp"
 #include "Pixels.hpp"
 #include "Rect.hpp"
+#include "Status.hpp"
 #include "Surface.hpp"
 #include "Vec2.hpp"
 
 #include <SDL2/SDL_render.h>
+#include <SDL2/SDL_version.h>
 
+#include <new>
 #include <string>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -34,13 +38,13 @@ public:
 		: m_texture{texture}
 		{
 			if (SDL_LockTexture(m_texture, rect, &m_pixels, &m_pitch) != 0)
-				throw Exception{"SDL_LockTexture"};
+				SDLPP_THROW(Exception{"SDL_LockTexture"});
 
 			Uint32 f = 0;
 			SDL_QueryTexture(m_texture, &f, nullptr, &m_size.x, &m_size.y);
 			m_format = SDL_AllocFormat(f);
 			if (!m_format)
-				throw Exception{"SDL_AllocFormat"};
+				SDLPP_THROW(Exception{"SDL_AllocFormat"});
 		}
 
 	public:
@@ -90,7 +94,7 @@ public:
 	: Texture{SDL_CreateTexture(render, format, access, w, h)}
 	{
 		if (!m_texture)
-			throw Exception{"SDL_CreateTexture"};
+			SDLPP_THROW(Exception{"SDL_CreateTexture"});
 	}
 
 	Texture(SDL_Renderer *render, const Vec2i &size, SDL_PixelFormatEnum format = SDL_PIXELFORMAT_ARGB32, SDL_TextureAccess access = SDL_TEXTUREACCESS_STREAMING)
@@ -101,13 +105,56 @@ public:
 	: Texture{SDL_CreateTextureFromSurface(render, surface.ptr())}
 	{
 		if (!m_texture)
-			throw Exception{"SDL_CreateTextureFromSurface"};
+			SDLPP_THROW(Exception{"SDL_CreateTextureFromSurface"});
 	}
 
 	Texture(SDL_Renderer *render, const std::string &filename)
 	: Texture{render, Surface{filename}}
 	{}
 
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+	/// Uploads surface with premultiplied alpha, premultiplying an ARGB8888
+	/// copy unless the pixels already are. SDL_BLENDMODE_BLEND on the result
+	/// maps to premultipliedBlendMode(), and it is set right away.
+	/// Fading through the alpha mod needs the same factor in the color mod.
+	/// Renderers without custom blend modes, such as the software renderer,
+	/// get a straight alpha texture with plain blending instead, see
+	/// isPremultiplied().
+	static Texture premultiplied(SDL_Renderer *render, const Surface &surface, bool alreadyPremultiplied = false)
+	{
+		Texture t = [&] {
+			if (alreadyPremultiplied)
+				return Texture{render, surface};
+			auto copy = surface.withFormat(SDL_PIXELFORMAT_ARGB8888);
+			copy.premultiplyAlpha();
+			return Texture{render, copy};
+		}();
+		t.m_premultiplied = true;
+		if (t.setBlendMode(SDL_BLENDMODE_BLEND, std::nothrow))
+			return t;
+
+		Error::clear();
+		Texture straight = [&] {
+			if (!alreadyPremultiplied)
+				return Texture{render, surface};
+			auto copy = surface.withFormat(SDL_PIXELFORMAT_ARGB8888);
+			copy.unpremultiplyAlpha();
+			return Texture{render, copy};
+		}();
+		straight.setBlendMode(SDL_BLENDMODE_BLEND);
+		return straight;
+	}
+
+	/// dst = src + dst * (1 - srcAlpha) on color and alpha.
+	static SDL_BlendMode premultipliedBlendMode()
+	{
+		static const SDL_BlendMode mode = SDL_ComposeCustomBlendMode(
+			SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+			SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+		return mode;
+	}
+#endif
+
 	Texture(const Texture &) = delete;
 
 	Texture(Texture &&other) noexcept
@@ -124,27 +171,44 @@ public:
 
 	void update(const void *pixels, int pitch)
 	{
-		if (SDL_UpdateTexture(m_texture, NULL, pixels, pitch) != 0)
-			throw Exception{"SDL_UpdateTexture"};
+		update(pixels, pitch, std::nothrow).raise();
 	}
 
 	void update(const void *pixels, const SDL_Rect &rect, int pitch)
 	{
-		if (SDL_UpdateTexture(m_texture, &rect, pixels, pitch) != 0)
-			throw Exception{"SDL_UpdateTexture"};
+		update(pixels, rect, pitch, std::nothrow).raise();
+	}
+
+	Status update(const void *pixels, int pitch, std::nothrow_t) noexcept
+	{
+		return Status::check(SDL_UpdateTexture(m_texture, NULL, pixels, pitch), "SDL_UpdateTexture");
+	}
+
+	Status update(const void *pixels, const SDL_Rect &rect, int pitch, std::nothrow_t) noexcept
+	{
+		return Status::check(SDL_UpdateTexture(m_texture, &rect, pixels, pitch), "SDL_UpdateTexture");
 	}
 
 	void setBlendMode(const SDL_BlendMode &bm) const
 	{
-		if (SDL_SetTextureBlendMode(m_texture, bm) != 0)
-			throw Exception{"SDL_SetTextureBlendMode"};
+		setBlendMode(bm, std::nothrow).raise();
+	}
+
+	Status setBlendMode(const SDL_BlendMode &bm, std::nothrow_t) const noexcept
+	{
+#if SDL_VERSION_ATLEAST(2, 0, 6)
+		const SDL_BlendMode mode = m_premultiplied && bm == SDL_BLENDMODE_BLEND ? premultipliedBlendMode() : bm;
+#else
+		const SDL_BlendMode mode = bm;
+#endif
+		return Status::check(SDL_SetTextureBlendMode(m_texture, mode), "SDL_SetTextureBlendMode");
 	}
 
 	SDL_BlendMode blendMode() const
 	{
 		SDL_BlendMode bm;
 		if (SDL_GetTextureBlendMode(m_texture, &bm) != 0)
-			throw Exception{"SDL_GetTextureBlendMode"};
+			SDLPP_THROW(Exception{"SDL_GetTextureBlendMode"});
 		return bm;
 	}
 
@@ -155,29 +219,37 @@ public:
 
 	void setColorMod(Uint8 r, Uint8 g, Uint8 b) const
 	{
-		if (SDL_SetTextureColorMod(m_texture, r, g, b) != 0)
-			throw Exception{"SDL_SetTextureColorMod"};
+		setColorMod(Color{r, g, b}, std::nothrow).raise();
+	}
+
+	Status setColorMod(const Color &color, std::nothrow_t) const noexcept
+	{
+		return Status::check(SDL_SetTextureColorMod(m_texture, color.r, color.g, color.b), "SDL_SetTextureColorMod");
 	}
 
 	Color colorMod() const
 	{
 		Color c;
 		if (SDL_GetTextureColorMod(m_texture, &c.r, &c.g, &c.b) != 0)
-			throw Exception{"SDL_SetTextureColorMod"};
+			SDLPP_THROW(Exception{"SDL_SetTextureColorMod"});
 		return c;
 	}
 
 	void setAlphaMod(Uint8 alpha) const
 	{
-		if (SDL_SetTextureAlphaMod(m_texture, alpha) != 0)
-			throw Exception{"SDL_SetTextureAlphaMod"};
+		setAlphaMod(alpha, std::nothrow).raise();
+	}
+
+	Status setAlphaMod(Uint8 alpha, std::nothrow_t) const noexcept
+	{
+		return Status::check(SDL_SetTextureAlphaMod(m_texture, alpha), "SDL_SetTextureAlphaMod");
 	}
 
 	Uint8 alphaMod() const
 	{
 		Uint8 alpha;
 		if (SDL_GetTextureAlphaMod(m_texture, &alpha) != 0)
-			throw Exception{"SDL_GetTextureAlphaMod"};
+			SDLPP_THROW(Exception{"SDL_GetTextureAlphaMod"});
 		return alpha;
 	}
 
@@ -204,7 +276,7 @@ public:
 	{
 		Uint32 f = 0;
 		if (SDL_QueryTexture(m_texture, &f, nullptr, nullptr, nullptr) != 0)
-			throw Exception{"SDL_QueryTexture"};
+			SDLPP_THROW(Exception{"SDL_QueryTexture"});
 		return f;
 	}
 
@@ -212,7 +284,7 @@ public:
 	{
 		int a = 0;
 		if (SDL_QueryTexture(m_texture, nullptr, &a, nullptr, nullptr) != 0)
-			throw Exception{"SDL_QueryTexture"};
+			SDLPP_THROW(Exception{"SDL_QueryTexture"});
 		return a;
 	}
 
@@ -220,7 +292,7 @@ public:
 	{
 		Vec2i s;
 		if (SDL_QueryTexture(m_texture, nullptr, nullptr, &s.x, &s.y) != 0)
-			throw Exception{"SDL_QueryTexture"};
+			SDLPP_THROW(Exception{"SDL_QueryTexture"});
 		return s;
 	}
 
@@ -228,6 +300,7 @@ public:
 	Lock lock(const Rect &rect) { return Lock{m_texture, &rect}; }
 
 	SDL_Texture *ptr() const { return m_texture; }
+	bool isPremultiplied() const { return m_premultiplied; }
 
 	////////////////////////////////////////////////////////////////////////////
 
@@ -238,6 +311,7 @@ public:
 		if (m_texture != other.m_texture) {
 			SDL_DestroyTexture(m_texture);
 			m_texture= other.m_texture;
+			m_premultiplied = other.m_premultiplied;
 			other.m_texture = nullptr;
 		}
 		return *this;
@@ -245,6 +319,7 @@ public:
 
 private:
 	SDL_Texture *m_texture = nullptr;
+	bool m_premultiplied = false;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
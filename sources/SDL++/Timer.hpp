@@ -52,7 +52,7 @@ public:
 	{
 		SDL_TimerID id = SDL_AddTimer(interval, function, user_context);
 		if (!id)
-			throw Exception("SDL_AddTimer");
+			SDLPP_THROW(Exception("SDL_AddTimer"));
 		return Timer(id);
 	}
 
@@ -0,0 +1,139 @@
+/*
+** SDL++, 2020
+** UploadScheduler.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Render.hpp"
+#include "Surface.hpp"
+#include "Texture.hpp"
+
+#include <SDL2/SDL_stdinc.h>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <optional>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Spreads Surface to Texture uploads over frames: enqueue() returns a
+/// handle drawing a placeholder until update(), called once per frame,
+/// has uploaded the surface within its time budget.
+///
+/// Visible surfaces go first, then Soon, then Background, in enqueue order
+/// within a priority. Upload cost is predicted from the bytes per tick seen
+/// so far, so a frame stops before an upload that would overrun it, but
+/// always uploads at least one surface to keep the queue moving. Surfaces
+/// whose handles were all dropped before their upload are discarded. The
+/// scheduler must outlive its handles and belongs to the rendering thread.
+class UploadScheduler
+{
+	struct State;
+
+public:
+	enum class Priority
+	{
+		Visible,
+		Soon,
+		Background,
+	};
+
+	struct Stats
+	{
+		Uint64 uploads = 0;
+		Uint64 bytes = 0;
+		Uint64 cancelled = 0;
+		/// Of the last update().
+		size_t frameUploads = 0;
+		size_t frameBytes = 0;
+		double frameMs = 0.0;
+	};
+
+	class Handle
+	{
+	public:
+		Handle() = default;
+
+		bool ready() const { return m_state && m_state->ready; }
+
+		/// The uploaded texture, or the scheduler's placeholder until ready().
+		Texture &texture() const { return ready() ? m_state->texture : m_state->scheduler->m_placeholder; }
+
+		/// Moves a pending upload, e.g. to Visible when it comes on screen.
+		void setPriority(Priority priority) const;
+
+		explicit operator bool() const { return m_state != nullptr; }
+
+	private:
+		friend class UploadScheduler;
+
+		explicit Handle(std::shared_ptr<State> state)
+		: m_state{std::move(state)}
+		{}
+
+		std::shared_ptr<State> m_state;
+	};
+
+	/// The default placeholder is a transparent pixel.
+	explicit UploadScheduler(const Renderer &renderer);
+	UploadScheduler(const Renderer &renderer, Texture placeholder);
+
+	UploadScheduler(const UploadScheduler&) = delete;
+	UploadScheduler &operator =(const UploadScheduler&) = delete;
+
+	////////////////////////////////////////////////////////////////////////////
+
+	Handle enqueue(Surface surface, Priority priority = Priority::Soon);
+
+	/// Uploads queued surfaces until budget is spent; returns how many.
+	size_t update(std::chrono::microseconds budget = std::chrono::microseconds{2000});
+
+	/// Uploads everything queued, e.g. behind a loading screen.
+	size_t flush();
+
+	size_t queueDepth() const { return m_pending; }
+	size_t queuedBytes() const { return m_pendingBytes; }
+
+	const Stats &stats() const { return m_stats; }
+	void resetStats() { m_stats = Stats{}; }
+
+	Texture &placeholder() { return m_placeholder; }
+
+private:
+	struct State
+	{
+		UploadScheduler *scheduler;
+		std::optional<Surface> surface;
+		Texture texture;
+		size_t bytes;
+		Priority priority;
+		bool ready = false;
+	};
+
+	size_t run(Uint64 budgetTicks);
+	std::shared_ptr<State> next();
+	void cancel(const State &state);
+
+	SDL_Renderer *m_renderer;
+	Texture m_placeholder;
+	// One queue per priority. Handles own the pending surfaces, so entries
+	// expire when cancelled and go stale when their priority changes.
+	std::deque<std::weak_ptr<State>> m_queues[3];
+	size_t m_pending = 0;
+	size_t m_pendingBytes = 0;
+	double m_ticksPerByte = 0.0;
+	Stats m_stats;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -8,6 +8,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <SDL2/SDL_rect.h>
+#include <SDL2/SDL_version.h>
 
 #include <algorithm>
 #include <cmath>
@@ -32,7 +33,11 @@ namespace details {
 template<typename T, class Base = details::Vec2Base<T>>
 struct Vec2 : public Base
 {
-	constexpr Vec2() = default;
+	/// Zero, whatever the base: SDL_Point and SDL_FPoint have no member
+	/// initializers.
+	constexpr Vec2()
+	: Base{}
+	{}
 
 	constexpr Vec2(T x, T y)
 	: Base{x, y}
@@ -43,8 +48,8 @@ struct Vec2 : public Base
 	: Base{static_cast<T>(x), static_cast<T>(y)}
 	{}
 
-	template <typename U>
-	constexpr Vec2(const Vec2<U> &v)
+	template <typename U, class B>
+	constexpr Vec2(const Vec2<U, B> &v)
 	: Base{static_cast<T>(v.x), static_cast<T>(v.y)}
 	{}
 
@@ -150,7 +155,13 @@ struct Vec2 : public Base
 };
 
 using Vec2i = Vec2<int, SDL_Point>;
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+// Layout-compatible with SDL_FPoint, so arrays go straight to the float
+// rendering functions.
+using Vec2f = Vec2<float, SDL_FPoint>;
+#else
 using Vec2f = Vec2<float>;
+#endif
 using Vec2d = Vec2<double>;
 
 ////////////////////////////////////////////////////////////////////////////////
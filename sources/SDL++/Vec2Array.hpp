@@ -0,0 +1,263 @@
+/*
+** SDL++, 2020
+** Vec2Array.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "GeometryKernels.hpp"
+#include "Vec2.hpp"
+
+#include <SDL2/SDL_rect.h>
+#include <SDL2/SDL_version.h>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Vectors stored as one array of x and one array of y, for operations over
+/// many points at once (particles, vertices, culling).
+///
+/// float and int use the SIMD loops of GeometryKernels.hpp; other types take
+/// plain loops. Elements are read and written by value as Vec2.
+template<typename T>
+class Vec2Array
+{
+public:
+	using Vec = std::conditional_t<std::is_same_v<T, int>, Vec2i, std::conditional_t<std::is_same_v<T, float>, Vec2f, Vec2<T>>>;
+
+	struct Bounds
+	{
+		Vec min;
+		Vec max;
+	};
+
+	Vec2Array() = default;
+
+	explicit Vec2Array(size_t size)
+	: m_x(size)
+	, m_y(size)
+	{}
+
+	template<class Container>
+	static Vec2Array from(const Container &points)
+	{
+		Vec2Array r;
+		r.reserve(points.size());
+		for (const auto &p : points)
+			r.push_back(Vec{p.x, p.y});
+		return r;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	size_t size() const { return m_x.size(); }
+	bool empty() const { return m_x.empty(); }
+
+	void reserve(size_t size)
+	{
+		m_x.reserve(size);
+		m_y.reserve(size);
+	}
+
+	void resize(size_t size)
+	{
+		m_x.resize(size);
+		m_y.resize(size);
+	}
+
+	void clear()
+	{
+		m_x.clear();
+		m_y.clear();
+	}
+
+	void push_back(const Vec &v)
+	{
+		m_x.push_back(v.x);
+		m_y.push_back(v.y);
+	}
+
+	Vec operator [](size_t i) const { return Vec{m_x[i], m_y[i]}; }
+
+	void set(size_t i, const Vec &v)
+	{
+		m_x[i] = v.x;
+		m_y[i] = v.y;
+	}
+
+	/// Removes element i by moving the last one in its place.
+	void swapRemove(size_t i)
+	{
+		m_x[i] = m_x.back();
+		m_y[i] = m_y.back();
+		m_x.pop_back();
+		m_y.pop_back();
+	}
+
+	T *x() { return m_x.data(); }
+	T *y() { return m_y.data(); }
+	const T *x() const { return m_x.data(); }
+	const T *y() const { return m_y.data(); }
+
+	////////////////////////////////////////////////////////////////////////////
+
+	void translate(const Vec &d)
+	{
+		if constexpr (std::is_same_v<T, float> || std::is_same_v<T, int>) {
+			Kernels::translatePoints(x(), y(), size(), d.x, d.y);
+		} else {
+			for (size_t i = 0; i < size(); ++i) {
+				m_x[i] += d.x;
+				m_y[i] += d.y;
+			}
+		}
+	}
+
+	/// Adds velocities[i] * dt to every element that has a velocity.
+	void integrate(const Vec2Array &velocities, T dt)
+	{
+		const T *vx = velocities.x();
+		const T *vy = velocities.y();
+		const size_t n = std::min(size(), velocities.size());
+		for (size_t i = 0; i < n; ++i) {
+			m_x[i] += vx[i] * dt;
+			m_y[i] += vy[i] * dt;
+		}
+	}
+
+	void scale(T factor)
+	{
+		scale(Vec{factor, factor});
+	}
+
+	void scale(const Vec &factors)
+	{
+		if constexpr (std::is_same_v<T, float>) {
+			Kernels::scalePoints(x(), y(), size(), factors.x, factors.y);
+		} else {
+			for (size_t i = 0; i < size(); ++i) {
+				m_x[i] *= factors.x;
+				m_y[i] *= factors.y;
+			}
+		}
+	}
+
+	/// Unlike Vec2::normalize(), only zero-length vectors are left unchanged.
+	void normalize()
+	{
+		static_assert(std::is_floating_point_v<T>, "normalize() needs floating point coordinates");
+
+		if constexpr (std::is_same_v<T, float>) {
+			Kernels::normalizePoints(x(), y(), size());
+		} else {
+			for (size_t i = 0; i < size(); ++i) {
+				const T length = std::sqrt(m_x[i] * m_x[i] + m_y[i] * m_y[i]);
+				if (length > T(0)) {
+					m_x[i] /= length;
+					m_y[i] /= length;
+				}
+			}
+		}
+	}
+
+	void lengths(std::vector<T> &out) const
+	{
+		static_assert(std::is_floating_point_v<T>, "lengths() needs floating point coordinates");
+
+		out.resize(size());
+		if constexpr (std::is_same_v<T, float>) {
+			Kernels::pointLengths(x(), y(), out.data(), size());
+		} else {
+			for (size_t i = 0; i < size(); ++i)
+				out[i] = std::sqrt(m_x[i] * m_x[i] + m_y[i] * m_y[i]);
+		}
+	}
+
+	/// Same bounds as Vec2::clamp(): box.x to box.x + box.w inclusive.
+	void clamp(const SDL_Rect &box)
+	{
+		clamp(Vec{box.x, box.y}, Vec{box.x + box.w, box.y + box.h});
+	}
+
+	void clamp(const Vec &min, const Vec &max)
+	{
+		if constexpr (std::is_same_v<T, float> || std::is_same_v<T, int>) {
+			Kernels::clampPoints(x(), y(), size(), min.x, min.y, max.x, max.y);
+		} else {
+			for (size_t i = 0; i < size(); ++i) {
+				m_x[i] = std::min(std::max(m_x[i], min.x), max.x);
+				m_y[i] = std::min(std::max(m_y[i], min.y), max.y);
+			}
+		}
+	}
+
+	/// Componentwise minimum and maximum, both zero when empty.
+	Bounds bounds() const
+	{
+		if (empty())
+			return Bounds{};
+
+		Bounds b{Vec{m_x[0], m_y[0]}, Vec{m_x[0], m_y[0]}};
+		if constexpr (std::is_same_v<T, float> || std::is_same_v<T, int>) {
+			Kernels::pointBounds(x(), y(), size(), b.min.x, b.min.y, b.max.x, b.max.y);
+		} else {
+			for (size_t i = 1; i < size(); ++i) {
+				b.min = Vec{std::min(b.min.x, m_x[i]), std::min(b.min.y, m_y[i])};
+				b.max = Vec{std::max(b.max.x, m_x[i]), std::max(b.max.y, m_y[i])};
+			}
+		}
+		return b;
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+
+	/// Interleaves the coordinates for Renderer::drawPoints() and friends,
+	/// truncating toward zero for floating point types.
+	void toPoints(std::vector<SDL_Point> &out) const
+	{
+		out.resize(size());
+		for (size_t i = 0; i < size(); ++i)
+			out[i] = SDL_Point{static_cast<int>(m_x[i]), static_cast<int>(m_y[i])};
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 10)
+	void toPoints(std::vector<SDL_FPoint> &out) const
+	{
+		out.resize(size());
+		for (size_t i = 0; i < size(); ++i)
+			out[i] = SDL_FPoint{static_cast<float>(m_x[i]), static_cast<float>(m_y[i])};
+	}
+
+	/// Square of side size centered on every point, e.g. for particles.
+	void toRects(float size, std::vector<SDL_FRect> &out) const
+	{
+		const float half = size / 2.0f;
+		out.resize(this->size());
+		for (size_t i = 0; i < out.size(); ++i)
+			out[i] = SDL_FRect{static_cast<float>(m_x[i]) - half, static_cast<float>(m_y[i]) - half, size, size};
+	}
+#endif
+
+private:
+	std::vector<T> m_x;
+	std::vector<T> m_y;
+};
+
+using Vec2iArray = Vec2Array<int>;
+using Vec2fArray = Vec2Array<float>;
+using Vec2dArray = Vec2Array<double>;
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
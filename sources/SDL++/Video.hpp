@@ -34,7 +34,7 @@ public:
 	: m_window{SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, size.x, size.y, flags)}
 	{
 		if (!m_window)
-			throw Exception{"SDL_CreateWindow"};
+			SDLPP_THROW(Exception{"SDL_CreateWindow"});
 	}
 
 	Window(Window&) = delete;
@@ -55,7 +55,7 @@ public:
 	{
 		const auto render = SDL_CreateRenderer(m_window, -1, flags);
 		if (!render)
-			throw Exception{"SDL_CreateRenderer"};
+			SDLPP_THROW(Exception{"SDL_CreateRenderer"});
 		return Renderer{render};
 	}
 
@@ -63,21 +63,21 @@ public:
 	{
 		const auto r = SDL_GetWindowDisplayIndex(m_window);
 		if (r == -1)
-			throw Exception{"SDL_GetWindowDisplayIndex"};
+			SDLPP_THROW(Exception{"SDL_GetWindowDisplayIndex"});
 		return r;
 	}
 
 	void setDisplayMode(const SDL_DisplayMode &mode) const
 	{
 		if (SDL_SetWindowDisplayMode(m_window, &mode) != 0)
-			throw Exception{"SDL_SetWindowDisplayMode"};
+			SDLPP_THROW(Exception{"SDL_SetWindowDisplayMode"});
 	}
 
 	SDL_DisplayMode displayMode() const
 	{
 		SDL_DisplayMode mode;
 		if (SDL_GetWindowDisplayMode(m_window, &mode) != 0)
-			throw Exception{"SDL_GetWindowDisplayMode"};
+			SDLPP_THROW(Exception{"SDL_GetWindowDisplayMode"});
 		return mode;
 	}
 
@@ -135,7 +135,7 @@ public:
 	void setFullscreen(bool fs)
 	{
 		if (SDL_SetWindowFullscreen(m_window, fs ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0) != 0)
-			throw Exception{"SDL_SetWindowFullscreen"};
+			SDLPP_THROW(Exception{"SDL_SetWindowFullscreen"});
 	}
 
 	void toggleFullscreen()
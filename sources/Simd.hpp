@@ -0,0 +1,29 @@
+/*
+** SDL++, 2020
+** Simd.hpp
+*/
+
+#pragma once
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <SDL2/SDL_endian.h>
+
+// Shared by the kernel translation units: which intrinsics are available and
+// how to compile a single function for a newer instruction set.
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+	#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+		#define SDLPP_KERNELS_X86
+		#include <immintrin.h>
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#define SDLPP_KERNELS_NEON
+		#include <arm_neon.h>
+	#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+	#define SDLPP_TARGET(isa) __attribute__((target(isa)))
+#else
+	#define SDLPP_TARGET(isa)
+#endif
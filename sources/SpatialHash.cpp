@@ -0,0 +1,170 @@
+/*
+** SDL++, 2020
+** SpatialHash.cpp
+*/
+
+#include "SDL++/SpatialHash.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+SpatialHash::SpatialHash(int cellSize)
+: m_cellSize{std::max(cellSize, 1)}
+{}
+
+const Rect *SpatialHash::bounds(Id id) const
+{
+	const auto it = m_slots.find(id);
+	return it == m_slots.end() ? nullptr : &m_bounds[it->second];
+}
+
+void SpatialHash::insert(Id id, const Rect &bounds)
+{
+	if (move(id, bounds))
+		return;
+
+	const auto slot = static_cast<Uint32>(m_ids.size());
+	m_slots.emplace(id, slot);
+	m_ids.push_back(id);
+	m_bounds.push_back(bounds);
+	link(slot);
+}
+
+bool SpatialHash::move(Id id, const Rect &bounds)
+{
+	const auto it = m_slots.find(id);
+	if (it == m_slots.end())
+		return false;
+
+	const Uint32 slot = it->second;
+	const Rect &old = m_bounds[slot];
+	const bool sameCells = cellOf(old.x) == cellOf(bounds.x) && cellOf(old.y) == cellOf(bounds.y)
+		&& lastCellOf(old.x, old.w) == lastCellOf(bounds.x, bounds.w)
+		&& lastCellOf(old.y, old.h) == lastCellOf(bounds.y, bounds.h);
+
+	if (sameCells) {
+		forEachCell(bounds, [&](Uint64 key) {
+			for (auto &e : m_cells[key])
+				if (e.slot == slot)
+					e.bounds = bounds;
+		});
+		m_bounds[slot] = bounds;
+	} else {
+		unlink(slot);
+		m_bounds[slot] = bounds;
+		link(slot);
+	}
+	return true;
+}
+
+bool SpatialHash::remove(Id id)
+{
+	const auto it = m_slots.find(id);
+	if (it == m_slots.end())
+		return false;
+
+	const Uint32 slot = it->second;
+	const auto last = static_cast<Uint32>(m_ids.size() - 1);
+	unlink(slot);
+	m_slots.erase(it);
+
+	if (slot != last) {
+		m_ids[slot] = m_ids[last];
+		m_bounds[slot] = m_bounds[last];
+		m_slots[m_ids[slot]] = slot;
+		relink(slot, last);
+	}
+	m_ids.pop_back();
+	m_bounds.pop_back();
+	return true;
+}
+
+void SpatialHash::clear()
+{
+	m_cells.clear();
+	m_slots.clear();
+	m_ids.clear();
+	m_bounds.clear();
+}
+
+void SpatialHash::rebuild(const std::vector<std::pair<Id, Rect>> &objects)
+{
+	clear();
+
+	std::vector<Uint32> order(objects.size());
+	std::vector<Uint64> firstCell(objects.size());
+	std::iota(order.begin(), order.end(), 0u);
+	for (size_t i = 0; i < objects.size(); ++i) {
+		const Rect &r = objects[i].second;
+		firstCell[i] = Uint64(Uint32(cellOf(r.y))) << 32 | Uint32(cellOf(r.x));
+	}
+	std::stable_sort(order.begin(), order.end(), [&](Uint32 a, Uint32 b) { return firstCell[a] < firstCell[b]; });
+
+	m_slots.reserve(objects.size());
+	m_ids.reserve(objects.size());
+	m_bounds.reserve(objects.size());
+	for (Uint32 i : order) {
+		if (!m_slots.emplace(objects[i].first, static_cast<Uint32>(m_ids.size())).second)
+			continue;
+		m_ids.push_back(objects[i].first);
+		m_bounds.push_back(objects[i].second);
+	}
+
+	// Every cell list is allocated once, at its final size.
+	std::vector<std::pair<Uint64, Uint32>> links;
+	links.reserve(m_ids.size());
+	for (Uint32 slot = 0; slot < m_ids.size(); ++slot)
+		forEachCell(m_bounds[slot], [&](Uint64 key) { links.emplace_back(key, slot); });
+	std::sort(links.begin(), links.end());
+
+	m_cells.reserve(links.size());
+	for (size_t begin = 0, end; begin < links.size(); begin = end) {
+		end = begin + 1;
+		while (end < links.size() && links[end].first == links[begin].first)
+			++end;
+
+		auto &entries = m_cells[links[begin].first];
+		entries.reserve(end - begin);
+		for (size_t i = begin; i < end; ++i)
+			entries.push_back(Entry{m_bounds[links[i].second], links[i].second});
+	}
+}
+
+void SpatialHash::link(Uint32 slot)
+{
+	const Rect &bounds = m_bounds[slot];
+	forEachCell(bounds, [&](Uint64 key) { m_cells[key].push_back(Entry{bounds, slot}); });
+}
+
+void SpatialHash::unlink(Uint32 slot)
+{
+	forEachCell(m_bounds[slot], [&](Uint64 key) {
+		const auto cell = m_cells.find(key);
+		auto &entries = cell->second;
+		const auto it = std::find_if(entries.begin(), entries.end(), [&](const Entry &e) { return e.slot == slot; });
+		*it = entries.back();
+		entries.pop_back();
+		if (entries.empty())
+			m_cells.erase(cell);
+	});
+}
+
+void SpatialHash::relink(Uint32 slot, Uint32 from)
+{
+	forEachCell(m_bounds[slot], [&](Uint64 key) {
+		for (auto &e : m_cells[key])
+			if (e.slot == from)
+				e.slot = slot;
+	});
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
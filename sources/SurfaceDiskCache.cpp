@@ -0,0 +1,261 @@
+/*
+** SDL++, 2020
+** SurfaceDiskCache.cpp
+*/
+
+#include "SDL++/SurfaceDiskCache.hpp"
+#include "SDL++/Hash.hpp"
+#include "SDL++/MappedFile.hpp"
+
+#include <SDL2/SDL_rwops.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <system_error>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	constexpr char cacheMagic[4] = {'S', 'P', 'X', 'C'};
+	constexpr Uint32 cacheVersion = 1;
+
+	struct CacheHeader
+	{
+		char magic[4];
+		Uint32 version;
+		Uint64 contentHash;
+		Sint64 mtime;
+		Uint64 sourceSize;
+		Uint32 format;
+		Sint32 width;
+		Sint32 height;
+		Sint32 pitch;
+		Uint8 padding[16];
+	};
+	static_assert(sizeof(CacheHeader) == 64, "Pixels must start cache-line aligned");
+
+	bool sourceStamp(const std::string &filename, Sint64 &mtime, Uint64 &size)
+	{
+		std::error_code ec;
+		const auto t = std::filesystem::last_write_time(filename, ec);
+		if (ec)
+			return false;
+		const auto s = std::filesystem::file_size(filename, ec);
+		if (ec)
+			return false;
+		mtime = static_cast<Sint64>(t.time_since_epoch().count());
+		size = static_cast<Uint64>(s);
+		return true;
+	}
+
+	bool hashFile(const std::string &filename, Uint64 &hash)
+	{
+		const auto file = MappedFile::open(filename, std::nothrow);
+		if (!file)
+			return false;
+		hash = Hash::fnv1a(file->data(), file->size());
+		return true;
+	}
+
+	// std::random_device is deterministic with some toolchains, the clock
+	// still tells processes apart there.
+	Uint64 randomToken()
+	{
+		std::random_device device;
+		return Uint64(device()) << 32 ^ Uint64(device()) ^ static_cast<Uint64>(std::chrono::steady_clock::now().time_since_epoch().count());
+	}
+
+	SDL_Surface *surfaceFromCache(const MappedFile &file, const CacheHeader &h)
+	{
+		SDL_Surface *s = SDL_CreateRGBSurfaceWithFormat(0, h.width, h.height, SDL_BITSPERPIXEL(h.format), h.format);
+		if (!s)
+			return nullptr;
+
+		const Uint8 *src = file.data() + sizeof(CacheHeader);
+		auto dst = static_cast<Uint8*>(s->pixels);
+		const size_t row = std::min<size_t>(static_cast<size_t>(h.pitch), static_cast<size_t>(s->pitch));
+		for (int y = 0; y < h.height; ++y)
+			std::memcpy(dst + static_cast<size_t>(y) * s->pitch, src + static_cast<size_t>(y) * h.pitch, row);
+		return s;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+SurfaceDiskCache::SurfaceDiskCache(const std::string &directory, Uint32 format)
+: m_directory{directory}
+, m_format{format}
+, m_token{randomToken()}
+{
+	std::error_code ec;
+	std::filesystem::create_directories(m_directory, ec);
+	if (ec) {
+		Error::set(ec.message().c_str());
+		SDLPP_THROW(Exception{"SurfaceDiskCache"});
+	}
+}
+
+std::string SurfaceDiskCache::cachePath(const std::string &filename) const
+{
+	std::error_code ec;
+	auto absolute = std::filesystem::absolute(filename, ec);
+	const std::string key = ec ? filename : absolute.lexically_normal().string();
+
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.%08x", static_cast<unsigned long long>(Hash::fnv1a(key)), static_cast<unsigned>(m_format));
+	return (std::filesystem::path{m_directory} / name).string();
+}
+
+SDL_Surface *SurfaceDiskCache::load(const std::string &filename)
+{
+	Sint64 mtime = 0;
+	Uint64 sourceSize = 0;
+	if (!sourceStamp(filename, mtime, sourceSize)) {
+		Error::set(("Could not stat " + filename).c_str());
+		return nullptr;
+	}
+
+	const std::string path = cachePath(filename);
+	Uint64 contentHash = 0;
+	bool hashed = false;
+	SDL_Surface *rehashed = nullptr;
+
+	if (const auto cached = MappedFile::open(path, std::nothrow)) {
+		const MappedFile &file = *cached;
+		const auto h = reinterpret_cast<const CacheHeader*>(file.data());
+		const bool valid = file.size() >= sizeof(CacheHeader)
+			&& std::memcmp(h->magic, cacheMagic, sizeof(cacheMagic)) == 0
+			&& h->version == cacheVersion
+			&& h->format == m_format
+			&& h->sourceSize == sourceSize
+			&& file.size() >= sizeof(CacheHeader) + static_cast<Uint64>(h->pitch) * static_cast<Uint64>(h->height);
+
+		if (valid && h->mtime == mtime) {
+			if (auto s = surfaceFromCache(file, *h)) {
+				count(&Stats::hits);
+				return s;
+			}
+		}
+		else if (valid && hashFile(filename, contentHash)) {
+			hashed = true;
+			if (contentHash == h->contentHash)
+				rehashed = surfaceFromCache(file, *h);
+		}
+	}
+	else {
+		// No usable cache entry, fall through to a decode.
+		Error::clear();
+	}
+
+	// Refresh the stamp only once the entry is unmapped: Windows cannot
+	// replace a file that is still mapped.
+	if (rehashed) {
+		count(&Stats::hits);
+		count(&Stats::rehashedHits);
+		store(path, rehashed, contentHash, mtime, sourceSize);
+		return rehashed;
+	}
+
+	count(&Stats::misses);
+	SDL_Surface *s = decode(filename);
+	if (!s)
+		return nullptr;
+
+	if (hashed || hashFile(filename, contentHash))
+		store(path, s, contentHash, mtime, sourceSize);
+	else
+		count(&Stats::writeErrors);
+	return s;
+}
+
+SurfaceDiskCache::Stats SurfaceDiskCache::stats() const
+{
+	std::lock_guard lock{m_mutex};
+	return m_stats;
+}
+
+void SurfaceDiskCache::resetStats()
+{
+	std::lock_guard lock{m_mutex};
+	m_stats = {};
+}
+
+void SurfaceDiskCache::count(Uint64 Stats::*counter)
+{
+	std::lock_guard lock{m_mutex};
+	++(m_stats.*counter);
+}
+
+SDL_Surface *SurfaceDiskCache::decode(const std::string &filename) const
+{
+#ifdef SDLPP_USE_SDL_IMAGE
+	SDL_Surface *loaded = IMG_Load(filename.c_str());
+#else
+	SDL_Surface *loaded = SDL_LoadBMP(filename.c_str());
+#endif
+	if (!loaded || loaded->format->format == m_format)
+		return loaded;
+
+	SDL_Surface *converted = SDL_ConvertSurfaceFormat(loaded, m_format, 0);
+	SDL_FreeSurface(loaded);
+	return converted;
+}
+
+void SurfaceDiskCache::store(const std::string &path, SDL_Surface *surface, Uint64 contentHash, Sint64 mtime, Uint64 sourceSize)
+{
+	CacheHeader h{};
+	std::memcpy(h.magic, cacheMagic, sizeof(cacheMagic));
+	h.version = cacheVersion;
+	h.contentHash = contentHash;
+	h.mtime = mtime;
+	h.sourceSize = sourceSize;
+	h.format = m_format;
+	h.width = surface->w;
+	h.height = surface->h;
+	h.pitch = surface->pitch;
+
+	// Write next to the entry and rename so readers never map a partial file.
+	// The random token keeps caches of other processes sharing the directory
+	// out of the temporary, the counter other threads of this one.
+	char suffix[40];
+	std::snprintf(suffix, sizeof(suffix), ".%016llx.%u.tmp", static_cast<unsigned long long>(m_token), static_cast<unsigned>(m_writes++));
+	const std::string tmp = path + suffix;
+	SDL_RWops *rw = SDL_RWFromFile(tmp.c_str(), "wb");
+	if (!rw) {
+		count(&Stats::writeErrors);
+		return;
+	}
+
+	const size_t pixelBytes = static_cast<size_t>(surface->pitch) * surface->h;
+	SDL_LockSurface(surface);
+	const bool ok = SDL_RWwrite(rw, &h, sizeof(h), 1) == 1
+		&& (pixelBytes == 0 || SDL_RWwrite(rw, surface->pixels, pixelBytes, 1) == 1);
+	SDL_UnlockSurface(surface);
+
+	std::error_code ec;
+	if (SDL_RWclose(rw) != 0 || !ok) {
+		std::filesystem::remove(tmp, ec);
+		count(&Stats::writeErrors);
+		return;
+	}
+
+	std::filesystem::rename(tmp, path, ec);
+	if (ec) {
+		std::filesystem::remove(tmp, ec);
+		count(&Stats::writeErrors);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
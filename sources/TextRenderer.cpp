@@ -0,0 +1,188 @@
+/*
+** SDL++, 2020
+** TextRenderer.cpp
+*/
+
+#include "SDL++/TextRenderer.hpp"
+#include "SDL++/Exception.hpp"
+#include "SDL++/Hash.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+////////////////////////////////////////////////////////////////////////////////
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	// Two triangles per glyph quad, over vertices in the order top-left,
+	// top-right, bottom-right, bottom-left.
+	constexpr int quadIndices[6] = {0, 1, 2, 0, 2, 3};
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+TextRenderer::TextRenderer(size_t cacheCapacity)
+: m_capacity{std::max<size_t>(cacheCapacity, 1)}
+{}
+
+void TextRenderer::draw(const BitmapFont &font, std::string_view text, const Vec2f &pos, const Color &color)
+{
+	const Entry &e = lookup(font, text);
+	if (e.pages.empty())
+		return;
+
+	const SDL_Color tint{color.r, color.g, color.b, color.a};
+	Batch *batch = nullptr;
+	Uint16 batchPage = 0;
+
+	for (size_t q = 0; q < e.pages.size(); ++q) {
+		if (!batch || e.pages[q] != batchPage) {
+			batchPage = e.pages[q];
+			batch = &batchFor(font.page(batchPage).ptr());
+		}
+
+		const int base = static_cast<int>(batch->vertices.size());
+		for (int i : quadIndices)
+			batch->indices.push_back(base + i);
+		for (size_t v = q * 4; v < q * 4 + 4; ++v) {
+			SDL_Vertex vertex = e.vertices[v];
+			vertex.position.x += pos.x;
+			vertex.position.y += pos.y;
+			vertex.color = tint;
+			batch->vertices.push_back(vertex);
+		}
+	}
+}
+
+Vec2i TextRenderer::measure(const BitmapFont &font, std::string_view text)
+{
+	return lookup(font, text).size;
+}
+
+void TextRenderer::flush(const Renderer &renderer)
+{
+	m_stats.glyphs = 0;
+	m_stats.batches = 0;
+
+	for (auto &b : m_batches) {
+		if (b.indices.empty())
+			continue;
+		if (SDL_RenderGeometry(renderer.ptr(), b.texture, b.vertices.data(), static_cast<int>(b.vertices.size()), b.indices.data(), static_cast<int>(b.indices.size())) != 0)
+			SDLPP_THROW(Exception{"SDL_RenderGeometry"});
+		m_stats.glyphs += b.vertices.size() / 4;
+		++m_stats.batches;
+	}
+
+	// Pages unused for a whole frame give their buffers back, which also
+	// forgets textures of destroyed fonts.
+	m_batches.erase(std::remove_if(m_batches.begin(), m_batches.end(), [](const Batch &b) { return b.indices.empty(); }), m_batches.end());
+	discard();
+}
+
+void TextRenderer::discard()
+{
+	for (auto &b : m_batches) {
+		b.vertices.clear();
+		b.indices.clear();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void TextRenderer::setCacheCapacity(size_t capacity)
+{
+	m_capacity = std::max<size_t>(capacity, 1);
+	while (m_lru.size() > m_capacity) {
+		m_entries.erase(m_lru.back().hash);
+		m_lru.pop_back();
+	}
+}
+
+void TextRenderer::clearCache()
+{
+	m_entries.clear();
+	m_lru.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+const TextRenderer::Entry &TextRenderer::lookup(const BitmapFont &font, std::string_view text)
+{
+	const Uint32 fontId = font.id();
+	const Uint64 hash = Hash::fnv1a(text, Hash::fnv1a(&fontId, sizeof(fontId)));
+
+	auto it = m_entries.find(hash);
+	if (it != m_entries.end() && it->second->font == fontId && it->second->text == text) {
+		++m_stats.layoutHits;
+		m_lru.splice(m_lru.begin(), m_lru, it->second);
+		return m_lru.front();
+	}
+	++m_stats.layoutMisses;
+
+	// A hash collision replaces the other string's entry.
+	if (it != m_entries.end()) {
+		m_lru.splice(m_lru.begin(), m_lru, it->second);
+	} else {
+		if (m_lru.size() >= m_capacity) {
+			m_entries.erase(m_lru.back().hash);
+			m_lru.splice(m_lru.begin(), m_lru, std::prev(m_lru.end()));
+		} else {
+			m_lru.emplace_front();
+		}
+		it = m_entries.emplace(hash, m_lru.begin()).first;
+	}
+
+	Entry &e = m_lru.front();
+	e.hash = hash;
+	e.font = fontId;
+	e.text.assign(text.data(), text.size());
+	e.vertices.clear();
+	e.pages.clear();
+
+	font.layout(text, m_layout);
+	e.size = m_layout.size;
+
+	// Glyphs grouped by page, so draw() looks up each batch once per run.
+	std::stable_sort(m_layout.quads.begin(), m_layout.quads.end(), [](const auto &a, const auto &b) { return a.page < b.page; });
+
+	e.vertices.reserve(m_layout.quads.size() * 4);
+	e.pages.reserve(m_layout.quads.size());
+	for (const auto &q : m_layout.quads) {
+		const Vec2i &pageSize = font.pageSize(q.page);
+		const float u0 = float(q.source.x) / float(pageSize.x);
+		const float v0 = float(q.source.y) / float(pageSize.y);
+		const float u1 = float(q.source.x + q.source.w) / float(pageSize.x);
+		const float v1 = float(q.source.y + q.source.h) / float(pageSize.y);
+		const float x0 = float(q.dest.x), y0 = float(q.dest.y);
+		const float x1 = float(q.dest.x + q.dest.w), y1 = float(q.dest.y + q.dest.h);
+
+		e.vertices.push_back(SDL_Vertex{SDL_FPoint{x0, y0}, SDL_Color{}, SDL_FPoint{u0, v0}});
+		e.vertices.push_back(SDL_Vertex{SDL_FPoint{x1, y0}, SDL_Color{}, SDL_FPoint{u1, v0}});
+		e.vertices.push_back(SDL_Vertex{SDL_FPoint{x1, y1}, SDL_Color{}, SDL_FPoint{u1, v1}});
+		e.vertices.push_back(SDL_Vertex{SDL_FPoint{x0, y1}, SDL_Color{}, SDL_FPoint{u0, v1}});
+		e.pages.push_back(q.page);
+	}
+	return e;
+}
+
+TextRenderer::Batch &TextRenderer::batchFor(SDL_Texture *texture)
+{
+	for (auto &b : m_batches)
+		if (b.texture == texture)
+			return b;
+	m_batches.push_back(Batch{texture, {}, {}});
+	return m_batches.back();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+/*
+** SDL++, 2020
+** UploadScheduler.cpp
+*/
+
+#include "SDL++/UploadScheduler.hpp"
+#include "SDL++/Pixels.hpp"
+#include "SDL++/Timer.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace SDL
+{
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	Texture transparentPixel(SDL_Renderer *renderer)
+	{
+		Surface s{1, 1, 32, SDL_PIXELFORMAT_ARGB8888};
+		s.fill(Color::Transparent);
+		Texture t{renderer, s};
+		t.setBlendMode(SDL_BLENDMODE_BLEND);
+		return t;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void UploadScheduler::Handle::setPriority(Priority priority) const
+{
+	if (!m_state || m_state->ready || m_state->priority == priority)
+		return;
+	m_state->priority = priority;
+	m_state->scheduler->m_queues[static_cast<size_t>(priority)].push_back(m_state);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+UploadScheduler::UploadScheduler(const Renderer &renderer)
+: UploadScheduler{renderer, transparentPixel(renderer.ptr())}
+{}
+
+UploadScheduler::UploadScheduler(const Renderer &renderer, Texture placeholder)
+: m_renderer{renderer.ptr()}
+, m_placeholder{std::move(placeholder)}
+{}
+
+UploadScheduler::Handle UploadScheduler::enqueue(Surface surface, Priority priority)
+{
+	const size_t bytes = static_cast<size_t>(surface.ptr()->pitch) * static_cast<size_t>(surface.height());
+
+	// The last handle to go takes a pending surface out of the counts.
+	std::shared_ptr<State> state{new State{this, std::move(surface), Texture{}, bytes, priority}, [](State *s) {
+		if (!s->ready)
+			s->scheduler->cancel(*s);
+		delete s;
+	}};
+
+	m_queues[static_cast<size_t>(priority)].push_back(state);
+	++m_pending;
+	m_pendingBytes += bytes;
+	return Handle{std::move(state)};
+}
+
+size_t UploadScheduler::update(std::chrono::microseconds budget)
+{
+	const double ticks = double(std::max<std::chrono::microseconds::rep>(budget.count(), 0)) * double(Timer::perfFrequency()) / 1e6;
+	return run(static_cast<Uint64>(ticks));
+}
+
+size_t UploadScheduler::flush()
+{
+	return run(std::numeric_limits<Uint64>::max());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+size_t UploadScheduler::run(Uint64 budgetTicks)
+{
+	const Uint64 start = Timer::perfCounter();
+	size_t count = 0;
+	size_t bytes = 0;
+
+	while (auto state = next()) {
+		const Uint64 elapsed = Timer::perfCounter() - start;
+		if (count > 0 && double(elapsed) + m_ticksPerByte * double(state->bytes) > double(budgetTicks))
+			break;
+
+		const Uint64 before = Timer::perfCounter();
+		state->texture = Texture{m_renderer, *state->surface};
+		const Uint64 ticks = Timer::perfCounter() - before;
+
+		m_queues[static_cast<size_t>(state->priority)].pop_front();
+		state->surface.reset();
+		state->ready = true;
+		--m_pending;
+		m_pendingBytes -= state->bytes;
+		++count;
+		bytes += state->bytes;
+
+		// Moving average, following changes of driver state and sizes.
+		const double sample = double(ticks) / double(std::max<size_t>(state->bytes, 1));
+		m_ticksPerByte = m_ticksPerByte > 0.0 ? m_ticksPerByte * 0.75 + sample * 0.25 : sample;
+	}
+
+	m_stats.uploads += count;
+	m_stats.bytes += bytes;
+	m_stats.frameUploads = count;
+	m_stats.frameBytes = bytes;
+	m_stats.frameMs = double(Timer::perfCounter() - start) * 1000.0 / double(Timer::perfFrequency());
+	return count;
+}
+
+std::shared_ptr<UploadScheduler::State> UploadScheduler::next()
+{
+	for (size_t p = 0; p < 3; ++p) {
+		auto &queue = m_queues[p];
+		while (!queue.empty()) {
+			auto state = queue.front().lock();
+			if (state && !state->ready && state->priority == static_cast<Priority>(p))
+				return state;
+			queue.pop_front();
+		}
+	}
+	return nullptr;
+}
+
+void UploadScheduler::cancel(const State &state)
+{
+	--m_pending;
+	m_pendingBytes -= state.bytes;
+	++m_stats.cancelled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,50 @@
+/*
+** SDL++, 2020
+** MapIndex.cpp
+*/
+
+#include "SDL++/MappingDatabase.hpp"
+
+#include <cstring>
+#include <iostream>
+
+////////////////////////////////////////////////////////////////////////////////
+
+static int usage(const char *argv0)
+{
+	std::cerr << "usage: " << argv0 << " [--platform <name>] <output> <gamecontrollerdb.txt...>" << std::endl
+	          << "  --platform  only keep mappings for that SDL platform name, e.g. \"Windows\"" << std::endl;
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	std::string platform;
+	int i = 1;
+
+	if (i + 1 < argc && std::strcmp(argv[i], "--platform") == 0) {
+		platform = argv[i + 1];
+		i += 2;
+	}
+	if (argc - i < 2)
+		return usage(argv[0]);
+
+	const std::string output = argv[i++];
+
+	try {
+		SDL::MappingDatabaseWriter writer{platform};
+		for (; i < argc; ++i)
+			writer.addFile(argv[i]);
+		writer.write(output);
+		std::cout << output << ": " << writer.entryCount() << " mappings";
+		if (writer.skippedCount())
+			std::cout << ", " << writer.skippedCount() << " invalid lines skipped";
+		std::cout << std::endl;
+	}
+	catch (const SDL::Exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
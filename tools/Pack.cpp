@@ -0,0 +1,51 @@
+/*
+** SDL++, 2020
+** Pack.cpp
+*/
+
+#include "SDL++/Archive.hpp"
+
+#include <cstring>
+#include <iostream>
+
+////////////////////////////////////////////////////////////////////////////////
+
+static int usage(const char *argv0)
+{
+	std::cerr << "usage: " << argv0 << " [--decode] <output> <files...>" << std::endl
+	          << "  --decode  store images as pre-decoded ARGB8888 pixels" << std::endl;
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	bool decode = false;
+	int i = 1;
+
+	if (i < argc && std::strcmp(argv[i], "--decode") == 0) {
+		decode = true;
+		++i;
+	}
+	if (argc - i < 2)
+		return usage(argv[0]);
+
+	const std::string output = argv[i++];
+
+	try {
+		SDL::ArchiveWriter writer;
+		for (; i < argc; ++i) {
+			if (decode)
+				writer.addSurface(argv[i], SDL::Surface{std::string{argv[i]}}.withFormat(SDL_PIXELFORMAT_ARGB8888));
+			else
+				writer.addFile(argv[i], argv[i]);
+		}
+		writer.write(output);
+		std::cout << output << ": " << writer.entryCount() << " entries" << std::endl;
+	}
+	catch (const SDL::Exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}